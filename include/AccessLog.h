@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Per-track request counts carried from one session to the next
+ *
+ * DJSession records every track it asks the controller for. save() writes one
+ * line per track, "score<TAB>title", where the score is the previous score halved
+ * plus this session's requests, so tracks that stop being played fade out over a
+ * few sessions. load() reads the file back at startup, and ranked() lists the
+ * titles most likely to be requested first, for cache warm-up.
+ *
+ * Titles are the key because track ids are only dense indices of the current
+ * library and change when the config does.
+ */
+class AccessLog {
+public:
+    static constexpr double DECAY = 0.5;       // weight of earlier sessions
+    static constexpr double MIN_SCORE = 0.05;  // entries below are dropped on save
+
+    AccessLog();
+
+    /**
+     * @brief Read a log written by save(); a missing file is an empty log
+     * @return false only if the file exists but cannot be parsed
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Write decayed earlier scores plus this session's requests
+     */
+    bool save(const std::string& path) const;
+
+    void record(const std::string& title) { session_counts[title]++; }
+
+    /**
+     * @brief Titles from earlier sessions, best score first
+     */
+    std::vector<std::string> ranked(size_t max_titles) const;
+
+    size_t size() const { return scores.size(); }
+
+private:
+    std::unordered_map<std::string, double> scores;          // from earlier sessions
+    std::unordered_map<std::string, size_t> session_counts;  // requests in this session
+};
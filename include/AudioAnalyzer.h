@@ -0,0 +1,87 @@
+#pragma once
+
+#include "WaveformView.h"
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Per-track analysis results, stored on the track next to its beat grid
+ *
+ * Filled once by AudioTrack::ensure_analyzed() and copied into every clone, so a
+ * track is analyzed at most once no matter how many caches/decks it passes through.
+ */
+struct TrackAnalysis {
+    bool analyzed;
+
+    // Beat grid (constant tempo): beat k starts at first_beat_seconds + k * beat_period_seconds
+    double first_beat_seconds;
+    double beat_period_seconds;
+    int beat_count;
+
+    // Harmonic key
+    int key_root;            // pitch class of the tonic, 0 = C ... 11 = B
+    bool key_minor;
+    int camelot_number;      // 1..12 on the Camelot wheel
+    char camelot_letter;     // 'A' = minor, 'B' = major
+    double key_confidence;   // correlation with the best key profile, -1..1
+
+    // Energy
+    double rms;                        // RMS over the whole waveform
+    std::vector<float> energy_profile; // RMS per ENERGY_BLOCK samples
+
+    TrackAnalysis()
+        : analyzed(false), first_beat_seconds(0.0), beat_period_seconds(0.0), beat_count(0),
+          key_root(0), key_minor(false), camelot_number(0), camelot_letter('?'),
+          key_confidence(0.0), rms(0.0), energy_profile() {}
+};
+
+/**
+ * @brief Feature extraction and harmonic compatibility helpers (stateless)
+ *
+ * Key detection builds a 12-bin chroma vector from waveform_data with a bank of
+ * Goertzel filters (three octaves per pitch class) and correlates it against the
+ * Krumhansl-Schmuckler major/minor key profiles. The filter bank is updated for
+ * all bins per input sample, so the inner loop runs over contiguous arrays and
+ * vectorizes.
+ */
+class AudioAnalyzer {
+public:
+    static constexpr double ANALYSIS_SAMPLE_RATE = 11025.0;  // nominal rate of waveform_data
+    static constexpr size_t ENERGY_BLOCK = 64;               // samples per energy profile entry
+
+    /**
+     * @brief Fill the beat grid of an analysis for a constant-tempo track
+     */
+    static void analyze_beat_grid(TrackAnalysis& analysis, double bpm, int duration_seconds);
+
+    /**
+     * @brief Detect key and energy from raw samples into an analysis
+     */
+    static void analyze_features(TrackAnalysis& analysis, WaveformView samples);
+
+    /**
+     * @brief Camelot number (1..12) of a key
+     */
+    static int camelot_number(int key_root, bool minor);
+
+    /**
+     * @brief True if two analyzed keys mix harmonically (same key, relative key, or +-1 on the wheel)
+     */
+    static bool camelot_compatible(const TrackAnalysis& a, const TrackAnalysis& b);
+
+    /**
+     * @brief Harmonic closeness in [0, 1]: 1 for the same key, decreasing with wheel distance
+     */
+    static double harmonic_score(const TrackAnalysis& a, const TrackAnalysis& b);
+
+    /**
+     * @brief Energy closeness in [0, 1] from the tracks' overall RMS
+     */
+    static double energy_score(const TrackAnalysis& a, const TrackAnalysis& b);
+
+private:
+    /**
+     * @brief Compute the 12-bin chroma vector of a signal
+     */
+    static void chroma(const float* samples, size_t count, double out[12]);
+};
@@ -2,8 +2,21 @@
 
 #include <string>
 #include "PointerWrapper.h"
+#include "AudioAnalyzer.h"
+#include "SeekIndex.h"
+#include "WaveformPyramid.h"
+#include "SampleFormat.h"
 #include <memory>
 #include <vector>
+#include <cstdint>
+
+/**
+ * Dense integer identifier assigned to each library track by DJLibraryService::buildLibrary.
+ * Caches, playlists and decks key on it; titles are only used at the config/UI boundary.
+ */
+using TrackId = std::uint32_t;
+constexpr TrackId INVALID_TRACK_ID = UINT32_MAX;
+
 /**
  * Base class for all audio track types in the DJ library system.
  * This class demonstrates virtual functions, Rule of 5, and dynamic memory management.
@@ -23,8 +36,34 @@ protected:
     std::vector<std::string> artists;
     int duration_seconds;
     int bpm;  // beats per minute for mixing
-    double* waveform_data;  // Dynamic array for audio analysis
+    double exact_bpm;       // Unrounded tempo; differs from bpm once time_stretch() has run
+    float* waveform_data;   // Dynamic array for audio analysis (Float32 format, else nullptr)
+    int16_t* packed_waveform;  // Same samples in Int16 format (else nullptr)
     size_t waveform_size;   // Size of the waveform array
+    SampleFormat sample_format;  // Which of the two arrays holds the samples
+    TrackId track_id;       // Library-assigned id, copied into every clone
+    TrackAnalysis analysis; // Beat grid, key and energy; computed once, copied into every clone
+    std::shared_ptr<TrackNavigation> navigation;  // Seek index and cues, shared with every clone; never null
+    uint64_t position;         // Playback position in source samples (this instance only)
+    uint64_t position_offset;  // File byte offset decoding resumes from for `position`
+    std::shared_ptr<const WaveformPyramid> overview;  // Built from waveform_data; shared until it changes
+
+    /**
+     * Replace waveform_data with decoded audio (at AudioAnalyzer::ANALYSIS_SAMPLE_RATE)
+     * and mark the analysis stale so the next ensure_analyzed() re-extracts key/energy.
+     */
+    void set_waveform(const std::vector<float>& samples);
+
+    /**
+     * Move the playback position through the seek index
+     * @return false if no index has been built yet
+     */
+    bool jump_to(uint64_t sample);
+
+    /**
+     * Rebuild the overview pyramid from waveform_data
+     */
+    void build_overview();
 
 public:
     /**
@@ -98,14 +137,103 @@ public:
     virtual PointerWrapper<AudioTrack> clone() const = 0;
 
     /**
-     * Function to get a copy of the waveform data
+     * Fill the beat grid and, on first call only, run key/energy extraction over
+     * waveform_data. Derived analyze_beatgrid() implementations call this; it is
+     * cheap after the first call, so clones of an analyzed track never re-extract.
+     */
+    void ensure_analyzed();
+
+    /**
+     * Change the tempo to target_bpm without changing pitch: waveform_data is
+     * resampled in time with TimeStretcher (WSOLA), duration and beat grid follow,
+     * and the unrounded tempo is kept in exact_bpm.
+     */
+    void time_stretch(double target_bpm);
+
+    /**
+     * Read-only view of waveform_data, valid until the track is destroyed or its
+     * samples are replaced (set_waveform(), time_stretch(), set_sample_format())
+     * @return An empty view while the samples are stored as Int16
+     */
+    WaveformView get_waveform() const;
+    size_t get_waveform_size() const { return waveform_size; }
+
+    /**
+     * Convert the stored samples (Float32 by default; Int16 for cold cached copies).
+     * ensure_analyzed() and time_stretch() convert back to Float32 themselves.
+     */
+    void set_sample_format(SampleFormat format);
+    SampleFormat get_sample_format() const { return sample_format; }
+    size_t get_waveform_bytes() const { return waveform_size * SampleConverter::bytes_per_sample(sample_format); }
+
+    /**
+     * Raw stored samples (get_waveform_bytes() bytes in get_sample_format())
      */
-    void get_waveform_copy(double* buffer, size_t buffer_size) const;
+    const void* get_sample_data() const;
+
+    /**
+     * Free the samples but keep metadata, analysis, overview and seek index, so a
+     * cold copy can hold the track shell next to a compressed waveform
+     */
+    void release_waveform();
+
+    /**
+     * Replace the samples with an uninitialised array of the given format for the
+     * caller to fill; unlike set_waveform() the analysis is kept
+     * @return The new array (samples * bytes_per_sample(format) bytes)
+     */
+    void* allocate_waveform(SampleFormat format, size_t samples);
+
+    /**
+     * Install analysis and tempo saved from an earlier copy of this track
+     * (SpillStore); the overview is rebuilt by the next ensure_analyzed()
+     */
+    void restore_analysis(const TrackAnalysis& saved, int saved_bpm, double saved_exact_bpm, int saved_duration);
+
+    /**
+     * Min/max/RMS overview of waveform_data for zoomed display, built by
+     * ensure_analyzed() and shared with clones until their waveform changes
+     * @return nullptr before the first analysis
+     */
+    const WaveformPyramid* get_overview() const { return overview.get(); }
     
     // ========== ACCESSOR FUNCTIONS ==========
-    std::string get_title() const { return title; }
+    // Title and artists are returned by reference: they are read on every cache
+    // and playlist lookup, so returning copies would allocate on each comparison.
+    const std::string& get_title() const { return title; }
     int get_bpm() const { return bpm; }
-    void set_bpm(int new_bpm) { bpm = new_bpm; }
+    void set_bpm(int new_bpm) { bpm = new_bpm; exact_bpm = new_bpm; }
+    double get_exact_bpm() const { return exact_bpm; }
     int get_duration() const { return duration_seconds; }
-    std::vector<std::string> get_artists() const { return artists; }
+    const std::vector<std::string>& get_artists() const { return artists; }
+    TrackId get_id() const { return track_id; }
+    const TrackAnalysis& get_analysis() const { return analysis; }
+    void set_id(TrackId id) { track_id = id; }
+
+    // ========== PLAYBACK POSITION AND CUES ==========
+    // Seeks go through the seek index built by load() (O(log n) in the number of
+    // indexed frames) and never re-read the file from the start. The index and the
+    // cue points are shared with every clone, so they survive in the cache.
+    // Cue setters therefore write through: a cue set on a deck clone is also set on
+    // the cached and library copies of that track (and a moved-from track keeps
+    // sharing them), the way a DJ library keeps one set of cues per track.
+    bool has_seek_index() const { return navigation && !navigation->index.empty(); }
+    const SeekIndex& get_seek_index() const { return navigation->index; }
+    bool seek(double seconds);
+    double get_position() const;
+    uint64_t get_position_offset() const { return position_offset; }
+
+    // Shared with every copy of the track, see above
+    void set_cue() { navigation->cue = position; }
+    bool jump_to_cue() { return jump_to(navigation->cue); }
+
+    /**
+     * Store the current position in a hot-cue slot (0..HOT_CUE_SLOTS-1)
+     * @return false for an invalid slot
+     * Like set_cue(), visible through every copy of the track; so is clear_hot_cue().
+     */
+    bool set_hot_cue(size_t slot);
+    bool jump_to_hot_cue(size_t slot);
+    void clear_hot_cue(size_t slot);
+    bool has_hot_cue(size_t slot) const;
 };
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+/**
+ * @brief Run every micro-benchmark in order and print the results (dj_manager -B)
+ *
+ * Covers the time stretcher, crossfade and deck mixers, the WAV and MP3 readers,
+ * the seek index, waveform overviews, sample formats, the cache tiers, admission,
+ * adaptive sizing, warm-up, metrics and tracing. Fixtures are written to the
+ * system temporary directory and removed afterwards; build with `make release`
+ * for meaningful numbers.
+ */
+void run_benchmarks();
+
+/**
+ * @brief Run the correctness checks and print one PASS/FAIL line each (dj_manager -C, make check)
+ *
+ * - sample formats: an int16 round trip must not change the key, nor the RMS or an energy
+ *   block by more than quantization can explain
+ * - BPM index: range sizes and nearest-BPM suggestions must equal a scan of the catalog
+ * - spill tier: tracks spilled to disk and reloaded through compactions must come back
+ *   with identical samples and analysis
+ * - cache shrink: set_capacity() must evict in LRU order and keep that order for the survivors
+ *
+ * @return false if any check fails
+ */
+bool run_checks();
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "AudioTrack.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Bucketed BPM index over the track library
+ *
+ * BPMs are small integers, so the index is a counting sort: one bucket per BPM
+ * value between the library's min and max, with all ids of a bucket stored
+ * contiguously. A tolerance window [bpm - tol, bpm + tol] is therefore a single
+ * contiguous slice of the id array, found with two offset lookups.
+ *
+ * Only BPMs in [MIN_BPM, MAX_BPM] are indexed, so a bogus value in the library
+ * cannot blow up the bucket array; tracks outside it (0 = unknown) are left out
+ * and counted by unindexed().
+ *
+ * Build is O(n + BPM range); a query is O(1) plus the size of the result.
+ */
+class BpmIndex {
+public:
+    static constexpr int32_t MIN_BPM = 1;
+    static constexpr int32_t MAX_BPM = 999;
+
+    /**
+     * @brief Read-only slice of the index (valid until the next build())
+     */
+    struct Range {
+        const TrackId* first;
+        const TrackId* last;
+
+        const TrackId* begin() const { return first; }
+        const TrackId* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+        bool empty() const { return first == last; }
+    };
+
+    BpmIndex();
+
+    /**
+     * @brief Rebuild the index from a BPM column where bpms[i] belongs to TrackId i
+     */
+    void build(const std::vector<int32_t>& bpms);
+
+    /**
+     * @brief All tracks with BPM in [bpm - tolerance, bpm + tolerance], grouped by ascending BPM
+     * @return A view into the index; no copy is made
+     */
+    Range query(int bpm, int tolerance) const;
+
+    /**
+     * @brief Same as query(), copied into a vector
+     */
+    std::vector<TrackId> findWithin(int bpm, int tolerance) const;
+
+    /**
+     * @brief The track closest in BPM to bpm within tolerance, ties to the higher score
+     * @param score Per-TrackId score that breaks ties inside the nearest bucket
+     * @param exclude Track never returned (e.g. the one playing)
+     * @return INVALID_TRACK_ID if no other track is within tolerance
+     *
+     * Buckets are read outward from bpm through the offsets and only the nearest
+     * non-empty one is scanned; an empty window costs one range lookup.
+     */
+    TrackId nearest(int bpm, int tolerance, const std::vector<double>& score,
+                    TrackId exclude = INVALID_TRACK_ID) const;
+
+    size_t size() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+
+    /**
+     * @brief Tracks of the last build() left out for a BPM outside [MIN_BPM, MAX_BPM]
+     */
+    size_t unindexed() const { return skipped; }
+
+private:
+    int32_t min_bpm;
+    size_t skipped;
+    std::vector<uint32_t> offsets;  // offsets[b - min_bpm] = first slot of bucket b; one extra sentinel
+    std::vector<TrackId> ids;       // ids sorted by bpm (stable: library order inside a bucket)
+};
@@ -20,6 +20,7 @@
 class CacheSlot {
 private:
     PointerWrapper<AudioTrack> track;    // The cached track
+    TrackId track_id;                    // Id of the cached track (avoids a pointer chase on lookup)
     uint64_t last_access_time;           // For LRU algorithm
     bool occupied;                       // Is this slot in use?
 
@@ -47,6 +48,11 @@ public:
      * @brief Clear this slot (removes track)
      */
     void clear();
+
+    /**
+     * @brief Empty this slot and hand its track to the caller
+     */
+    PointerWrapper<AudioTrack> release();
     
     /**
      * @brief Check if slot is occupied
@@ -57,6 +63,11 @@ public:
      * @brief Get last access time for LRU comparison
      */
     uint64_t getLastAccessTime() const { return last_access_time; }
+
+    /**
+     * @brief Get id of the cached track (INVALID_TRACK_ID when empty)
+     */
+    TrackId getTrackId() const { return track_id; }
     
     /**
      * @brief Get track without updating access time
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "AudioTrack.h"
+#include "PointerWrapper.h"
+#include "SampleFormat.h"
+#include "SpillStore.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Second cache tier: evicted tracks kept in memory with a compressed waveform
+ *
+ * LRUCache hands its evicted tracks to put() instead of destroying them. The track
+ * object itself is kept as a shell (metadata, analysis, overview pyramid and seek
+ * index survive; release_waveform() frees only the samples) and the samples are
+ * stored as an LZ4 block. take() rebuilds the waveform in the format it was stored
+ * in and returns the track ready to go back into the hot tier, so a re-used track
+ * skips clone(), load() and analyze_beatgrid().
+ *
+ * Compression is lossless. Before LZ4 the samples are delta-coded (consecutive
+ * audio samples are close, so the high bits of the differences are mostly zero)
+ * and split into byte planes, which turns those zero bits into long runs.
+ *
+ * Capacity is a number of tracks; when full, the entry stored first is dropped,
+ * or moved on to a SpillStore if one is set. A capacity of 0 disables the tier
+ * (evicted tracks then go straight to the spill target, if any).
+ */
+class ColdTrackStore {
+public:
+    explicit ColdTrackStore(size_t capacity = 0);
+
+    // Entries own their tracks, and spill_target is not owned
+    ColdTrackStore(const ColdTrackStore&) = delete;
+    ColdTrackStore& operator=(const ColdTrackStore&) = delete;
+
+    /**
+     * @brief Compress and keep an evicted track
+     * @return false if the track was destroyed (tier disabled and no spill target)
+     */
+    bool put(PointerWrapper<AudioTrack> track);
+
+    /**
+     * @brief Remove a track from the tier and restore its waveform
+     * @return The track, or a null wrapper if it is not held here
+     */
+    PointerWrapper<AudioTrack> take(TrackId track_id);
+
+    bool contains(TrackId track_id) const { return find(track_id) != entries.size(); }
+    size_t size() const { return entries.size(); }
+    size_t capacity() const { return max_size; }
+    bool enabled() const { return max_size > 0; }
+
+    /**
+     * @brief Send dropped entries to disk instead of destroying them
+     * @param target Store to receive them (not owned), or nullptr
+     */
+    void set_spill_target(SpillStore* target) { spill_target = target; }
+
+    /**
+     * @brief Bytes of compressed waveform held, and what they expand to
+     */
+    size_t compressed_bytes() const;
+    size_t raw_bytes() const;
+
+    /**
+     * @brief Change the capacity, dropping the oldest entries if it shrinks
+     */
+    void set_capacity(size_t capacity);
+
+    void clear() { entries.clear(); }
+
+    /**
+     * @brief Compress samples of bytes_per_sample bytes each (delta, byte planes, LZ4)
+     */
+    static void compress(const void* samples, size_t count, size_t bytes_per_sample,
+                         std::vector<unsigned char>& out);
+
+    /**
+     * @brief Inverse of compress()
+     * @return false if the block is corrupt
+     */
+    static bool decompress(const unsigned char* in, size_t size, void* samples, size_t count,
+                           size_t bytes_per_sample);
+
+private:
+    struct Entry {
+        PointerWrapper<AudioTrack> track;      // shell without samples
+        TrackId track_id;
+        SampleFormat format;
+        size_t samples;
+        std::vector<unsigned char> compressed;
+        uint64_t stored_at;
+    };
+
+    std::vector<Entry> entries;
+    size_t max_size;
+    uint64_t store_counter;
+    SpillStore* spill_target;
+
+    size_t find(TrackId track_id) const;
+    void drop_oldest();
+    void spill(Entry& entry);
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "AudioTrack.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Renders beat-aligned crossfades between two decks into float blocks
+ *
+ * The fade length is the configured crossfade time rounded to whole beats of the
+ * incoming track. It starts on a beat of the outgoing track's grid (the last one
+ * that still leaves room for the fade before the track ends) and on the first
+ * beat of the incoming track, so both grids line up for the whole transition.
+ *
+ * Rendering runs BLOCK_SIZE samples at a time: each deck's waveform is read
+ * through its WaveformView and converted into a float block, the gain curves for the block are filled, and mix_block() sums the two
+ * weighted decks into the output. The kernels are plain loops over restrict
+ * pointers so the compiler vectorizes them.
+ *
+ * waveform_data stands in for decoded audio at AudioAnalyzer::ANALYSIS_SAMPLE_RATE
+ * and is looped to cover the track's duration.
+ */
+class CrossfadeEngine {
+public:
+    static constexpr size_t BLOCK_SIZE = 512;
+
+    enum class Curve {
+        Linear,      // gains sum to 1; slight loudness dip mid-fade
+        EqualPower   // cos/sin gains; constant power for uncorrelated decks
+    };
+
+    struct Plan {
+        int beats;              // fade length in beats of the incoming track (0 = no beat grid)
+        double seconds;         // fade length actually used
+        int outgoing_beat;      // beat of the outgoing track where the fade starts
+        size_t outgoing_start;  // sample offsets at ANALYSIS_SAMPLE_RATE
+        size_t incoming_start;
+        size_t length;          // samples
+    };
+
+    CrossfadeEngine();
+
+    void set_crossfade_time(int seconds) { crossfade_seconds = seconds; }
+    int get_crossfade_time() const { return crossfade_seconds; }
+    void set_curve(Curve new_curve) { curve = new_curve; }
+
+    /**
+     * @brief Choose where and how long to fade, from the tracks' beat grids
+     */
+    static Plan plan(const AudioTrack& outgoing, const AudioTrack& incoming, double seconds);
+
+    /**
+     * @brief Render a crossfade of the configured length from outgoing to incoming
+     * @return The plan that was rendered; the mix is available from get_output()
+     */
+    Plan render(const AudioTrack& outgoing, const AudioTrack& incoming);
+
+    /**
+     * @brief Last rendered crossfade, a whole number of BLOCK_SIZE blocks
+     */
+    const std::vector<float>& get_output() const { return output; }
+
+    /**
+     * @brief Samples mixed over the engine's lifetime
+     */
+    uint64_t get_mixed_samples() const { return mixed_samples; }
+
+    /**
+     * @brief out[i] = a[i] * gain_a[i] + b[i] * gain_b[i]
+     */
+    static void mix_block(const float* a, const float* gain_a, const float* b, const float* gain_b,
+                          float* out, size_t count);
+
+    /**
+     * @brief Gains for samples [position, position + count) of a fade of the given length
+     */
+    static void fill_gains(Curve curve, size_t position, size_t length,
+                           float* gain_out, float* gain_in, size_t count);
+
+private:
+    int crossfade_seconds;
+    Curve curve;
+
+    // one block of scratch per deck and gain curve
+    std::vector<float> block_out;
+    std::vector<float> block_in;
+    std::vector<float> gain_out;
+    std::vector<float> gain_in;
+
+    std::vector<float> output;
+    uint64_t mixed_samples;
+
+    static void read_looped(WaveformView source, size_t position, float* out, size_t count);
+};
@@ -3,20 +3,92 @@
 
 #include "LRUCache.h"
 #include "CacheSlot.h"
+#include "ColdTrackStore.h"
+#include "SpillStore.h"
+#include "FrequencySketch.h"
+#include "MetricsRegistry.h"
 #include "PointerWrapper.h"
+#include "SampleFormat.h"
 #include <string>
+#include <vector>
+
+/**
+ * Lookups and time spent per cache tier, counted by loadTrackToCache()
+ */
+struct CacheTierStats {
+    size_t hot_hits = 0;
+    size_t cold_hits = 0;
+    size_t disk_hits = 0;
+    size_t misses = 0;        // full clone + load + analyze
+    size_t rejections = 0;    // misses the admission filter kept out of the hot tier
+    double hot_hit_ms = 0.0;  // total time in each path
+    double cold_hit_ms = 0.0;
+    double disk_hit_ms = 0.0;
+    double miss_ms = 0.0;
+
+    size_t lookups() const { return hot_hits + cold_hits + disk_hits + misses; }
+};
+
+/**
+ * Adaptive capacity (DJControllerService::set_adaptive_capacity()): bounds and state
+ */
+struct AdaptiveCapacity {
+    static constexpr size_t WINDOW = 8;           // lookups between decisions
+    static constexpr double GROW_MISS_RATE = 0.5;  // grow when at least this many lookups miss
+    static constexpr double LOW_MEMORY = 0.1;      // shrink when less of MemTotal is MemAvailable
+
+    bool enabled = false;
+    size_t min_tracks = 1;
+    size_t max_tracks = 0;
+    size_t budget_bytes = 0;     // cached waveform bytes allowed
+    size_t window_lookups = 0;
+    size_t window_misses = 0;
+    size_t grows = 0;
+    size_t shrinks = 0;
+};
+
+/**
+ * Result of DJControllerService::warm_cache()
+ */
+struct WarmUpStats {
+    size_t tracks = 0;  // tracks loaded into the cache
+    double ms = 0.0;    // wall time of the whole warm-up
+};
 
 /**
  * Service responsible for managing the controller's memory (cache)
- * Cache capacity is fixed, and the tracks are managed with LRU policy.
+ * Cache capacity can change at runtime, and the tracks are managed with LRU policy.
  * On HIT: touch MRU (most recently used); on MISS: insert; if full, evict LRU.
  * - Mixer always receives a polymorphic clone; cache retains its copy.
+ * - Cached copies are analyzed first, then stored in the cold sample format
+ *   (Int16 by default); the mixer converts its clone back to Float32.
+ * - With a cold tier (set_cold_cache_size() > 0) evicted tracks are kept
+ *   compressed in a ColdTrackStore; a miss that hits there promotes the track
+ *   back instead of cloning, loading and analyzing it again.
+ * - With a spill file (open_spill_file()) tracks dropped by the cold tier are
+ *   appended to a SpillStore segment on disk and promoted from there.
+ * - With TinyLFU admission (set_admission_filter(true)) every request is counted
+ *   in a FrequencySketch, and a miss on a full cache is only admitted if its
+ *   estimated frequency beats that of the LRU victim. A rejected track waits in
+ *   a one-track bypass slot, so it still reaches the deck; the next rejection
+ *   moves it on to the cold tier like an eviction.
+ * - With a metrics registry (set_metrics()) lookups, evictions, tier sizes and
+ *   clone/analysis times are also published there as they happen.
+ *
+ * Not thread-safe: the tier state around the cache (cold and disk tiers, the
+ * sketch, the bypass slot, the adaptive window, the stats) is unsynchronized,
+ * so one thread drives the controller. warm_cache() parallelizes only its
+ * private clones.
  */
 class DJControllerService {
 public:
     // Construct with a given cache size
     explicit DJControllerService(size_t cache_size = 8);
 
+    // The cache points at this instance's cold tier
+    DJControllerService(const DJControllerService&) = delete;
+    DJControllerService& operator=(const DJControllerService&) = delete;
+
     // Contract: Ensure a track is present in cache by key (full playlist line)
     // Input: A reference to an AudioTrack.
     // Output: An integer indicating the result: 1 for HIT, 0 for MISS without eviction, -1 for MISS with eviction.
@@ -30,18 +102,133 @@ public:
     /**
      * @brief Set the cache size for the LRUCache.
      * @param new_size The new size for the cache.
-     * @note This function is meant for a single usage. don't call it more then once.
+     * @note Safe at any time: shrinking evicts LRU-first into the cold tier.
      */
     void set_cache_size(size_t new_size);
+    size_t get_cache_size() const { return cache.capacity(); }
+
+    /**
+     * @brief Let the cache size follow the miss rate, within bounds
+     * @param max_tracks Upper bound (0 disables the adaptive mode); the lower bound is 1
+     * @param budget_bytes Cached waveform bytes allowed
+     *
+     * Every AdaptiveCapacity::WINDOW lookups: over budget, or with little available
+     * memory (MemAvailable in /proc/meminfo; budget only where that is missing), the
+     * cache shrinks by one slot; otherwise, if at least half
+     * of the window missed, it grows by a quarter (at least one slot) but not past
+     * the number of tracks of mean size the budget holds.
+     */
+    void set_adaptive_capacity(size_t max_tracks, size_t budget_bytes);
+    const AdaptiveCapacity& get_adaptive_capacity() const { return adaptive; }
+    /**
+     * @brief Get a track from the cache by its library id.
+     * @param track_id The id of the track to retrieve.
+     * @return The track pinned in the cache (empty if not found). Does not transfer ownership;
+     *         release it before the next lookup or resize.
+     */
+    LRUCache::Pin getTrackFromCache(TrackId track_id);
+
+    /**
+     * @brief Sample format newly cached tracks are stored in
+     */
+    void set_cache_sample_format(SampleFormat format) { cold_format = format; }
+    SampleFormat get_cache_sample_format() const { return cold_format; }
+
+    /**
+     * @brief Bytes of waveform samples currently held by the cache
+     */
+    size_t get_cache_waveform_bytes() const { return cache.waveform_bytes(); }
+
     /**
-     * @brief Get a track from the cache by its title.
-     * @param track_title The title of the track to retrieve.
-     * @return A raw pointer to the track if found, otherwise nullptr. Does not transfer ownership.
+     * @brief Number of evicted tracks kept compressed (0 disables the cold tier)
      */
-    AudioTrack* getTrackFromCache(const std::string& track_title);
+    void set_cold_cache_size(size_t tracks) { cold_tier.set_capacity(tracks); }
+    const ColdTrackStore& get_cold_tier() const { return cold_tier; }
+
+    /**
+     * @brief Enable the disk tier with a segment file at path (removed at shutdown)
+     * @return false if the file cannot be created
+     */
+    bool open_spill_file(const std::string& path);
+    const SpillStore& get_spill_tier() const { return spill_tier; }
+
+    /**
+     * @brief Pre-load tracks into the cache before the session starts
+     * @param tracks Library tracks, most likely to be requested first; only the
+     *        first capacity() distinct ones are used
+     * @param threads Worker count for load + analysis, 0 = hardware concurrency
+     *
+     * Clones are loaded and analyzed in parallel with their log output muted (it
+     * would interleave), then inserted so that the first track is the MRU one.
+     */
+    WarmUpStats warm_cache(const std::vector<AudioTrack*>& tracks, unsigned threads = 0);
+
+    /**
+     * @brief Enable or disable TinyLFU admission (disabled: plain LRU, always admit)
+     */
+    void set_admission_filter(bool enabled);
+    bool has_admission_filter() const { return admission_enabled; }
+    const CacheTierStats& get_tier_stats() const { return tier_stats; }
+
+    /**
+     * @brief Publish cache metrics to a registry (not owned; nullptr = off)
+     *
+     * Counters: dj_cache_lookups_total{tier=hot|cold|disk|miss},
+     * dj_cache_evictions_total, dj_cache_admission_rejections_total.
+     * Gauges: dj_cache_resident_bytes{tier}, dj_cache_resident_tracks{tier},
+     * dj_cache_capacity_tracks. Histograms: dj_cache_lookup_seconds{tier},
+     * dj_track_clone_seconds{stage="cache"}, dj_track_analysis_seconds{stage="cache"}.
+     */
+    void set_metrics(MetricsRegistry* registry);
 
 private:
+    // series of the registry given to set_metrics(); unused while metrics_enabled is false
+    struct Instruments {
+        Counter* lookups[4] = {};  // indexed by Tier
+        Histogram* lookup_seconds[4] = {};
+        Counter* evictions = nullptr;
+        Counter* rejections = nullptr;
+        Gauge* resident_bytes[3] = {};  // hot, cold, disk
+        Gauge* resident_tracks[3] = {};
+        Gauge* capacity = nullptr;
+        Histogram* clone_seconds = nullptr;
+        Histogram* analysis_seconds = nullptr;
+    };
+    enum Tier { HOT, COLD, DISK, MISS };
+
+
+    SpillStore spill_tier;     // tiers are declared before the tier above them, which points at them
+    ColdTrackStore cold_tier;
     LRUCache cache;
+    SampleFormat cold_format;
+    CacheTierStats tier_stats;
+    bool admission_enabled;
+    FrequencySketch sketch;
+    PointerWrapper<AudioTrack> bypass;  // last track the admission filter rejected
+    AdaptiveCapacity adaptive;
+    bool metrics_enabled;
+    Instruments metrics;
+
+    /**
+     * @brief loadTrackToCache() without the adaptive bookkeeping
+     */
+    int load_through_tiers(AudioTrack& track);
+
+    /**
+     * @brief Count a lookup and resize at the end of each window (adaptive mode)
+     */
+    void adapt(bool hit);
+
+    /**
+     * @brief Put a track into the hot tier, or into the bypass slot if the filter rejects it
+     * @return -1 if a track was evicted, else 0
+     */
+    int admit(PointerWrapper<AudioTrack> track);
+
+    /**
+     * @brief Count a lookup served by tier, with its duration, and refresh the gauges
+     */
+    void record_lookup(Tier tier, double ms, int result);
 };
 
 #endif // DJCONTROLLERSERVICE_H
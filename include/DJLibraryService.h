@@ -4,8 +4,12 @@
 #include "Playlist.h"
 #include "AudioTrack.h"
 #include "SessionFileParser.h"
+#include "TrackCatalog.h"
+#include "BpmIndex.h"
+#include "MetricsRegistry.h"
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 // Service responsible for managing the track library and playlists
 // Phase 4 behavior alignment:
@@ -14,9 +18,14 @@
 class DJLibraryService {
 public:
     DJLibraryService(const Playlist& playlist);
-    DJLibraryService(): playlist(), library(){}
+    DJLibraryService(): playlist(), library(), catalog(), bpm_index(), title_ids(), title_artist_ids(), artist_ids(),
+        clone_seconds(nullptr), analysis_seconds(nullptr) {}
     ~DJLibraryService();
 
+    // The library tracks are owned
+    DJLibraryService(const DJLibraryService&) = delete;
+    DJLibraryService& operator=(const DJLibraryService&) = delete;
+
     /**
      * @brief Build the track library from parsed config data
      * @param library_tracks Vector of track info from config
@@ -37,12 +46,56 @@ public:
     void displayLibrary() const;
 
     /**
-     * @brief Find a track in the library by its title.
-     * @param track_title The title of the track to find.
+     * @brief Find a track in the library by its id.
+     * @param track_id The id of the track to find.
      * @return A raw pointer to the AudioTrack if found, otherwise nullptr.
      * The library retains ownership of the track.
+     * O(1); sees the whole catalog, not just the loaded playlist.
+     */
+    AudioTrack* findTrack(TrackId track_id);
+
+    /**
+     * @brief Find a library track by title and one of its artists.
+     * @return A raw pointer to the AudioTrack if found, otherwise nullptr.
+     * The library retains ownership of the track.
+     */
+    AudioTrack* findTrack(const std::string& track_title, const std::string& artist);
+
+    /**
+     * @brief Get the ids of every library track credited to an artist.
+     */
+    std::vector<TrackId> findTracksByArtist(const std::string& artist) const;
+
+    /**
+     * @brief Columnar catalog of the library (bpm, duration, format, quality, ...)
+     * Built by buildLibrary; use it for scans instead of walking the AudioTrack objects.
+     */
+    const TrackCatalog& getCatalog() const { return catalog; }
+
+    /**
+     * @brief BPM index over the whole library, built by buildLibrary
+     * query(bpm, tolerance) is every track within tolerance of bpm, grouped by
+     * ascending BPM, without copying.
+     */
+    const BpmIndex& getBpmIndex() const { return bpm_index; }
+
+    /**
+     * @brief Time playlist clones and their analysis into a registry (not owned; nullptr = off)
+     * Series: dj_track_clone_seconds and dj_track_analysis_seconds, stage="playlist".
+     */
+    void setMetrics(MetricsRegistry* registry);
+
+    /**
+     * @brief Resolve a title to its interned track id (config/UI boundary).
+     * @return The id of the first library track with this title, or INVALID_TRACK_ID.
      */
-    AudioTrack* findTrack(const std::string& track_title);
+    TrackId resolveTitle(const std::string& track_title) const;
+
+    /**
+     * @brief Get the title of a library track (UI boundary).
+     * @return The track title, or an empty string for an unknown id.
+     */
+    const std::string& getTrackTitle(TrackId track_id) const;
 
     /**
      * @brief Get a vector of all track titles in the current playlist.
@@ -50,9 +103,23 @@ public:
      */
     std::vector<std::string> getTrackTitles() const;
 
+    /**
+     * @brief Get the ids of all tracks in the current playlist, in playlist order.
+     */
+    std::vector<TrackId> getTrackIds() const;
+
 private:
     Playlist playlist;
-    std::vector<AudioTrack*> library;  // Library of all tracks (owned)
+    std::vector<AudioTrack*> library;  // Library of all tracks (owned), indexed by TrackId
+    TrackCatalog catalog;              // Same tracks as columns, row i == TrackId i
+    BpmIndex bpm_index;                // Bucketed by BPM, rebuilt by buildLibrary
+    std::unordered_map<std::string, TrackId> title_ids;  // Interning table built by buildLibrary
+    std::unordered_map<std::string, TrackId> title_artist_ids;  // "title\nartist" -> id, one entry per credited artist
+    std::unordered_map<std::string, std::vector<TrackId>> artist_ids;  // artist -> ids, in library order
+    Histogram* clone_seconds;          // set by setMetrics, nullptr = not timed
+    Histogram* analysis_seconds;
+
+    static std::string titleArtistKey(const std::string& track_title, const std::string& artist);
 };
 
 #endif // DJLIBRARYSERVICE_H
@@ -5,6 +5,8 @@
 #include "MixingEngineService.h"
 #include "SessionFileParser.h"
 #include "ConfigurationManager.h"
+#include "AccessLog.h"
+#include "MetricsRegistry.h"
 #include <string>
 #include <vector>
 
@@ -30,6 +32,10 @@ private:
     // Session identification
     std::string session_name;
 
+    // Metrics the services publish to (metrics_path), declared first: they point into it
+    MetricsRegistry metrics;
+    MetricsExporter metrics_exporter;
+
     // Service-oriented architecture: delegate to services
     DJLibraryService library_service;
     DJControllerService controller_service;
@@ -38,18 +44,24 @@ private:
     // Configuration and session state
     ConfigurationManager config_manager;
     SessionConfig session_config;
-    std::vector<std::string> track_titles;
+    std::vector<TrackId> track_ids;  // current playlist, in play order
     bool play_all;
+    bool optimize_order;             // reorder each playlist to minimize BPM/key jumps
+    bool suggest_next;               // print a next-track suggestion after each deck load
+    AccessLog access_log;            // requests of earlier sessions and this one
+    std::vector<bool> requested;     // per TrackId: asked for at least once this session
     // Session statistics
     struct SessionStats {
         size_t tracks_processed = 0;
         size_t cache_hits = 0;
         size_t cache_misses = 0;
         size_t cache_evictions = 0;
-        size_t deck_loads_a = 0;
-        size_t deck_loads_b = 0;
+        std::vector<size_t> deck_loads = std::vector<size_t>(2, 0);  // one counter per deck
         size_t transitions = 0;
         size_t errors = 0;
+        size_t first_requests = 0;       // first request of each track this session
+        size_t first_request_hits = 0;   // ... served from the cache (warm-up)
+        WarmUpStats warm_up = WarmUpStats();
     } stats;
 
 public:
@@ -78,17 +90,25 @@ public:
 
     /**
      * Contract: Demand-load a track into the controller cache.
-     * - Input: The name of the track to load.
+     * - Input: The library id of the track to load.
      * - Output: An integer indicating a HIT (1) or MISS (0).
      */
-    int load_track_to_controller(const std::string& track_name);
+    int load_track_to_controller(TrackId track_id);
 
     /**
      * Contract: Load a cached track into a mixer deck (instant-transition model)
-     * - Input: track title (or key).
+     * - Input: track id (key).
      * - Output: true on success; false if not found in cache or clone fails
      */
-    bool load_track_to_mixer_deck(const std::string& track_title);
+    bool load_track_to_mixer_deck(TrackId track_id);
+
+    /**
+     * Contract: Suggest which library track can follow the one on the active deck
+     * - Picks the closest BPM within bpm_tolerance (ties: higher quality score),
+     *   excluding the playing track itself.
+     * - Output: track id, or INVALID_TRACK_ID if nothing is playing or nothing is compatible
+     */
+    TrackId suggest_next_track() const;
 
     /**
      * Contract: Orchestrate the DJ performance simulation
@@ -100,6 +120,21 @@ public:
 
     const std::string& get_session_name() const { return session_name; }
 
+    /**
+     * @brief Enable playlist reordering (PlaylistOptimizer) when playlists are loaded
+     */
+    void set_optimize_order(bool enabled) { optimize_order = enabled; }
+
+    /**
+     * @brief Print suggest_next_track() after each track reaches a deck
+     */
+    void set_suggest_next(bool enabled) { suggest_next = enabled; }
+
+    /**
+     * @brief Play decks through a real-time render thread (see RenderEngine)
+     */
+    void enable_render_thread() { mixing_service.enable_render_thread(); }
+
     // TODO: Add more status and display methods as needed, delegating to services
 
 private:
@@ -116,6 +151,16 @@ private:
      * @return Selected playlist name, or empty string if cancelled
      */
     std::string display_playlist_menu_from_config();
+    /**
+     * @brief Reorder track_ids with PlaylistOptimizer and report cost and solve time
+     */
+    void optimize_track_order();
+
+    /**
+     * @brief Load the access log and pre-load its top tracks into the controller cache
+     */
+    void warm_up_from_access_log();
+
     /**
      * @brief Print final session summary with statistics
      */
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Sums any number of decks into one output buffer
+ *
+ * out[i] = sum over decks d of gains[d] * decks[d][i]. The buffer is processed in
+ * CHUNK-sample pieces so each piece of the output stays in cache while every deck
+ * is added to it. From PARALLEL_MIN_DECKS decks and PARALLEL_MIN_SAMPLES samples on,
+ * the chunks are shared between the calling thread and the mixer's workers; below
+ * that the mix is memory-bound or too short to split, and runs on the caller.
+ *
+ * The workers are started by the constructor and sleep between mixes, so mix()
+ * never creates a thread. One mixer serves one calling thread at a time.
+ */
+class DeckMixer {
+public:
+    static constexpr size_t CHUNK = 4096;
+    static constexpr size_t PARALLEL_MIN_DECKS = 4;
+    static constexpr size_t PARALLEL_MIN_SAMPLES = 4 * CHUNK;
+
+    /**
+     * @param threads Threads sharing a large mix, the caller included: 0 = hardware
+     *        concurrency, 1 = no workers
+     */
+    explicit DeckMixer(unsigned threads = 0);
+    ~DeckMixer();
+
+    DeckMixer(const DeckMixer&) = delete;
+    DeckMixer& operator=(const DeckMixer&) = delete;
+
+    /**
+     * @param decks deck_count pointers to count samples each
+     * @param gains deck_count linear gains
+     */
+    void mix(const float* const* decks, const float* gains, size_t deck_count, float* out, size_t count);
+
+    /**
+     * @brief Same sum on the calling thread only, for callers that own no mixer (e.g. a render block)
+     */
+    static void mix_inline(const float* const* decks, const float* gains, size_t deck_count,
+                           float* out, size_t count);
+
+    unsigned get_threads() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+private:
+    struct Job {
+        const float* const* decks;
+        const float* gains;
+        size_t deck_count;
+        float* out;
+        size_t count;
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;      // workers: a new job was posted, or stop
+    std::condition_variable finished;  // caller: the last worker left the job
+    Job job;
+    uint64_t generation;               // bumped once per posted job
+    size_t busy;                       // workers not done with the current job
+    bool stopping;
+    std::atomic<size_t> next_chunk;
+
+    void run();
+
+    /**
+     * @brief Mix chunks of job until none is left (caller and workers together)
+     */
+    void work(const Job& current);
+
+    static void mix_range(const float* const* decks, const float* gains, size_t deck_count,
+                          float* out, size_t begin, size_t end);
+};
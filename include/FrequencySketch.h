@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Approximate access counts for cache admission (TinyLFU)
+ *
+ * A count-min sketch: DEPTH rows of counters, each key hashed to one counter per
+ * row; increment() bumps all of them and estimate() returns the smallest, so hash
+ * collisions can only over-count. Counters saturate at 15 (4 bits of information,
+ * stored one per byte for simplicity).
+ *
+ * Aging: after 10 increments per counter of a row, every counter is halved, so
+ * the sketch follows the recent popularity of tracks rather than their whole
+ * history and stale favourites eventually lose to new ones.
+ */
+class FrequencySketch {
+public:
+    static constexpr size_t DEPTH = 4;
+    static constexpr uint8_t MAX_COUNT = 15;
+
+    /**
+     * @param expected_items Number of items the cache holds; sizes the rows
+     */
+    explicit FrequencySketch(size_t expected_items = 16);
+
+    /**
+     * @brief Resize for a new cache capacity
+     * Counts are kept if the row width does not change, else forgotten.
+     */
+    void resize(size_t expected_items);
+
+    void increment(uint32_t key);
+    uint8_t estimate(uint32_t key) const;
+
+    /**
+     * @brief Halve every counter (done automatically every sample_size() increments)
+     */
+    void age();
+
+    size_t width() const { return mask + 1; }
+    size_t sample_size() const { return 10 * width(); }
+    size_t get_ages() const { return ages; }
+
+private:
+    std::vector<uint8_t> counters;  // DEPTH rows of width() counters
+    size_t mask;
+    size_t additions;
+    size_t ages;
+
+    size_t slot(uint32_t key, size_t row) const;
+};
@@ -1,12 +1,14 @@
 #pragma once
 
 #include "CacheSlot.h"
+#include "ColdTrackStore.h"
 #include "AudioTrack.h"
 #include "PointerWrapper.h"
+#include <shared_mutex>
+#include <utility>
 #include <vector>
 #include <cstddef>
 #include <cstdint>
-#include <string>
 
 /**
  * @brief LRU Cache Implementation
@@ -16,15 +18,55 @@
  * It's decoupled from file I/O, UI concerns, and mixing operations.
  * 
  * Phase 4 usage contract:
- * - Used by DJControllerService with fixed capacity in this assignment.
+ * - Used by DJControllerService; capacity can change at runtime (set_capacity()).
  * - get() marks entries MRU by updating their access time.
  * - put() inserts as MRU and evicts true LRU when full.
+ *
+ * Thread safety: queries (contains, size, capacity, lru_id, waveform_bytes,
+ * displayStatus) take a shared lock, everything that changes the slots or the
+ * LRU order (get, put, evictLRU, clear, set_capacity) an exclusive one. get()
+ * returns a Pin, which holds the shared lock: its track cannot be evicted, and
+ * writers wait, until the Pin is released. Evicted tracks reach the eviction
+ * target under the exclusive lock, so the target's owner must not touch it from
+ * another thread.
  */
 class LRUCache {
+public:
+    /**
+     * @brief A cached track kept alive by a shared lock on its cache
+     *
+     * Empty when the lookup missed. Release it before changing the cache from
+     * the same thread: a writer waits for every Pin, its own included.
+     */
+    class Pin {
+    public:
+        Pin() : lock(), track(nullptr) {}
+        Pin(std::shared_lock<std::shared_mutex> lock, AudioTrack* track) : lock(std::move(lock)), track(track) {}
+
+        // A track held outside any cache (e.g. the controller's bypass slot); pins nothing
+        explicit Pin(AudioTrack* track) : lock(), track(track) {}
+
+        Pin(Pin&&) = default;
+        Pin& operator=(Pin&&) = default;
+        Pin(const Pin&) = delete;
+        Pin& operator=(const Pin&) = delete;
+
+        AudioTrack* get() const { return track; }
+        AudioTrack& operator*() const { return *track; }
+        AudioTrack* operator->() const { return track; }
+        explicit operator bool() const { return track != nullptr; }
+
+    private:
+        std::shared_lock<std::shared_mutex> lock;
+        AudioTrack* track;
+    };
+
 private:
     std::vector<CacheSlot> slots;
     size_t max_size;
     uint64_t access_counter;
+    ColdTrackStore* eviction_target;  // receives evicted tracks (not owned); nullptr = destroy them
+    mutable std::shared_mutex mutex;
 
 public:
     /**
@@ -32,23 +74,27 @@ public:
      * @param capacity Maximum number of tracks to cache
      */
     explicit LRUCache(size_t capacity);
+
+    // Slots own their tracks, and eviction_target is not owned
+    LRUCache(const LRUCache&) = delete;
+    LRUCache& operator=(const LRUCache&) = delete;
     
     /**
      * @brief Check if cache contains a track
      * @param track_id Track identifier to search for
      * @return true if track is in cache
      */
-    bool contains(const std::string& track_id) const;
+    bool contains(TrackId track_id) const;
     
     /**
      * @brief Get a track from cache (updates LRU order)
      * @param track_id Track identifier
-     * @return Raw pointer to track, or nullptr if not found
+     * @return The track pinned in the cache, or an empty Pin if not found
      * 
      * This method updates access time, moving the track to
      * "most recently used" position in LRU algorithm.
      */
-    AudioTrack* get(const std::string& track_id);
+    Pin get(TrackId track_id);
     
     /**
      * @brief Put a track into cache (handles eviction if full)
@@ -63,24 +109,43 @@ public:
     /**
      * @brief Manually evict the least recently used track
      * @return true if a track was evicted
+     *
+     * The track is moved into the eviction target if one is set, else destroyed.
      */
     bool evictLRU();
+
+    /**
+     * @brief Id of the track evictLRU() would evict next
+     * @return INVALID_TRACK_ID if the cache is empty
+     */
+    TrackId lru_id() const;
+
+    /**
+     * @brief Send evicted tracks to a second tier instead of destroying them
+     * @param target Store to receive them (not owned), or nullptr
+     */
+    void set_eviction_target(ColdTrackStore* target) { eviction_target = target; }
     
     /**
      * @brief Get current cache usage
      * @return Number of occupied slots
      */
     size_t size() const;
+
+    /**
+     * @brief Bytes of waveform samples held by the cached tracks
+     */
+    size_t waveform_bytes() const;
     
     /**
      * @brief Get maximum cache capacity
      */
-    size_t capacity() const { return max_size; }
+    size_t capacity() const;
     
     /**
      * @brief Check if cache is full
      */
-    bool isFull() const { return size() >= max_size; }
+    bool isFull() const;
     
     /**
      * @brief Clear all cache entries
@@ -92,17 +157,22 @@ public:
      */
     void displayStatus() const;
     /**
-     * @brief Update LRU Cache capacity
-     * This method should be used only once.
+     * @brief Change the capacity while the cache is in use
+     * @return Number of tracks evicted
+     *
+     * Shrinking evicts in true LRU order (through the eviction target) until the
+     * tracks fit, then packs the remaining slots to the front. Growing reserves
+     * geometrically, so a cache grown one slot at a time reallocates its slot
+     * array only O(log n) times.
      */
-    void set_capacity(size_t capacity);
+    size_t set_capacity(size_t capacity);
 private:
     /**
      * @brief Find slot containing specific track
      * @param track_id Track identifier
      * @return Slot index, or max_size if not found
      */
-    size_t findSlot(const std::string& track_id) const;
+    size_t findSlot(TrackId track_id) const;
     
     /**
      * @brief Find the least recently used slot
@@ -115,4 +185,8 @@ private:
      * @return Slot index, or max_size if cache is full
      */
     size_t findEmptySlot() const;
+
+    // Callers hold the lock
+    bool evict_lru_locked();
+    size_t size_locked() const;
 };
\ No newline at end of file
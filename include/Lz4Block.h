@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief LZ4 block format compressor/decompressor (stateless)
+ *
+ * Produces standard LZ4 blocks (no frame header): sequences of literals followed
+ * by a back-reference of at least four bytes within a 64 KiB window. The
+ * compressor is the single-probe greedy matcher of the reference "fast" mode with
+ * a 4096-entry hash table; decompression is a bounds-checked copy loop and runs
+ * at memory speed.
+ */
+class Lz4Block {
+public:
+    /**
+     * @brief Compress size bytes into out (replacing its contents)
+     */
+    static void compress(const unsigned char* in, size_t size, std::vector<unsigned char>& out);
+
+    /**
+     * @brief Decompress a block that expands to exactly out_size bytes
+     * @return false if the block is malformed or does not fill out_size bytes
+     */
+    static bool decompress(const unsigned char* in, size_t size, unsigned char* out, size_t out_size);
+};
@@ -18,6 +18,20 @@ class MP3Track : public AudioTrack {
 private:
     int bitrate;        // Compression level: 128, 192, 320 kbps (higher = better quality)
     bool has_id3_tags;  // Whether file contains ID3 metadata (artist, album, etc.)
+    std::string file_path;  // MP3 file to decode on load (empty = metadata only)
+
+    /**
+     * Read the file's ID3v2 tag, then decode it frame by frame (Mp3Reader + Mp3Decoder)
+     * into the analysis waveform, indexing each frame on the way
+     * @return false if the file could not be read
+     */
+    bool decode_file();
+
+    /**
+     * Fill the shared seek index from the track metadata (CBR at `bitrate`,
+     * 44.1 kHz MPEG-1 Layer III frames) when there is no file to scan
+     */
+    void build_estimated_index();
 
 public:
     /**
@@ -55,6 +69,8 @@ public:
     // Getters
     int get_bitrate() const { return bitrate; }
     bool has_tags() const { return has_id3_tags; }
+    const std::string& get_file_path() const { return file_path; }
+    void set_file_path(const std::string& path) { file_path = path; }
 };
 
 #endif // MP3TRACK_H
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+/**
+ * @brief Read-only memory map of a whole file (RAII)
+ *
+ * The descriptor is closed as soon as the mapping exists; the mapping itself is
+ * released by close() or the destructor. Access is advised as sequential, which
+ * suits the streaming readers built on top of it.
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file, replacing any current mapping
+     * @return false (with get_error() set) if the file cannot be opened or is empty
+     */
+    bool open(const std::string& path);
+
+    void close();
+
+    bool is_open() const { return bytes != nullptr; }
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+    const std::string& get_error() const { return error; }
+
+private:
+    unsigned char* bytes;
+    size_t length;
+    std::string error;
+};
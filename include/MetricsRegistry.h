@@ -0,0 +1,199 @@
+#pragma once
+
+#include "PointerWrapper.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief One time series of a MetricsRegistry
+ *
+ * Updates are lock-free (atomics), so instrumented code never waits for an
+ * export in progress; an export may see a histogram mid-update, which the
+ * Prometheus text format tolerates.
+ */
+class Metric {
+public:
+    virtual ~Metric() = default;
+
+    /**
+     * @brief Append the sample lines of this series
+     * @param labels Label pairs without braces (name="value",...), may be empty
+     */
+    virtual void write(std::ostream& out, const std::string& name, const std::string& labels) const = 0;
+};
+
+/**
+ * @brief Monotonic count of events
+ */
+class Counter : public Metric {
+public:
+    Counter() : count(0) {}
+
+    void inc(uint64_t n = 1) { count.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return count.load(std::memory_order_relaxed); }
+
+    void write(std::ostream& out, const std::string& name, const std::string& labels) const override;
+
+private:
+    std::atomic<uint64_t> count;
+};
+
+/**
+ * @brief Current value of a quantity that goes up and down
+ */
+class Gauge : public Metric {
+public:
+    Gauge() : current(0.0) {}
+
+    void set(double value) { current.store(value, std::memory_order_relaxed); }
+    double value() const { return current.load(std::memory_order_relaxed); }
+
+    void write(std::ostream& out, const std::string& name, const std::string& labels) const override;
+
+private:
+    std::atomic<double> current;
+};
+
+/**
+ * @brief Distribution of observed values over fixed buckets
+ *
+ * Buckets are counted individually and made cumulative when written, as the
+ * format's le="..." buckets are; _count is their total.
+ */
+class Histogram : public Metric {
+public:
+    /**
+     * @param bounds Upper bounds of the buckets, ascending; +Inf is implied
+     */
+    explicit Histogram(const std::vector<double>& bounds);
+
+    void observe(double value);
+
+    uint64_t count() const;
+    double sum() const { return total.load(std::memory_order_relaxed); }
+
+    void write(std::ostream& out, const std::string& name, const std::string& labels) const override;
+
+    /**
+     * @brief Bounds for durations in seconds, 10 us to 2.5 s
+     */
+    static std::vector<double> seconds();
+
+private:
+    std::vector<double> bounds;
+    std::vector<std::atomic<uint64_t>> buckets;  // bounds.size() + 1, the last one is +Inf
+    std::atomic<double> total;
+};
+
+/**
+ * @brief Named counters, gauges and histograms, rendered in Prometheus text format
+ *
+ * Series are created on first use and live as long as the registry, so callers
+ * look a series up once and keep the returned reference. A name is one metric
+ * family (one # HELP / # TYPE header); series of a family differ by their labels,
+ * e.g. counter("dj_cache_hits_total", "...", "tier=\"cold\"").
+ *
+ * Asking for an existing name with another type throws std::invalid_argument.
+ *
+ * Thread safety: creating series and render() are serialized by a mutex;
+ * updating a series needs no lock.
+ */
+class MetricsRegistry {
+public:
+    MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    Histogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "",
+                         const std::vector<double>& bounds = Histogram::seconds());
+
+    /**
+     * @brief All families in creation order, text exposition format 0.0.4
+     */
+    std::string render() const;
+
+    /**
+     * @brief Write render() to path through a temporary file and a rename,
+     *        so a scraper never reads a half-written file
+     */
+    bool write_file(const std::string& path) const;
+
+private:
+    struct Series {
+        std::string labels;
+        PointerWrapper<Metric> metric;
+    };
+    struct Family {
+        std::string name;
+        std::string help;
+        std::string type;  // counter, gauge or histogram
+        std::vector<Series> series;
+    };
+
+    std::vector<Family> families;
+    mutable std::mutex mutex;
+
+    /**
+     * @brief The family called name, created if new
+     * @throws std::invalid_argument if it exists with another type (a programming error)
+     */
+    Family& family_of(const std::string& name, const std::string& help, const char* type);
+
+    /**
+     * @brief The series with these labels, or nullptr
+     */
+    static Metric* find(Family& family, const std::string& labels);
+};
+
+/**
+ * @brief Background thread that writes a registry to a file every interval
+ *
+ * The file is what node_exporter's textfile collector (or a plain `cat`) reads,
+ * so a long session can be scraped while it runs. stop() (also run by the
+ * destructor) writes a final snapshot, so the file ends with the final counts.
+ */
+class MetricsExporter {
+public:
+    explicit MetricsExporter(const MetricsRegistry& registry);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /**
+     * @brief Write the file once, then keep rewriting it every interval_ms
+     * @return false if the file cannot be written (no thread is started)
+     */
+    bool start(const std::string& path, unsigned interval_ms);
+
+    /**
+     * @brief Stop the thread after a last write (no-op if not running)
+     */
+    void stop();
+
+    bool running() const { return worker.joinable(); }
+    const std::string& get_path() const { return path; }
+    size_t writes() const { return write_count.load(); }
+
+private:
+    const MetricsRegistry& registry;
+    std::string path;
+    unsigned interval_ms;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::atomic<size_t> write_count;
+
+    void run();
+};
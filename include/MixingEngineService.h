@@ -2,26 +2,51 @@
 #define MIXINGENGINESERVICE_H
 
 #include "AudioTrack.h"
+#include "CrossfadeEngine.h"
+#include "RenderEngine.h"
+#include "MetricsRegistry.h"
 #include <string>
+#include <vector>
+#include <cstdint>
 
 // Service responsible for deck operations and track analysis
 // Phase 4 binding:
-// - Enforces instant transitions and deck alternation policy.
+// - Enforces instant transitions and deck rotation policy: each track goes to the
+//   least recently loaded deck other than the active one (alternation with 2 decks).
 // - After loading to a deck: call track.load(); then analyze_beatgrid(); then switch active deck.
-// - The previously active deck becomes finished and is unloaded immediately.
+// - The previously active deck becomes finished and is unloaded once the crossfade
+//   into the new deck has been rendered (immediately if the crossfade time is 0).
+//   With the render thread it is faded out there instead, mixed with the new deck,
+//   and stays loaded until the rotation picks its deck again.
 class MixingEngineService {
 private:
-    AudioTrack* decks[2];
+    std::vector<AudioTrack*> decks;   // deck_count entries, nullptr when empty
+    std::vector<uint64_t> last_used;  // use_clock value of each deck's last load (0 = never)
+    uint64_t use_clock;
     size_t active_deck;
     bool auto_sync;
     int bpm_tolerance;
+    CrossfadeEngine crossfade;
+    PointerWrapper<RenderEngine> renderer;  // set once the render thread is enabled
+    Histogram* clone_seconds;               // set by set_metrics(), nullptr = not timed
+    Histogram* analysis_seconds;
+
+    // Delete a deck's track, or hand it to the render thread for deferred reclamation
+    void unload_deck(size_t deck);
+
+    // Least-recently-used idle deck (any deck before the first load)
+    size_t pick_target_deck(bool is_first_track) const;
 public:
     MixingEngineService();
     ~MixingEngineService();
 
+    // Deck tracks are owned
+    MixingEngineService(const MixingEngineService&) = delete;
+    MixingEngineService& operator=(const MixingEngineService&) = delete;
+
     /** Contract: Load a track to the next deck per instant-transition policy
      * - @param track: reference to a cached track to be cloned for the mixer
-     * - @return: index of the deck the track was loaded to (0 or 1), or -1 on failure.
+     * - @return: index of the deck the track was loaded to (0..deck count - 1), or -1 on failure.
      * - @brief: This function clones the track, unloads the target deck if needed, loads the new track, analyzes the beatgrid, switches the active deck, and unloads the previous deck.
      * - @attention: on clone failure, log an error and return
      */
@@ -30,19 +55,46 @@ public:
     // Display deck status
     void displayDeckStatus() const;
 
+    /**
+     * @brief Set the number of decks (clamped to 2..RenderEngine::MAX_DECKS, with a warning)
+     * Loaded decks are unloaded; meant to be called from configuration before playing.
+     */
+    void set_deck_count(size_t requested);
+
+    size_t get_deck_count() const { return decks.size(); }
+
+    /**
+     * @brief Track currently playing on the active deck
+     * @return Non-owning pointer, or nullptr if the active deck is empty
+     */
+    const AudioTrack* getActiveTrack() const { return decks[active_deck]; }
+
     /**
      * Contract: Determine if decks A and the given track can be mixed
      * @return true if mixable by BPM/key criteria; false otherwise
      */
     bool can_mix_tracks(const PointerWrapper<AudioTrack>& track) const;
 
+    /**
+     * Contract: Combined compatibility of the active deck and the given track
+     * @return score in [0, 1] (0 if the active deck is empty); see the static overload
+     */
+    double compatibility_score(const PointerWrapper<AudioTrack>& track) const;
+
+    /**
+     * @brief Combined compatibility of two tracks in [0, 1]
+     * Weighted sum of BPM closeness (0.5, reaches 0 at twice bpm_tolerance), Camelot
+     * harmonic score (0.3) and RMS energy closeness (0.2). Uses cached per-track analysis.
+     */
+    static double compatibility_score(const AudioTrack& a, const AudioTrack& b, int bpm_tolerance);
+
     /**
      * Contract: Synchronize BPM between active deck and given track.
-     * - @param track: Pointer to the track to sync with the currently active deck
-     * - @brief This function calculates average BPM between active deck and given track, then sets the given track's BPM to the average
-     * - @attention What should be the preconditions of this function? What this method modifies?
+     * - @param track: The incoming track (not yet on a deck); its waveform is stretched in place
+     * - @brief This function calculates average BPM between active deck and given track, then stretches the given track to the average
+     * - @attention Precondition: the active deck holds a track; otherwise nothing changes.
      */
-    void sync_bpm(const PointerWrapper<AudioTrack>& track) const;
+    void sync_bpm(AudioTrack& track) const;
 
     /**
      * @brief set auto sync mode
@@ -60,6 +112,29 @@ public:
         bpm_tolerance = tolerance;
     }
 
+    /**
+     * @brief Set the crossfade length in seconds (0 = instant transition)
+     */
+    void set_crossfade_time(int seconds) {
+        crossfade.set_crossfade_time(seconds);
+    }
+
+    const CrossfadeEngine& get_crossfade_engine() const { return crossfade; }
+
+    /**
+     * @brief Start a render thread that mixes the loaded decks block by block
+     * From then on deck tracks are owned by the RenderEngine: loads and unloads are
+     * published to it lock-free and freed tracks are reclaimed off the audio path.
+     * Callback jitter and deadline misses are printed when the service shuts down.
+     */
+    void enable_render_thread();
+
+    /**
+     * @brief Time deck clones and their analysis into a registry (not owned; nullptr = off)
+     * Series: dj_track_clone_seconds and dj_track_analysis_seconds, stage="deck".
+     */
+    void set_metrics(MetricsRegistry* registry);
+
 };
 
 #endif // MIXINGENGINESERVICE_H
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Mp3Reader.h"
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Frame-by-frame MPEG-1 Layer III decoder
+ *
+ * decode() turns one frame handed out by Mp3Reader::next_frame() into PCM:
+ * side info and scalefactors, the Huffman-coded spectrum, requantization,
+ * mid/side and intensity stereo, short-block reordering, alias reduction,
+ * IMDCT with overlap-add and the 32-band polyphase synthesis filterbank.
+ * Each call yields one 1152-sample block, so a deck can be fed as frames arrive.
+ *
+ * A frame's main data may start in earlier frames (the bit reservoir), and the
+ * transforms overlap from frame to frame, so frames must be fed in stream order.
+ * After a seek, call reset(): frames whose main data begins before the first one
+ * fed decode to silence until the reservoir has filled.
+ *
+ * MPEG-2/2.5 (half and quarter sample rates) and Layers I/II are not decoded;
+ * supports() is false for them.
+ */
+class Mp3Decoder {
+public:
+    static const int MAX_FRAME_SAMPLES = 1152;  // per channel
+
+    Mp3Decoder();
+
+    Mp3Decoder(const Mp3Decoder&) = delete;
+    Mp3Decoder& operator=(const Mp3Decoder&) = delete;
+
+    /**
+     * @brief True for MPEG-1 Layer III frames, the only ones decode() accepts
+     */
+    static bool supports(const Mp3FrameHeader& header);
+
+    /**
+     * @brief Decode one frame into header.samples interleaved sample frames of header.channels
+     * floats (full scale +-1.0)
+     * @return false if the frame could not be decoded (damaged side info, main data
+     * that starts before the first frame fed since reset(), or an unsupported format);
+     * out then holds silence so the stream keeps its timing
+     */
+    bool decode(const Mp3Frame& frame, float* out);
+
+    /**
+     * @brief Forget the bit reservoir and the filter state, as after a seek
+     */
+    void reset();
+
+private:
+    class BitReader;
+
+    struct Granule {
+        int part2_3_length;
+        int big_values;
+        int global_gain;
+        int scalefac_compress;
+        bool window_switching;
+        int block_type;      // 0 normal, 1 start, 2 short, 3 stop
+        bool mixed_block;
+        int table_select[3];
+        int subblock_gain[3];
+        int region0_count;
+        int region1_count;
+        bool preflag;
+        bool scalefac_scale;
+        int count1_table;
+    };
+
+    struct SideInfo {
+        int main_data_begin;
+        bool scfsi[2][4];
+        Granule granules[2][2];  // [granule][channel]
+    };
+
+    std::vector<unsigned char> reservoir;  // main data of the frames fed so far, newest last
+    int scalefac_long[2][22];      // [channel][band]; kept across granules for scfsi
+    int scalefac_short[2][13][3];  // [channel][band][window]
+    int values[2][576];            // Huffman-decoded spectrum
+    int nonzero[2];                // lines up to the last nonzero value
+    float spectrum[2][576];
+    float overlap[2][576];         // second half of the previous IMDCT outputs
+    float synthesis[2][1024];      // polyphase filterbank history, a ring of 16 64-sample blocks
+    int synthesis_offset[2];       // start of the newest block in the ring
+
+    bool read_side_info(const Mp3Frame& frame, int channels, size_t header_bytes, SideInfo& side) const;
+    void read_scalefactors(BitReader& bits, const Granule& granule, int gr, int ch, const SideInfo& side);
+    void read_spectrum(BitReader& bits, const Granule& granule, size_t end, int sample_rate, int ch);
+    void requantize(const Granule& granule, int sample_rate, int ch);
+    void joint_stereo(const Granule& granule, int sample_rate, int mode_extension);
+    void reorder(const Granule& granule, int sample_rate, int ch);
+    void reduce_aliasing(const Granule& granule, int ch);
+    void synthesize(const Granule& granule, int ch, int channels, float* out);
+    void filter_slot(const float* subbands, int ch, int channels, float* out);
+};
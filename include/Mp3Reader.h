@@ -0,0 +1,139 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Text fields read from an ID3v2 tag
+ */
+struct Id3Tag {
+    bool present;
+    int version;        // 2, 3 or 4 (ID3v2.x)
+    size_t size;        // bytes occupied at the start of the file, header included
+    std::string title;  // TIT2
+    std::string artist; // TPE1
+    std::string album;  // TALB
+    std::string bpm;    // TBPM
+    std::string key;    // TKEY
+
+    Id3Tag() : present(false), version(0), size(0), title(), artist(), album(), bpm(), key() {}
+};
+
+/**
+ * @brief Fields of one MPEG audio frame header
+ */
+struct Mp3FrameHeader {
+    int version;         // 10 = MPEG-1, 20 = MPEG-2, 25 = MPEG-2.5
+    int layer;           // 1, 2 or 3
+    int bitrate_kbps;
+    int sample_rate;
+    int channels;
+    bool padding;
+    size_t frame_bytes;  // header + side info + payload
+    int samples;         // PCM samples per channel the frame decodes to
+};
+
+/**
+ * @brief One frame handed out by Mp3Reader::next_frame()
+ */
+struct Mp3Frame {
+    Mp3FrameHeader header;
+    const unsigned char* data;  // frame_bytes bytes inside the file mapping
+    size_t offset;              // byte offset of the frame in the file
+    uint64_t first_sample;      // position of the frame's first sample in the stream
+};
+
+/**
+ * @brief Incremental MPEG audio frame reader over a memory-mapped file
+ *
+ * open() maps the file, reads the ID3v2 tag (v2.2-v2.4, including unsynchronised
+ * tags) and locks onto the first frame by requiring two consecutive valid,
+ * consistent headers. If that frame is a Xing/Info header its frame count, byte
+ * count and 100-entry seek table are kept and the frame is skipped as audio.
+ * A trailing ID3v1 tag is excluded from the audio range.
+ *
+ * next_frame() then walks the stream one frame at a time, resynchronising on the
+ * next sync word if a header is damaged, so a deck can start on the first frames
+ * while the rest of the file has not been touched. seek() jumps through the Xing
+ * table for VBR files and linearly for CBR files.
+ *
+ * Frames are located and sized here; Mp3Decoder turns MPEG-1 Layer III frames
+ * into PCM as they are handed out.
+ */
+class Mp3Reader {
+public:
+    Mp3Reader();
+
+    Mp3Reader(const Mp3Reader&) = delete;
+    Mp3Reader& operator=(const Mp3Reader&) = delete;
+
+    /**
+     * @brief Map a file, read its tags and find the first audio frame
+     * @return false if the file cannot be mapped or holds no MPEG audio; see get_error()
+     */
+    bool open(const std::string& path);
+
+    void close();
+
+    /**
+     * @brief Advance to the next frame
+     * @return false at the end of the audio data
+     */
+    bool next_frame(Mp3Frame& frame);
+
+    /**
+     * @brief Move the cursor to the frame nearest to a time position
+     * Sample positions after a VBR seek are estimates, as with any TOC-based seek.
+     */
+    bool seek(double seconds);
+
+    /**
+     * @brief Move the cursor back to the first audio frame
+     */
+    void rewind();
+
+    const Id3Tag& get_tag() const { return tag; }
+    const Mp3FrameHeader& get_format() const { return first; }
+    bool has_seek_table() const { return toc_present; }
+    bool is_vbr() const { return vbr; }
+    uint32_t get_xing_frames() const { return xing_frames; }
+    double get_duration_seconds() const;
+    size_t get_audio_bytes() const { return audio_end - audio_start; }
+    size_t get_resyncs() const { return resyncs; }
+    const std::string& get_error() const { return error; }
+
+    /**
+     * @brief Decode a 4-byte frame header
+     * @return false if the bytes are not a valid header
+     */
+    static bool parse_header(const unsigned char* p, Mp3FrameHeader& header);
+
+    /**
+     * @brief Read an ID3v2 tag at the start of a buffer
+     * @return false if the buffer does not start with a complete ID3v2 tag
+     */
+    static bool parse_id3v2(const unsigned char* p, size_t size, Id3Tag& tag);
+
+private:
+    MappedFile file;
+    size_t audio_start;     // first audio frame (after ID3v2 and Xing)
+    size_t audio_end;       // end of audio (before ID3v1)
+    size_t xing_offset;     // start of the Xing frame, base of its seek table
+    size_t cursor;
+    uint64_t sample_position;
+    size_t resyncs;
+    Id3Tag tag;
+    Mp3FrameHeader first;
+    bool vbr;
+    bool toc_present;
+    uint32_t xing_frames;
+    uint32_t xing_bytes;
+    unsigned char toc[100];
+    std::string error;
+
+    size_t find_sync(size_t from) const;
+    bool read_xing(size_t offset, const Mp3FrameHeader& header);  // true if the frame is a Xing/Info header
+    bool fail(const std::string& message);
+};
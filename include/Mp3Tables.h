@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Constant tables of MPEG-1 Layer III (ISO/IEC 11172-3)
+ *
+ * Shared by Mp3Decoder and by the fixture encoder in the benchmarks, which
+ * writes the streams the decoder is checked against.
+ */
+class Mp3Tables {
+public:
+    /**
+     * @brief One Huffman code table: code and length of each (x, y) pair,
+     * or of each count1 quadruple (index 8v + 4w + 2x + y)
+     */
+    struct HuffmanTable {
+        const uint16_t* codes;
+        const uint8_t* lengths;
+        int size;     // values per axis (x and y run over 0..size-1); 16 quadruples for count1
+        int linbits;  // extra bits appended to a value of 15
+    };
+
+    /**
+     * @brief Big-value table 0..31 as selected by table_select
+     * Tables 0, 4 and 14 have no codes (size 0); 0 codes an all-zero region.
+     */
+    static const HuffmanTable& big_values(int table);
+
+    /**
+     * @brief Count1 table A (0) or B (1), selected by count1table_select
+     */
+    static const HuffmanTable& count1(int table);
+
+    /**
+     * @brief Scalefactor band boundaries: 23 long-block or 14 short-block entries
+     * for 44100, 48000 or 32000 Hz; nullptr for any other rate
+     */
+    static const int* long_bands(int sample_rate);
+    static const int* short_bands(int sample_rate);
+
+    /**
+     * @brief Bits per scalefactor for bands 0-10 (slen1) and 11-20 (slen2), by scalefac_compress
+     */
+    static const int SLEN[2][16];
+
+    /**
+     * @brief Long-block scalefactor boost applied when preflag is set
+     */
+    static const int PRETAB[22];
+
+    /**
+     * @brief Alias-reduction coefficients c_i of the 8 butterflies between subbands
+     */
+    static const double ALIAS_COEFFICIENTS[8];
+
+    /**
+     * @brief Polyphase synthesis window D[0..511]
+     * The analysis window of the encoder is D[i] / 32.
+     */
+    static const float* synthesis_window();
+};
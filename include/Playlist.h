@@ -3,6 +3,7 @@
 
 #include "AudioTrack.h"
 #include <string>
+#include <string_view>
 #include <vector>
 
 /**
@@ -55,7 +56,7 @@ public:
      * Remove a track by title
      * @param title Title of the track to remove
      */
-    void remove_track(const std::string& title);
+    void remove_track(std::string_view title);
 
     /**
      * Display all tracks in the playlist
@@ -70,11 +71,11 @@ public:
     const std::string& get_name() const { return playlist_name; }
 
     /**
-     * @param title Title of the track to find
-     * @brief Find a track by title
+     * @param track_id Library id of the track to find
+     * @brief Find a track by id
      * @return Pointer to the found track, or nullptr if not found
      */
-    AudioTrack* find_track(const std::string& title) const;
+    AudioTrack* find_track(TrackId track_id) const;
 
     /**
      * Check if playlist is empty
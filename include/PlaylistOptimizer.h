@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Reorders a playlist to minimize total BPM/key jumps between consecutive tracks
+ *
+ * Treated as an open-path TSP over the playlist's tracks. The transition cost
+ * between two tracks is
+ *     |bpm_a - bpm_b| + key_weight * (Camelot wheel distance + 0.5 if major/minor differ)
+ * (the key term is dropped when either track has no detected key).
+ *
+ * solve() runs several independent candidates in parallel: the input order plus
+ * nearest-neighbour tours from spread-out start tracks. Each candidate is improved
+ * with 2-opt and Or-opt (segments of 1..3 tracks) until no move helps; the cheapest
+ * result wins, so the returned order is never worse than the input order. Local
+ * search only tries moves that link a track to one of its K cheapest neighbours,
+ * which keeps a pass O(n * K) instead of O(n^2).
+ *
+ * Costs come from a precomputed matrix for playlists up to MATRIX_LIMIT tracks and
+ * are computed on the fly above that (the matrix would not fit in memory). In both
+ * cases rows are produced by one branch-free kernel over float feature arrays, which
+ * the compiler vectorizes.
+ */
+class PlaylistOptimizer {
+public:
+    static constexpr size_t MATRIX_LIMIT = 4096;
+
+    struct Options {
+        float key_weight;    // cost of one step on the Camelot wheel, in BPM units
+        unsigned threads;    // 0 = hardware concurrency
+        size_t starts;       // nearest-neighbour start tracks (plus the input order)
+        size_t neighbours;   // candidate list size per track for 2-opt/Or-opt moves
+        int max_passes;      // local-search passes per candidate
+
+        Options() : key_weight(4.0f), threads(0), starts(4), neighbours(10), max_passes(50) {}
+    };
+
+    struct Result {
+        std::vector<size_t> order = std::vector<size_t>();  // permutation of input positions
+        double initial_cost = 0.0;
+        double final_cost = 0.0;
+        double solve_ms = 0.0;
+    };
+
+    /**
+     * @param bpm BPM per track
+     * @param camelot Camelot number per track (1..12, 0 = key unknown)
+     * @param minor true for minor ('A') keys
+     */
+    PlaylistOptimizer(const std::vector<float>& bpm, const std::vector<int>& camelot,
+                      const std::vector<bool>& minor, const Options& options = Options());
+
+    /**
+     * @brief Find a low-cost ordering of the tracks
+     */
+    Result solve() const;
+
+    /**
+     * @brief Total transition cost of visiting tracks in the given order
+     */
+    double path_cost(const std::vector<size_t>& order) const;
+
+    size_t size() const { return bpm.size(); }
+
+private:
+    std::vector<float> bpm;
+    std::vector<float> wheel;   // Camelot number as float (0 = unknown)
+    std::vector<float> mode;    // 1 = minor, 0 = major
+    std::vector<float> known;   // 1 if the key is known
+    Options options;
+    std::vector<float> matrix;  // n*n when n <= MATRIX_LIMIT, else empty
+    std::vector<uint32_t> neighbours;  // n * K nearest tracks, cheapest first
+    size_t k;                          // neighbours per track
+
+    float cost(size_t a, size_t b) const;
+    void cost_row(size_t a, float* out) const;
+    void build_matrix();
+    void build_neighbours();
+
+    std::vector<uint32_t> nearest_neighbour(size_t start) const;
+    void improve(std::vector<uint32_t>& tour) const;
+    bool two_opt_pass(std::vector<uint32_t>& tour, std::vector<uint32_t>& pos) const;
+    bool or_opt_pass(std::vector<uint32_t>& tour, std::vector<uint32_t>& pos) const;
+    double tour_cost(const std::vector<uint32_t>& tour) const;
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "AudioTrack.h"
+#include "SpscQueue.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Real-time render loop with lock-free deck handoff
+ *
+ * A dedicated thread plays the part of a sound card callback: a simulated device
+ * clock ticks every BLOCK_SIZE / DEVICE_SAMPLE_RATE seconds and each tick mixes
+ * one block from every audible deck through DeckMixer, each at its own gain.
+ * Activating a deck ramps its gain to 1 and every other deck's to 0 over the
+ * requested fade, so the outgoing track keeps playing through a crossfade and
+ * stays loaded (silent) until its deck is reused. The session thread never touches the render
+ * thread's deck table; it publishes load/unload/activate commands through an SPSC
+ * queue, and tracks the render thread drops are handed back through a second SPSC
+ * queue and deleted by reclaim() on the session thread.
+ *
+ * The render loop never allocates, locks or frees: it reads each deck's waveform
+ * in place through a WaveformView, which stays valid because the voice owns the
+ * track and nothing changes its samples once published, and all render-side state
+ * is fixed-size. Callback jitter (wake-up time minus scheduled tick) and deadline
+ * misses (block finished after the next tick) are recorded per callback.
+ */
+class RenderEngine {
+public:
+    static constexpr size_t BLOCK_SIZE = 64;
+    static constexpr double DEVICE_SAMPLE_RATE = AudioAnalyzer::ANALYSIS_SAMPLE_RATE;
+    static constexpr size_t MAX_DECKS = 8;
+
+    struct Stats {
+        uint64_t callbacks;
+        uint64_t deadline_misses;
+        uint64_t commands;          // deck commands applied by the render thread
+        size_t max_mixed_decks;     // most decks mixed into one block
+        double mean_jitter_us;
+        double max_jitter_us;
+        double max_render_us;       // longest time spent inside one callback
+        float peak;                 // loudest rendered sample
+    };
+
+    /**
+     * @brief Start the render thread
+     */
+    RenderEngine();
+
+    /**
+     * @brief Stop the render thread and delete every track it still owns
+     */
+    ~RenderEngine();
+
+    RenderEngine(const RenderEngine&) = delete;
+    RenderEngine& operator=(const RenderEngine&) = delete;
+
+    // ========== SESSION-THREAD SIDE ==========
+
+    /**
+     * @brief Publish a track on a deck; the engine takes ownership of it
+     * The previous track on that deck (if any) is retired and later reclaimed.
+     */
+    void load(size_t deck, AudioTrack* track);
+
+    /**
+     * @brief Retire the track on a deck
+     */
+    void unload(size_t deck);
+
+    /**
+     * @brief Fade a deck in and every other deck out
+     * @param fade_seconds Length of the gain ramps (0 = switch at the next block)
+     */
+    void set_active(size_t deck, double fade_seconds = 0.0);
+
+    /**
+     * @brief Delete tracks the render thread has retired (never called on the render thread)
+     */
+    void reclaim();
+
+    /**
+     * @brief Stop the render thread; afterwards get_stats() is final
+     */
+    void stop();
+
+    /**
+     * @brief Callback statistics; read after stop()
+     */
+    const Stats& get_stats() const { return stats; }
+
+private:
+    struct Voice {
+        AudioTrack* track;        // owned; deleted by reclaim()
+        WaveformView pcm;         // the track's samples, read in place
+        size_t position;          // render-thread playback cursor
+    };
+
+    struct Command {
+        enum Type { Load, Unload, Activate } type;
+        size_t deck;
+        Voice* voice;
+        size_t fade_blocks;       // Activate: blocks each gain ramp takes
+    };
+
+    // Each applied command retires at most one voice and send() reclaims before
+    // every push, so at most COMMAND_CAPACITY + 1 voices can await reclamation.
+    static constexpr size_t COMMAND_CAPACITY = 64;
+    SpscQueue<Command, COMMAND_CAPACITY> commands;
+    SpscQueue<Voice*, 2 * COMMAND_CAPACITY> retired;
+
+    // render-thread state
+    std::array<Voice*, MAX_DECKS> voices;
+    std::array<float, MAX_DECKS> gains;          // applied to the current block
+    std::array<float, MAX_DECKS> target_gains;   // 1 for the active deck, else 0
+    float gain_step;                             // per block, set by the last Activate
+    std::array<std::array<float, BLOCK_SIZE>, MAX_DECKS> deck_blocks;
+    std::array<float, BLOCK_SIZE> block;
+    Stats stats;
+
+    std::atomic<bool> stop_requested;
+    std::thread worker;
+
+    void send(const Command& command);
+    void run();
+    void apply(const Command& command);
+    void render_block();
+    static void read_block(Voice& voice, float* out);
+    static void destroy(Voice* voice);
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Storage format of a track's waveform samples
+ *
+ * Float32 is the working format: analysis, stretching, crossfades and rendering
+ * read it in place. Int16 is a cold-storage format for cached tracks: half the
+ * bytes of float32 (a quarter of the former double storage) and 96 dB of dynamic
+ * range, far beyond what key detection and energy profiles resolve. Tracks are
+ * converted back to float32 at the cache -> deck boundary.
+ */
+enum class SampleFormat {
+    Float32,
+    Int16
+};
+
+/**
+ * @brief Conversions between sample formats (stateless)
+ *
+ * The kernels are plain loops over restrict pointers, written so the compiler
+ * vectorizes them.
+ */
+class SampleConverter {
+public:
+    /**
+     * @brief Scale to 16-bit full scale (x 32767), rounding and clamping to [-32768, 32767]
+     * Inputs beyond +-65536 (far outside +-1.0 audio) are not supported.
+     */
+    static void to_int16(const float* in, int16_t* out, size_t count);
+
+    /**
+     * @brief Scale 16-bit samples back to +-1.0 full scale (/ 32767)
+     */
+    static void to_float(const int16_t* in, float* out, size_t count);
+
+    static size_t bytes_per_sample(SampleFormat format);
+    static const char* name(SampleFormat format);
+
+    /**
+     * @brief Parse "float32" or "int16"
+     * @return false (format unchanged) for any other text
+     */
+    static bool parse(const std::string& text, SampleFormat& format);
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Sorted map from stream sample positions to file byte offsets
+ *
+ * Built once while a track's file is scanned (one entry per MP3 frame, one per
+ * block of WAV frames) and then shared by every clone of the track, so later
+ * loads and seeks never walk the file again. Positions and offsets are kept in
+ * two parallel arrays: lookup() binary-searches the position array only, which
+ * stays dense in cache even for a track of tens of thousands of frames.
+ *
+ * Constant-rate streams (PCM) also record the bytes per sample, so a lookup
+ * between two entries resolves to the exact sample rather than the entry before it.
+ */
+class SeekIndex {
+public:
+    struct Entry {
+        uint64_t sample;  // first sample decoded from this point
+        uint64_t offset;  // byte offset in the file to resume reading from
+    };
+
+    SeekIndex();
+
+    /**
+     * @brief Drop all entries and start an index for a stream at sample_rate
+     * @param stride Bytes per sample for constant-rate streams, 0 for frame-based ones
+     */
+    void reset(int sample_rate, uint64_t stride = 0);
+
+    /**
+     * @brief Append an entry; samples must be strictly increasing
+     */
+    void add(uint64_t sample, uint64_t offset);
+
+    /**
+     * @brief Record the stream length once the last entry has been added
+     */
+    void finish(uint64_t total);
+
+    /**
+     * @brief Last entry at or before a sample position, in O(log n)
+     * With a stride the entry is advanced to the exact sample. Positions past the
+     * end clamp to the last entry; an empty index returns {0, 0}.
+     */
+    Entry lookup(uint64_t sample) const;
+
+    uint64_t to_samples(double seconds) const;
+    double to_seconds(uint64_t sample) const;
+
+    bool empty() const { return samples.empty(); }
+    size_t size() const { return samples.size(); }
+    int get_sample_rate() const { return sample_rate; }
+    uint64_t get_total_samples() const { return total_samples; }
+    size_t memory_bytes() const { return (samples.capacity() + offsets.capacity()) * sizeof(uint64_t); }
+
+private:
+    std::vector<uint64_t> samples;
+    std::vector<uint64_t> offsets;
+    int sample_rate;
+    uint64_t stride;
+    uint64_t total_samples;
+};
+
+/**
+ * @brief Per-track navigation state shared by a track and all of its clones
+ *
+ * The seek index and the cue points belong to the recording, not to one deck's
+ * copy of it: a hot cue set while the track plays on deck A is there the next
+ * time the track is loaded from the cache.
+ */
+struct TrackNavigation {
+    static constexpr size_t HOT_CUE_SLOTS = 8;
+    static constexpr uint64_t NO_CUE = UINT64_MAX;
+
+    SeekIndex index;
+    uint64_t cue;                                    // main cue point, in samples
+    std::array<uint64_t, HOT_CUE_SLOTS> hot_cues;    // NO_CUE = empty slot
+
+    TrackNavigation() : index(), cue(0), hot_cues() { hot_cues.fill(NO_CUE); }
+};
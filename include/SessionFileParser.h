@@ -4,6 +4,7 @@
 #include <vector>
 #include <map>
 #include <fstream>
+#include "SampleFormat.h"
 
 /**
  * @brief Configuration data parsed from DJ session config files
@@ -22,6 +23,7 @@ struct SessionConfig {
         int bpm;
         int extra_param1;        // bitrate for MP3, sample_rate for WAV
         int extra_param2;        // has_tags for MP3, bit_depth for WAV
+        std::string path;        // optional audio file, decoded on load (WAV, MPEG-1 Layer III)
         
         TrackInfo() 
             : type(""), 
@@ -30,18 +32,30 @@ struct SessionConfig {
               duration_seconds(0), 
               bpm(0), 
               extra_param1(0), 
-              extra_param2(0) {}
+              extra_param2(0), 
+              path("") {}
     };
     
     std::vector<TrackInfo> library_tracks;
     
     // Cache settings
     int controller_cache_size;
+    int adaptive_cache_max;            // upper bound of the adaptive cache size (0 = fixed size)
+    int cache_memory_budget_mb;        // cached waveform memory the adaptive mode may use
+    int cold_cache_size;               // evicted tracks kept compressed (0 = off)
+    std::string spill_path;            // segment file of the disk tier (empty = off)
+    bool cache_admission_tinylfu;      // cache_admission=tinylfu (default lru: always admit)
+    std::string access_log_path;       // requests persisted across sessions for warm-up (empty = off)
+    std::string metrics_path;          // Prometheus text file rewritten during the session (empty = off)
+    int metrics_interval_ms;           // time between two rewrites of metrics_path
+    SampleFormat cache_sample_format;  // storage format of cached waveforms
+    bool cache_sample_format_set;      // key present: the summary reports cached waveform bytes
     
     // Mixing settings
     int default_crossfade_time;
     int bpm_tolerance;
     bool auto_sync;
+    int deck_count;
     
     // Playlists - name mapped to list of track indices
     std::map<std::string, std::vector<int>> playlists;
@@ -50,9 +64,20 @@ struct SessionConfig {
           version(""), 
           library_tracks(), 
           controller_cache_size(8), 
+          adaptive_cache_max(0), 
+          cache_memory_budget_mb(256), 
+          cold_cache_size(0), 
+          spill_path(""), 
+          cache_admission_tinylfu(false), 
+          access_log_path(""), 
+          metrics_path(""), 
+          metrics_interval_ms(1000), 
+          cache_sample_format(SampleFormat::Int16), 
+          cache_sample_format_set(false), 
           default_crossfade_time(5), 
           bpm_tolerance(10), 
           auto_sync(true), 
+          deck_count(2), 
           playlists() {}
 };
 
@@ -81,8 +106,8 @@ struct PlaylistData {
  * 
  * This helper class handles parsing of the file formats.
  * Phase 4 note: Playlists are discovered under ./playlists (interactive selection).
- * The app uses bpm_tolerance and auto_sync settings; default_crossfade_time is ignored
- * for logging/behavior in the instant-transition model.
+ * The app uses bpm_tolerance, auto_sync and default_crossfade_time (seconds of
+ * beat-aligned crossfade rendered on each deck change; 0 = instant transition).
  */
 class SessionFileParser {
 public:
@@ -98,9 +123,21 @@ public:
      * version=2.0
      * library_track_1=MP3,title,{artist1;artist2;},duration,bpm,bitrate,has_tags
      * library_track_2=WAV,title,{artist1;artist2;},duration,bpm,sample_rate,bit_depth
+     * library_track_3=WAV,title,{artist1;},duration,bpm,sample_rate,bit_depth,path/to/file.wav
      * controller_cache_size=8
+     * adaptive_cache_max=0
+     * cache_memory_budget_mb=256
+     * cold_cache_size=0
+     * spill_path=/tmp/dj_spill.seg
+     * cache_admission=lru
+     * access_log_path=bin/access_log.txt
+     * metrics_path=/tmp/dj_metrics.prom
+     * metrics_interval_ms=1000
+     * cache_sample_format=int16
      * bpm_tolerance=10
      * auto_sync=true
+     * default_crossfade_time=5
+     * deck_count=2
      * playlistname=1,2,3
      */
     static bool parse_config_file(const std::string& config_path, SessionConfig& config);
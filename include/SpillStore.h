@@ -0,0 +1,118 @@
+#pragma once
+
+#include "AudioTrack.h"
+#include "MappedFile.h"
+#include "PointerWrapper.h"
+#include "SampleFormat.h"
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Third cache tier: tracks spilled to an append-only segment file on disk
+ *
+ * ColdTrackStore hands the entries it drops to put(), which appends one record per
+ * track to the segment: the compressed waveform exactly as the cold tier held it,
+ * plus the analysis and tempo that load() and analyze_beatgrid() produced. An
+ * in-memory index maps each track id to its record. take() reads the record
+ * through a read-only memory map of the segment and rebuilds the track from a
+ * clone of its library prototype, which already shares the seek index and cues;
+ * only the overview has to be rebuilt (ensure_analyzed() does that in one pass).
+ *
+ * Records are never rewritten in place. take() and a second put() of the same
+ * track leave dead records behind; once dead bytes outweigh live bytes (and pass
+ * COMPACT_MIN_BYTES) a background thread copies the live records into a fresh
+ * segment and swaps it in. The copy runs without the lock, which is only held to
+ * snapshot the index and to carry over records appended in the meantime.
+ *
+ * The segment is a scratch file: it is created empty by open() and removed by
+ * close(), and records are in host byte order.
+ */
+class SpillStore {
+public:
+    static constexpr size_t COMPACT_MIN_BYTES = 1 << 20;
+
+    SpillStore();
+    ~SpillStore();
+
+    SpillStore(const SpillStore&) = delete;
+    SpillStore& operator=(const SpillStore&) = delete;
+
+    /**
+     * @brief Create an empty segment file and start the compaction thread
+     * @return false (with get_error() set) if the file cannot be created
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Stop the compaction thread and delete the segment file
+     */
+    void close();
+
+    bool is_open() const { return !path.empty(); }
+
+    /**
+     * @brief Append a record for a track dropped by the cold tier
+     * @param track Track shell (metadata and analysis; its samples are not used)
+     * @param compressed Samples as produced by ColdTrackStore::compress()
+     */
+    bool put(const AudioTrack& track, SampleFormat format, size_t samples,
+             const std::vector<unsigned char>& compressed);
+
+    /**
+     * @brief Remove a track from the tier and rebuild it
+     * @param prototype Library track to clone the rebuilt track from
+     * @return The track (analysis restored, overview not yet built), or a null
+     *         wrapper if it is not held here
+     */
+    PointerWrapper<AudioTrack> take(TrackId track_id, const AudioTrack& prototype);
+
+    bool contains(TrackId track_id) const;
+    size_t size() const;
+
+    /**
+     * @brief Bytes of live records, and of the whole segment (live + dead)
+     */
+    size_t live_bytes() const;
+    size_t segment_bytes() const;
+    size_t compactions() const;
+
+    /**
+     * @brief Block until a pending compaction has finished
+     */
+    void flush();
+
+    const std::string& get_error() const { return error; }
+
+private:
+    struct Location {
+        uint64_t offset;
+        uint64_t length;
+    };
+
+    std::string path;  // set by open() and close() only
+    int fd;            // swapped by compaction
+    MappedFile map;  // read side of the segment; remapped when records lie past its end
+    std::unordered_map<TrackId, Location> index;
+    uint64_t file_bytes;
+    uint64_t live;
+    size_t compaction_count;
+    bool compaction_requested;
+    bool stop_requested;
+    std::string error;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;  // compaction requests and shutdown
+    std::condition_variable idle;  // compaction finished
+    std::thread compactor;
+
+    void retire(const Location& location);  // caller holds mutex
+    bool map_through(uint64_t end);          // caller holds mutex
+    void run();
+    void compact();
+};
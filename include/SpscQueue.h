@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief Bounded lock-free single-producer/single-consumer ring buffer
+ *
+ * Exactly one thread may push and exactly one (other) thread may pop. Storage is
+ * a fixed array, so neither side ever allocates or blocks; push() fails when the
+ * queue is full and pop() fails when it is empty. Head and tail live on separate
+ * cache lines so the two threads do not false-share.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() : slots(), head(0), tail(0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Producer side: append an item
+     * @return false if the queue is full
+     */
+    bool push(const T& item) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        slots[t & (Capacity - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Consumer side: take the oldest item
+     * @return false if the queue is empty
+     */
+    bool pop(T& item) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = slots[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, Capacity> slots;
+    alignas(64) std::atomic<size_t> head;  // next slot to pop (written by consumer)
+    alignas(64) std::atomic<size_t> tail;  // next slot to push (written by producer)
+};
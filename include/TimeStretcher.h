@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Tempo change without pitch change (WSOLA)
+ *
+ * Waveform Similarity Overlap-Add: the output is built from Hann-windowed frames
+ * placed every frame/2 samples, read from the input every frame/2 * tempo_ratio
+ * samples. Each frame's read position is nudged within
+ * +-tolerance samples to the spot whose waveform best matches the natural
+ * continuation of the previous frame, which avoids phase cancellation at the seams.
+ * The search runs coarse-to-fine: every SEARCH_STEP-th offset on a decimated
+ * correlation first, then full resolution around the winner.
+ *
+ * Frame copy, window multiply, overlap-add and the similarity search are plain
+ * loops over contiguous arrays, written so the compiler vectorizes them.
+ */
+class TimeStretcher {
+public:
+    static constexpr size_t DEFAULT_FRAME = 256;
+    static constexpr size_t SEARCH_STEP = 4;
+
+    /**
+     * @brief Stretch a signal to a new tempo
+     * @param input Source samples
+     * @param count Number of source samples
+     * @param tempo_ratio target_bpm / source_bpm (> 1 plays faster, output is shorter)
+     * @param output Receives about count / tempo_ratio samples
+     * @param frame Analysis frame length (clamped for short inputs)
+     */
+    static void stretch(const float* input, size_t count, double tempo_ratio,
+                        std::vector<float>& output, size_t frame = DEFAULT_FRAME);
+
+private:
+    /**
+     * @brief Offset in [-tolerance, tolerance] around nominal whose frame best matches target
+     */
+    static long best_offset(const float* input, size_t count, long nominal, long tolerance,
+                            const float* target, size_t length);
+};
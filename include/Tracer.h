@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstddef>
+
+/**
+ * @brief Process-wide span recorder that dumps Chrome trace JSON
+ *
+ * Spans are recorded by TraceSpan objects into a buffer owned by the recording
+ * thread (created on its first span and kept after the thread exits), so threads
+ * never contend with each other; dump() merges the buffers into one file that
+ * chrome://tracing, Perfetto or speedscope open directly.
+ *
+ * Until enable() is called a TraceSpan costs one relaxed atomic load and a
+ * branch: no clock read, no allocation.
+ */
+class Tracer {
+public:
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Start recording; timestamps in the dump are relative to this call
+     */
+    static void enable();
+    static bool enabled() { return active.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Name the calling thread in the trace viewer (default "thread N")
+     */
+    static void set_thread_name(const std::string& name);
+
+    /**
+     * @brief Write every span recorded so far as a Chrome trace JSON object
+     * @return false if the file cannot be written
+     * Spans still open (TraceSpan objects alive) are not included.
+     */
+    static bool dump(const std::string& path);
+
+    /**
+     * @brief Number of spans recorded so far, over all threads
+     */
+    static size_t span_count();
+
+    /**
+     * @brief Add a finished span to the calling thread's buffer (used by TraceSpan)
+     */
+    static void record(const char* name, const std::string& detail, clock::time_point start, clock::time_point end);
+
+private:
+    static std::atomic<bool> active;
+};
+
+/**
+ * @brief Scoped span: covers the lifetime of the object
+ *
+ * name should be a string literal (it is stored as a pointer); detail, e.g. the
+ * track title, is copied only while tracing is enabled and shown as the span's
+ * argument in the viewer. Spans on one thread nest by time.
+ */
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const std::string& detail = std::string())
+        : name(name), detail(), start() {
+        if (Tracer::enabled()) {
+            this->detail = detail;
+            start = Tracer::clock::now();
+        }
+    }
+
+    ~TraceSpan() {
+        if (start != Tracer::clock::time_point()) {
+            Tracer::record(name, detail, start, Tracer::clock::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name;
+    std::string detail;
+    Tracer::clock::time_point start;  // epoch = not recording
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "AudioTrack.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Columnar (structure-of-arrays) view of the track library
+ *
+ * DJLibraryService keeps the polymorphic AudioTrack objects for playback, and
+ * builds this catalog alongside them for scan-heavy queries. Each attribute lives
+ * in its own contiguous array, so filters touch only the columns they need and
+ * run as tight, branch-free loops the compiler can vectorize; no pointer chasing
+ * and no virtual calls.
+ *
+ * Row i describes the library track with TrackId i.
+ */
+class TrackCatalog {
+public:
+    enum class Format : uint8_t { MP3 = 0, WAV = 1 };
+
+    TrackCatalog();
+
+    /**
+     * @brief Reserve room for a number of rows in every column
+     */
+    void reserve(size_t rows);
+
+    /**
+     * @brief Append the row for the next track id
+     * @param bitrate MP3 bitrate in kbps (0 for WAV)
+     * @param sample_rate WAV sample rate in Hz (0 for MP3)
+     * @param bit_depth WAV bit depth (0 for MP3)
+     * @param quality Precomputed AudioTrack::get_quality_score()
+     * @return The TrackId the row was stored under
+     */
+    TrackId append(Format format, int bpm, int duration_seconds,
+                   int bitrate, int sample_rate, int bit_depth, double quality);
+
+    size_t size() const { return bpm.size(); }
+    bool empty() const { return bpm.empty(); }
+    void clear();
+
+    // ========== SCANS ==========
+
+    /**
+     * @brief All tracks whose BPM is within [center_bpm - tolerance, center_bpm + tolerance]
+     */
+    std::vector<TrackId> filterByBpm(int center_bpm, int tolerance) const;
+
+    /**
+     * @brief All tracks with quality score >= min_quality
+     */
+    std::vector<TrackId> filterByQuality(double min_quality) const;
+
+    /**
+     * @brief All tracks with duration in [min_seconds, max_seconds]
+     */
+    std::vector<TrackId> filterByDuration(int min_seconds, int max_seconds) const;
+
+    /**
+     * @brief All tracks of the given format
+     */
+    std::vector<TrackId> filterByFormat(Format wanted) const;
+
+    // ========== COLUMN ACCESS ==========
+    const std::vector<int32_t>& getBpms() const { return bpm; }
+    const std::vector<int32_t>& getDurations() const { return duration; }
+    const std::vector<uint8_t>& getFormats() const { return format; }
+    const std::vector<int32_t>& getBitrates() const { return bitrate; }
+    const std::vector<int32_t>& getSampleRates() const { return sample_rate; }
+    const std::vector<int32_t>& getBitDepths() const { return bit_depth; }
+    const std::vector<double>& getQualities() const { return quality; }
+
+private:
+    std::vector<int32_t> bpm;
+    std::vector<int32_t> duration;
+    std::vector<uint8_t> format;
+    std::vector<int32_t> bitrate;
+    std::vector<int32_t> sample_rate;
+    std::vector<int32_t> bit_depth;
+    std::vector<double> quality;
+
+    /**
+     * @brief Turn a 0/1 match mask into the list of matching ids
+     */
+    static std::vector<TrackId> collect(const std::vector<uint8_t>& mask);
+};
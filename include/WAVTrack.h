@@ -19,6 +19,20 @@ class WAVTrack : public AudioTrack {
 private:
     int sample_rate;    // Samples per second: 44100 (CD), 48000 (pro), 96000+ (hi-res)
     int bit_depth;      // Bits per sample: 16 (CD), 24 (pro), 32 (float)
+    std::string file_path;  // WAV file to decode on load (empty = metadata only)
+
+    /**
+     * Stream the file through WavReader, downmix to mono and decimate to the
+     * analysis rate, and install the result as waveform_data
+     * @return false if the file could not be read
+     */
+    bool decode_file();
+
+    /**
+     * Fill the shared seek index from the track metadata (canonical 44-byte header,
+     * stereo) when there is no file to scan
+     */
+    void build_estimated_index();
 
 public:
     /**
@@ -56,6 +70,8 @@ public:
     // Getters
     int get_sample_rate() const { return sample_rate; }
     int get_bit_depth() const { return bit_depth; }
+    const std::string& get_file_path() const { return file_path; }
+    void set_file_path(const std::string& path) { file_path = path; }
 };
 
 #endif // WAVTRACK_H
\ No newline at end of file
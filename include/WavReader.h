@@ -0,0 +1,79 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Streaming reader for RIFF/WAVE files backed by a read-only memory map
+ *
+ * open() maps the whole file (MappedFile) and walks its chunks to find "fmt " and
+ * "data"; no sample data is read until read() is called. read() converts the next
+ * frames straight from the mapping into a caller-supplied float buffer
+ * (interleaved, full scale = +-1.0), so a track is streamed block by block and
+ * never copied as a whole.
+ *
+ * Supported sample formats: 16/24/32-bit integer PCM and 32-bit IEEE float,
+ * including WAVE_FORMAT_EXTENSIBLE headers. Samples are little-endian, as the
+ * format requires; the conversion kernels assume a little-endian host.
+ */
+class WavReader {
+public:
+    WavReader();
+    ~WavReader();
+
+    WavReader(const WavReader&) = delete;
+    WavReader& operator=(const WavReader&) = delete;
+
+    /**
+     * @brief Map a file and parse its header
+     * @return false if the file cannot be mapped or is not a supported WAV; see get_error()
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Unmap the current file (also done by the destructor and by open())
+     */
+    void close();
+
+    /**
+     * @brief Convert up to max_frames frames from the cursor into out
+     * @param out Receives frames * channels interleaved floats
+     * @return Frames converted (0 at end of data)
+     */
+    size_t read(float* out, size_t max_frames);
+
+    void seek(size_t frame) { cursor = frame < frame_count ? frame : frame_count; }
+    size_t tell() const { return cursor; }
+
+    const std::string& get_error() const { return error; }
+    int get_channels() const { return channels; }
+    int get_sample_rate() const { return sample_rate; }
+    int get_bits_per_sample() const { return bits_per_sample; }
+    bool is_float_format() const { return float_format; }
+    size_t get_frame_count() const { return frame_count; }
+    size_t get_data_bytes() const { return frame_count * frame_bytes; }
+    size_t get_frame_bytes() const { return frame_bytes; }
+    size_t get_data_offset() const { return data != nullptr ? static_cast<size_t>(data - file.data()) : 0; }
+
+    /**
+     * @brief Convert raw little-endian samples to float
+     */
+    static void convert(const unsigned char* in, float* out, size_t samples, int bits, bool is_float);
+
+private:
+    MappedFile file;
+    const unsigned char* data;  // first byte of the data chunk
+    size_t frame_count;
+    size_t frame_bytes;
+    size_t cursor;
+    int channels;
+    int sample_rate;
+    int bits_per_sample;
+    bool float_format;
+    std::string error;
+
+    bool parse();
+    bool fail(const std::string& message);
+};
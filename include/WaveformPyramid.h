@@ -0,0 +1,87 @@
+#pragma once
+
+#include "WaveformView.h"
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Read-only view of a run of buckets in one pyramid level
+ *
+ * Points into the pyramid's own arrays; valid while the pyramid is alive and unchanged.
+ */
+struct WaveformLevelView {
+    const float* min;
+    const float* max;
+    const float* power;      // mean square of each bucket's samples (sqrt for RMS)
+    size_t size;             // buckets in the view
+    size_t bucket_samples;   // source samples summarised by each bucket
+    size_t first_sample;     // source sample the first bucket starts at
+};
+
+/**
+ * @brief Min/max/RMS overview of a waveform at power-of-two zoom levels
+ *
+ * Level 0 summarises BASE_BUCKET samples per bucket, level 1 twice as many, and so
+ * on until a level fits in a single bucket, which keeps the whole pyramid near a
+ * fifth of the size of the samples. Level 0 is reduced pairwise from the samples in
+ * cache-sized chunks and every further level pairwise from the one below it. Every
+ * level is three contiguous float arrays: min, max and mean square. Keeping mean
+ * squares rather than RMS leaves the pairwise loops free of sqrt (a libm call with
+ * an errno branch by default), so the compiler vectorizes them; render() takes
+ * the square root once per pixel.
+ *
+ * render() draws any sample range into any number of pixels from the coarsest level
+ * whose buckets are no wider than a pixel, so each pixel reads at most three
+ * buckets: O(pixels) however many samples the range spans. Closer than BASE_BUCKET
+ * samples per pixel, neighbouring pixels repeat the level-0 bucket they fall in.
+ */
+class WaveformPyramid {
+public:
+    static constexpr size_t BASE_BUCKET = 16;  // samples per bucket at level 0
+    static constexpr size_t BUILD_CHUNK = 4096; // samples reduced at a time into level 0
+
+    WaveformPyramid();
+
+    /**
+     * @brief Rebuild every level from a waveform
+     */
+    void build(WaveformView waveform);
+
+    size_t levels() const { return level_data.size(); }
+    size_t get_sample_count() const { return sample_count; }
+    size_t bucket_samples(size_t level) const { return BASE_BUCKET << level; }
+
+    /**
+     * @brief Whole level, without copying
+     */
+    WaveformLevelView level(size_t index) const;
+
+    /**
+     * @brief Buckets [first_bucket, first_bucket + count) of a level, clamped, without copying
+     */
+    WaveformLevelView range(size_t index, size_t first_bucket, size_t count) const;
+
+    /**
+     * @brief Coarsest level whose buckets span at most samples_per_pixel samples
+     */
+    size_t level_for(double samples_per_pixel) const;
+
+    /**
+     * @brief Draw samples [first_sample, first_sample + samples) into pixels columns
+     * Each output array receives `pixels` values.
+     */
+    void render(size_t first_sample, size_t samples, size_t pixels,
+                float* out_min, float* out_max, float* out_rms) const;
+
+    size_t memory_bytes() const;
+
+private:
+    struct Level {
+        std::vector<float> min;
+        std::vector<float> max;
+        std::vector<float> power;  // mean square
+    };
+
+    std::vector<Level> level_data;
+    size_t sample_count;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Read-only, non-owning view of a track's waveform samples
+ *
+ * Handed out by AudioTrack::get_waveform() in place of copying the samples into a
+ * caller buffer. A view is valid while the track is alive and until its samples are
+ * replaced (set_waveform(), time_stretch()); analysis, crossfades and the render
+ * thread read the samples through it where they lie.
+ */
+class WaveformView {
+public:
+    WaveformView() : samples(nullptr), count(0) {}
+    WaveformView(const float* data, size_t size) : samples(data), count(size) {}
+
+    const float* data() const { return samples; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const float* begin() const { return samples; }
+    const float* end() const { return samples + count; }
+    const float& operator[](size_t index) const { return samples[index]; }
+
+    /**
+     * @brief Samples [offset, offset + length), clamped to the view
+     */
+    WaveformView subview(size_t offset, size_t length) const {
+        offset = offset < count ? offset : count;
+        length = length < count - offset ? length : count - offset;
+        return WaveformView(samples + offset, length);
+    }
+
+private:
+    const float* samples;
+    size_t count;
+};
@@ -0,0 +1,74 @@
+#include "AccessLog.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+AccessLog::AccessLog() : scores(), session_counts() {}
+
+bool AccessLog::load(const std::string& path) {
+    scores.clear();
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return true;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            return false;
+        }
+        std::istringstream score_text(line.substr(0, tab));
+        double score = 0.0;
+        if (!(score_text >> score)) {
+            return false;
+        }
+        scores[line.substr(tab + 1)] = score;
+    }
+    return true;
+}
+
+bool AccessLog::save(const std::string& path) const {
+    std::unordered_map<std::string, double> merged;
+    for (const auto& entry : scores) {
+        merged[entry.first] = entry.second * DECAY;
+    }
+    for (const auto& entry : session_counts) {
+        merged[entry.first] += static_cast<double>(entry.second);
+    }
+
+    std::vector<std::pair<std::string, double>> sorted(merged.begin(), merged.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        return false;
+    }
+    out << "# DJ access log: score<TAB>title\n";
+    for (const auto& entry : sorted) {
+        if (entry.second >= MIN_SCORE) {
+            out << entry.second << '\t' << entry.first << '\n';
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+std::vector<std::string> AccessLog::ranked(size_t max_titles) const {
+    std::vector<std::pair<std::string, double>> sorted(scores.begin(), scores.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    std::vector<std::string> titles;
+    for (size_t i = 0; i < sorted.size() && i < max_titles; ++i) {
+        titles.push_back(sorted[i].first);
+    }
+    return titles;
+}
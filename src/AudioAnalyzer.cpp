@@ -0,0 +1,164 @@
+#include "AudioAnalyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Pitch classes are analyzed over three octaves (MIDI 48..83, C3..B5)
+constexpr int CHROMA_OCTAVES = 3;
+constexpr int CHROMA_FIRST_MIDI = 48;
+constexpr int CHROMA_BINS = 12 * CHROMA_OCTAVES;
+
+// Krumhansl-Schmuckler key profiles, index 0 = tonic
+const double MAJOR_PROFILE[12] = { 6.35, 2.23, 3.48, 2.33, 4.38, 4.09, 2.52, 5.19, 2.39, 3.66, 2.29, 2.88 };
+const double MINOR_PROFILE[12] = { 6.33, 2.68, 3.52, 5.38, 2.60, 3.53, 2.54, 4.75, 3.98, 2.69, 3.34, 3.17 };
+
+double correlate(const double chroma[12], const double profile[12], int root) {
+    double mean_c = 0.0, mean_p = 0.0;
+    for (int i = 0; i < 12; ++i) {
+        mean_c += chroma[i];
+        mean_p += profile[i];
+    }
+    mean_c /= 12.0;
+    mean_p /= 12.0;
+
+    double num = 0.0, den_c = 0.0, den_p = 0.0;
+    for (int i = 0; i < 12; ++i) {
+        double c = chroma[(root + i) % 12] - mean_c;
+        double p = profile[i] - mean_p;
+        num += c * p;
+        den_c += c * c;
+        den_p += p * p;
+    }
+    if (den_c <= 0.0 || den_p <= 0.0) {
+        return 0.0;
+    }
+    return num / std::sqrt(den_c * den_p);
+}
+
+} // namespace
+
+void AudioAnalyzer::analyze_beat_grid(TrackAnalysis& analysis, double bpm, int duration_seconds) {
+    analysis.first_beat_seconds = 0.0;
+    analysis.beat_period_seconds = bpm > 0 ? 60.0 / bpm : 0.0;
+    analysis.beat_count = static_cast<int>((duration_seconds / 60.0) * bpm);
+}
+
+void AudioAnalyzer::analyze_features(TrackAnalysis& analysis, WaveformView view) {
+    const float* samples = view.data();
+    const size_t count = view.size();
+
+    // ---- energy: per-block RMS and overall RMS ----
+    analysis.energy_profile.clear();
+    analysis.energy_profile.reserve((count + ENERGY_BLOCK - 1) / ENERGY_BLOCK);
+    double total = 0.0;
+    for (size_t start = 0; start < count; start += ENERGY_BLOCK) {
+        size_t len = std::min(ENERGY_BLOCK, count - start);
+        const float* block = samples + start;
+        double sum = 0.0;
+        for (size_t i = 0; i < len; ++i) {
+            sum += block[i] * block[i];
+        }
+        total += sum;
+        analysis.energy_profile.push_back(static_cast<float>(std::sqrt(sum / len)));
+    }
+    analysis.rms = count > 0 ? std::sqrt(total / count) : 0.0;
+
+    // ---- key: chroma correlated against 24 key profiles ----
+    double pcp[12];
+    chroma(samples, count, pcp);
+
+    double best = -2.0;
+    for (int root = 0; root < 12; ++root) {
+        double major = correlate(pcp, MAJOR_PROFILE, root);
+        double minor = correlate(pcp, MINOR_PROFILE, root);
+        if (major > best) {
+            best = major;
+            analysis.key_root = root;
+            analysis.key_minor = false;
+        }
+        if (minor > best) {
+            best = minor;
+            analysis.key_root = root;
+            analysis.key_minor = true;
+        }
+    }
+    analysis.key_confidence = best;
+    analysis.camelot_number = camelot_number(analysis.key_root, analysis.key_minor);
+    analysis.camelot_letter = analysis.key_minor ? 'A' : 'B';
+    analysis.analyzed = true;
+}
+
+void AudioAnalyzer::chroma(const float* samples, size_t count, double out[12]) {
+    // Goertzel filter bank: one resonator per (octave, pitch class). All bins are
+    // advanced together for each sample so the inner loop is a flat vector update.
+    double coeff[CHROMA_BINS];
+    double s1[CHROMA_BINS];
+    double s2[CHROMA_BINS];
+    for (int k = 0; k < CHROMA_BINS; ++k) {
+        double freq = 440.0 * std::pow(2.0, (CHROMA_FIRST_MIDI + k - 69) / 12.0);
+        coeff[k] = 2.0 * std::cos(2.0 * PI * freq / ANALYSIS_SAMPLE_RATE);
+        s1[k] = 0.0;
+        s2[k] = 0.0;
+    }
+
+    for (size_t n = 0; n < count; ++n) {
+        const double x = samples[n];
+        for (int k = 0; k < CHROMA_BINS; ++k) {
+            double s0 = x + coeff[k] * s1[k] - s2[k];
+            s2[k] = s1[k];
+            s1[k] = s0;
+        }
+    }
+
+    for (int pc = 0; pc < 12; ++pc) {
+        out[pc] = 0.0;
+    }
+    for (int k = 0; k < CHROMA_BINS; ++k) {
+        double power = s1[k] * s1[k] + s2[k] * s2[k] - coeff[k] * s1[k] * s2[k];
+        out[(CHROMA_FIRST_MIDI + k) % 12] += power;
+    }
+}
+
+int AudioAnalyzer::camelot_number(int key_root, bool minor) {
+    // Minor keys share the wheel number of their relative major (three semitones up).
+    // Moving a fifth up is one step clockwise; C major sits at 8B.
+    int major_root = minor ? (key_root + 3) % 12 : key_root % 12;
+    return ((major_root * 7) % 12 + 7) % 12 + 1;
+}
+
+bool AudioAnalyzer::camelot_compatible(const TrackAnalysis& a, const TrackAnalysis& b) {
+    if (!a.analyzed || !b.analyzed) {
+        return false;
+    }
+    int d = std::abs(a.camelot_number - b.camelot_number);
+    d = std::min(d, 12 - d);
+    if (d == 0) {
+        return true;  // same key, or relative major/minor
+    }
+    return d == 1 && a.camelot_letter == b.camelot_letter;
+}
+
+double AudioAnalyzer::harmonic_score(const TrackAnalysis& a, const TrackAnalysis& b) {
+    if (!a.analyzed || !b.analyzed) {
+        return 0.5;  // unknown key: neutral
+    }
+    int d = std::abs(a.camelot_number - b.camelot_number);
+    d = std::min(d, 12 - d);
+    double score = 1.0 - (d / 6.0) * 0.8;
+    if (a.camelot_letter != b.camelot_letter) {
+        score -= 0.1;
+    }
+    return std::max(0.0, score);
+}
+
+double AudioAnalyzer::energy_score(const TrackAnalysis& a, const TrackAnalysis& b) {
+    double hi = std::max(a.rms, b.rms);
+    if (hi <= 0.0) {
+        return 1.0;
+    }
+    return 1.0 - std::fabs(a.rms - b.rms) / hi;
+}
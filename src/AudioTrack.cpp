@@ -1,20 +1,26 @@
 #include "AudioTrack.h"
+#include "TimeStretcher.h"
 #include <iostream>
 #include <cstring>
 #include <random>
+#include <algorithm>
+#include <cmath>
 
 AudioTrack::AudioTrack(const std::string& title, const std::vector<std::string>& artists, 
                       int duration, int bpm, size_t waveform_samples)
-    : title(title), artists(artists), duration_seconds(duration), bpm(bpm), 
-      waveform_data(nullptr), waveform_size(waveform_samples) {
+    : title(title), artists(artists), duration_seconds(duration), bpm(bpm), exact_bpm(bpm),
+      waveform_data(nullptr), packed_waveform(nullptr), waveform_size(waveform_samples),
+      sample_format(SampleFormat::Float32), track_id(INVALID_TRACK_ID),
+      analysis(), navigation(std::make_shared<TrackNavigation>()), position(0), position_offset(0),
+      overview() {
 
     // Allocate memory for waveform analysis
-    waveform_data = new double[waveform_size];
+    waveform_data = new float[waveform_size];
 
     // Generate some dummy waveform data for testing
     std::random_device rd;
     std::mt19937 gen(rd());
-    std::uniform_real_distribution<double> dis(-1.0, 1.0);
+    std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
 
     for (size_t i = 0; i < waveform_size; ++i) {
         waveform_data[i] = dis(gen);
@@ -36,6 +42,7 @@ AudioTrack::~AudioTrack() {
     #endif
     // delete[] for arrays, not just delete
     delete[] waveform_data;
+    delete[] packed_waveform;
 }
 
 AudioTrack::AudioTrack(const AudioTrack& other)
@@ -43,16 +50,30 @@ AudioTrack::AudioTrack(const AudioTrack& other)
       artists(other.artists), 
       duration_seconds(other.duration_seconds),
       bpm(other.bpm), 
-      waveform_size(other.waveform_size)
+      exact_bpm(other.exact_bpm),
+      waveform_data(nullptr),
+      packed_waveform(nullptr),
+      waveform_size(other.waveform_size),
+      sample_format(other.sample_format),
+      track_id(other.track_id),
+      analysis(other.analysis),
+      navigation(other.navigation),
+      position(other.position),
+      position_offset(other.position_offset),
+      overview(other.overview)
 {
     #ifdef DEBUG
     std::cout << "AudioTrack copy constructor called for: " << other.title << std::endl;
     #endif
     
-    // deep copy - allocate new memory and copy all the data
-    waveform_data = new double[other.waveform_size];
-    for (size_t i = 0; i < waveform_size; i++) {
-        waveform_data[i] = other.waveform_data[i];
+    // deep copy - allocate new memory and copy all the data, in whichever format it is stored
+    if (other.waveform_data != nullptr) {
+        waveform_data = new float[waveform_size];
+        std::copy(other.waveform_data, other.waveform_data + waveform_size, waveform_data);
+    }
+    if (other.packed_waveform != nullptr) {
+        packed_waveform = new int16_t[waveform_size];
+        std::copy(other.packed_waveform, other.packed_waveform + waveform_size, packed_waveform);
     }
 }
 
@@ -68,17 +89,32 @@ AudioTrack& AudioTrack::operator=(const AudioTrack& other) {
     
     // clean up old memory before getting new data
     delete[] waveform_data;
+    delete[] packed_waveform;
+    waveform_data = nullptr;
+    packed_waveform = nullptr;
 
     title = other.title;
     artists = other.artists;
     duration_seconds = other.duration_seconds;
     bpm = other.bpm;
+    exact_bpm = other.exact_bpm;
     waveform_size = other.waveform_size;
+    sample_format = other.sample_format;
+    track_id = other.track_id;
+    analysis = other.analysis;
+    navigation = other.navigation;
+    position = other.position;
+    position_offset = other.position_offset;
+    overview = other.overview;
 
     // deep copy the array
-    waveform_data = new double[waveform_size];
-    for (size_t idx = 0; idx < waveform_size; ++idx) {
-        waveform_data[idx] = other.waveform_data[idx];
+    if (other.waveform_data != nullptr) {
+        waveform_data = new float[waveform_size];
+        std::copy(other.waveform_data, other.waveform_data + waveform_size, waveform_data);
+    }
+    if (other.packed_waveform != nullptr) {
+        packed_waveform = new int16_t[waveform_size];
+        std::copy(other.packed_waveform, other.packed_waveform + waveform_size, packed_waveform);
     }
 
     return *this;  // for chaining
@@ -89,15 +125,25 @@ AudioTrack::AudioTrack(AudioTrack&& other) noexcept
       artists(std::move(other.artists)),
       duration_seconds(other.duration_seconds),
       bpm(other.bpm),
+      exact_bpm(other.exact_bpm),
       waveform_data(other.waveform_data),
-      waveform_size(other.waveform_size)
+      packed_waveform(other.packed_waveform),
+      waveform_size(other.waveform_size),
+      sample_format(other.sample_format),
+      track_id(other.track_id),
+      analysis(std::move(other.analysis)),
+      navigation(other.navigation),  // copied, not moved: the source keeps a valid navigation
+      position(other.position),
+      position_offset(other.position_offset),
+      overview(std::move(other.overview))
 {
     #ifdef DEBUG
     std::cout << "AudioTrack move constructor called for: " << other.title << std::endl;
     #endif
     
-    // make source safe to delete by nulling its pointer
+    // make source safe to delete by nulling its pointers
     other.waveform_data = nullptr;
+    other.packed_waveform = nullptr;
     other.waveform_size = 0;
 }
 
@@ -112,18 +158,183 @@ AudioTrack& AudioTrack::operator=(AudioTrack&& other) noexcept {
     
     // clean up what we have
     delete[] waveform_data;
+    delete[] packed_waveform;
     
     // steal everything from other
     title = std::move(other.title);
     artists = std::move(other.artists);
     duration_seconds = other.duration_seconds;
     bpm = other.bpm;
+    exact_bpm = other.exact_bpm;
     waveform_data = other.waveform_data;
+    packed_waveform = other.packed_waveform;
     waveform_size = other.waveform_size;
+    sample_format = other.sample_format;
+    track_id = other.track_id;
+    analysis = std::move(other.analysis);
+    navigation = other.navigation;  // copied, not moved: the source keeps a valid navigation
+    position = other.position;
+    position_offset = other.position_offset;
+    overview = std::move(other.overview);
     
     // make other safe to delete
     other.waveform_data = nullptr;
+    other.packed_waveform = nullptr;
     other.waveform_size = 0;
     
     return *this;
 }
+
+void AudioTrack::set_waveform(const std::vector<float>& samples) {
+    delete[] waveform_data;
+    delete[] packed_waveform;
+    packed_waveform = nullptr;
+    sample_format = SampleFormat::Float32;
+    waveform_size = samples.size();
+    waveform_data = new float[waveform_size];
+    std::copy(samples.begin(), samples.end(), waveform_data);
+    analysis.analyzed = false;
+    overview.reset();
+}
+
+void AudioTrack::set_sample_format(SampleFormat format) {
+    if (format == sample_format) {
+        return;
+    }
+    if (format == SampleFormat::Int16) {
+        packed_waveform = new int16_t[waveform_size];
+        SampleConverter::to_int16(waveform_data, packed_waveform, waveform_size);
+        delete[] waveform_data;
+        waveform_data = nullptr;
+    } else {
+        waveform_data = new float[waveform_size];
+        SampleConverter::to_float(packed_waveform, waveform_data, waveform_size);
+        delete[] packed_waveform;
+        packed_waveform = nullptr;
+    }
+    sample_format = format;
+}
+
+const void* AudioTrack::get_sample_data() const {
+    return sample_format == SampleFormat::Float32 ? static_cast<const void*>(waveform_data)
+                                                  : static_cast<const void*>(packed_waveform);
+}
+
+void AudioTrack::release_waveform() {
+    delete[] waveform_data;
+    delete[] packed_waveform;
+    waveform_data = nullptr;
+    packed_waveform = nullptr;
+    waveform_size = 0;
+}
+
+void* AudioTrack::allocate_waveform(SampleFormat format, size_t samples) {
+    release_waveform();
+    sample_format = format;
+    waveform_size = samples;
+    if (format == SampleFormat::Float32) {
+        waveform_data = new float[samples];
+        return waveform_data;
+    }
+    packed_waveform = new int16_t[samples];
+    return packed_waveform;
+}
+
+void AudioTrack::restore_analysis(const TrackAnalysis& saved, int saved_bpm, double saved_exact_bpm,
+                                  int saved_duration) {
+    analysis = saved;
+    bpm = saved_bpm;
+    exact_bpm = saved_exact_bpm;
+    duration_seconds = saved_duration;
+    overview.reset();
+}
+
+WaveformView AudioTrack::get_waveform() const {
+    return sample_format == SampleFormat::Float32 ? WaveformView(waveform_data, waveform_size) : WaveformView();
+}
+
+void AudioTrack::build_overview() {
+    auto pyramid = std::make_shared<WaveformPyramid>();
+    pyramid->build(get_waveform());
+    overview = std::move(pyramid);
+}
+
+void AudioTrack::ensure_analyzed() {
+    // the beat grid follows the current BPM (sync_bpm may have changed it)
+    AudioAnalyzer::analyze_beat_grid(analysis, exact_bpm, duration_seconds);
+
+    set_sample_format(SampleFormat::Float32);
+    if (!analysis.analyzed) {
+        AudioAnalyzer::analyze_features(analysis, get_waveform());
+    }
+    if (!overview) {
+        build_overview();
+    }
+}
+
+void AudioTrack::time_stretch(double target_bpm) {
+    if (target_bpm <= 0.0 || exact_bpm <= 0.0) {
+        return;
+    }
+    const double ratio = target_bpm / exact_bpm;
+
+    set_sample_format(SampleFormat::Float32);
+    std::vector<float> stretched;
+    TimeStretcher::stretch(waveform_data, waveform_size, ratio, stretched);
+    delete[] waveform_data;
+    waveform_size = stretched.size();
+    waveform_data = new float[waveform_size];
+    std::copy(stretched.begin(), stretched.end(), waveform_data);
+    if (overview) {
+        build_overview();
+    }
+
+    // the same beats now play faster (or slower)
+    duration_seconds = static_cast<int>(std::lround(duration_seconds / ratio));
+    exact_bpm = target_bpm;
+    bpm = static_cast<int>(target_bpm);  // truncated as before; exact_bpm keeps the precise tempo
+    AudioAnalyzer::analyze_beat_grid(analysis, exact_bpm, duration_seconds);
+}
+
+bool AudioTrack::jump_to(uint64_t sample) {
+    if (!has_seek_index()) {
+        return false;
+    }
+    const SeekIndex& index = navigation->index;
+    if (index.get_total_samples() > 0) {
+        sample = std::min(sample, index.get_total_samples());
+    }
+    position = sample;
+    position_offset = index.lookup(sample).offset;
+    return true;
+}
+
+bool AudioTrack::seek(double seconds) {
+    return has_seek_index() && jump_to(navigation->index.to_samples(seconds));
+}
+
+double AudioTrack::get_position() const {
+    return navigation ? navigation->index.to_seconds(position) : 0.0;
+}
+
+bool AudioTrack::set_hot_cue(size_t slot) {
+    if (slot >= TrackNavigation::HOT_CUE_SLOTS) {
+        return false;
+    }
+    navigation->hot_cues[slot] = position;
+    return true;
+}
+
+bool AudioTrack::jump_to_hot_cue(size_t slot) {
+    return has_hot_cue(slot) && jump_to(navigation->hot_cues[slot]);
+}
+
+void AudioTrack::clear_hot_cue(size_t slot) {
+    if (slot < TrackNavigation::HOT_CUE_SLOTS) {
+        navigation->hot_cues[slot] = TrackNavigation::NO_CUE;
+    }
+}
+
+bool AudioTrack::has_hot_cue(size_t slot) const {
+    return slot < TrackNavigation::HOT_CUE_SLOTS && navigation->hot_cues[slot] != TrackNavigation::NO_CUE;
+}
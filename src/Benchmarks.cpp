@@ -0,0 +1,1959 @@
+#include "Benchmarks.h"
+#include "AudioTrack.h"
+#include "MP3Track.h"
+#include "WAVTrack.h"
+#include "DJControllerService.h"
+#include "LRUCache.h"
+#include "PointerWrapper.h"
+#include "TimeStretcher.h"
+#include "CrossfadeEngine.h"
+#include "DeckMixer.h"
+#include "WavReader.h"
+#include "Mp3Reader.h"
+#include "Mp3Decoder.h"
+#include "Mp3Tables.h"
+#include "WaveformPyramid.h"
+#include "BpmIndex.h"
+#include "PlaylistOptimizer.h"
+#include "ColdTrackStore.h"
+#include "Lz4Block.h"
+#include "SpillStore.h"
+#include "MetricsRegistry.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Silences std::cout (tracks and services log every step) until restore() or destruction
+class MutedOutput {
+public:
+    MutedOutput() : console(std::cout.rdbuf(nullptr)) {}
+    ~MutedOutput() { restore(); }
+
+    MutedOutput(const MutedOutput&) = delete;
+    MutedOutput& operator=(const MutedOutput&) = delete;
+
+    void restore() {
+        if (console != nullptr) {
+            std::cout.rdbuf(console);
+            std::cout.clear();
+            console = nullptr;
+        }
+    }
+
+private:
+    std::streambuf* console;
+};
+
+// count metadata-only WAV tracks "T<i>" with ids 0..count-1: no file behind them,
+// so a cache miss costs clone + placeholder load + analysis
+std::vector<PointerWrapper<AudioTrack>> make_metadata_library(size_t count) {
+    std::vector<PointerWrapper<AudioTrack>> library;
+    library.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        library.emplace_back(new WAVTrack("T" + std::to_string(i), {"Bench"}, 200, 128, 44100, 16));
+        library.back()->set_id(static_cast<TrackId>(i));
+    }
+    return library;
+}
+
+// Draws ids 0..n-1 with probability proportional to 1 / (id + 1)^skew
+class ZipfSampler {
+public:
+    ZipfSampler(size_t n, double skew) : cdf(n) {
+        double total = 0.0;
+        for (size_t k = 0; k < n; ++k) {
+            total += 1.0 / std::pow(static_cast<double>(k + 1), skew);
+            cdf[k] = total;
+        }
+    }
+
+    TrackId operator()(std::mt19937& rng) const {
+        std::uniform_real_distribution<double> uniform(0.0, cdf.back());
+        size_t rank = static_cast<size_t>(std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin());
+        return static_cast<TrackId>(std::min(rank, cdf.size() - 1));
+    }
+
+private:
+    std::vector<double> cdf;
+};
+
+void benchmark_time_stretch() {
+    std::cout << "\n======== TIME STRETCH BENCHMARK ========" << std::endl;
+
+    // one minute of a two-tone mono signal at CD rate, stretched on a single thread
+    const double sample_rate = 44100.0;
+    const size_t count = static_cast<size_t>(60 * sample_rate);
+    std::vector<float> input(count);
+    for (size_t i = 0; i < count; ++i) {
+        double t = i / sample_rate;
+        input[i] = static_cast<float>(0.5 * std::sin(2.0 * M_PI * 220.0 * t) + 0.25 * std::sin(2.0 * M_PI * 331.0 * t));
+    }
+
+    std::vector<float> output;
+    const double ratios[] = { 0.90, 0.97, 1.03, 1.10 };
+    for (double ratio : ratios) {
+        auto started = std::chrono::steady_clock::now();
+        TimeStretcher::stretch(input.data(), count, ratio, output, 1024);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        double audio_seconds = output.size() / sample_rate;
+        std::cout << "ratio " << ratio << ": " << audio_seconds << "s of audio in "
+                  << seconds * 1000.0 << " ms, real-time factor " << audio_seconds / seconds
+                  << "x per core" << std::endl;
+    }
+}
+
+void benchmark_crossfade() {
+    std::cout << "\n======== CROSSFADE BENCHMARK ========" << std::endl;
+
+    // two analyzed decks at slightly different tempos, 30s fades rendered back to back
+    MP3Track outgoing("Outgoing", {"Bench"}, 360, 126, 320);
+    WAVTrack incoming("Incoming", {"Bench"}, 360, 128, 44100, 16);
+    outgoing.ensure_analyzed();
+    incoming.ensure_analyzed();
+
+    CrossfadeEngine engine;
+    engine.set_crossfade_time(30);
+    const int rounds = 20;
+    auto started = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        engine.render(outgoing, incoming);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cout << engine.get_mixed_samples() << " samples mixed in " << seconds * 1000.0
+              << " ms, " << engine.get_mixed_samples() / seconds / 1e6
+              << "M samples/sec (block size " << CrossfadeEngine::BLOCK_SIZE << ")" << std::endl;
+}
+
+void benchmark_deck_mixer() {
+    std::cout << "\n======== DECK MIXER BENCHMARK ========" << std::endl;
+
+    // ten seconds of 44.1 kHz audio per deck, summed with one thread and with all of them, in one
+    // call and in 16384-sample blocks (the smallest mix that is split), through mixers built once
+    const size_t count = 441000;
+    const size_t max_decks = 8;
+    std::vector<std::vector<float>> audio(max_decks, std::vector<float>(count));
+    std::vector<const float*> decks(max_decks);
+    for (size_t d = 0; d < max_decks; ++d) {
+        for (size_t i = 0; i < count; ++i) {
+            audio[d][i] = static_cast<float>(std::sin(0.01 * (d + 1) * i));
+        }
+        decks[d] = audio[d].data();
+    }
+    std::vector<float> gains(max_decks, 1.0f / max_decks);
+    std::vector<float> out(count);
+
+    DeckMixer single(1);
+    DeckMixer pooled(0);
+    pooled.mix(decks.data(), gains.data(), max_decks, out.data(), count);  // untimed: fault the buffers in
+    std::cout << "pool: " << pooled.get_threads() << " thread(s), caller included (hardware concurrency "
+              << std::thread::hardware_concurrency() << ")" << std::endl;
+    const size_t deck_counts[] = { 2, 4, 8 };
+    const size_t block_sizes[] = { count, DeckMixer::PARALLEL_MIN_SAMPLES };
+    for (size_t deck_count : deck_counts) {
+        for (size_t block : block_sizes) {
+            double rate[2];
+            for (int p = 0; p < 2; ++p) {
+                DeckMixer& mixer = p == 0 ? single : pooled;
+                std::vector<const float*> offset(deck_count);
+                const int rounds = 10;
+                auto started = std::chrono::steady_clock::now();
+                for (int r = 0; r < rounds; ++r) {
+                    for (size_t begin = 0; begin < count; begin += block) {
+                        for (size_t d = 0; d < deck_count; ++d) {
+                            offset[d] = decks[d] + begin;
+                        }
+                        mixer.mix(offset.data(), gains.data(), deck_count, out.data() + begin,
+                                  std::min(block, count - begin));
+                    }
+                }
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+                rate[p] = rounds * count * deck_count / seconds / 1e6;
+            }
+            std::cout << deck_count << " decks, " << (block == count ? "one call" : std::to_string(block) + "-sample blocks")
+                      << ": 1 thread " << rate[0] << "M, pool " << rate[1] << "M deck samples/sec ("
+                      << rate[1] / rate[0] << "x)" << std::endl;
+        }
+    }
+}
+
+// Write a stereo 44.1 kHz test tone as a canonical 44-byte-header WAV file
+void write_wav_fixture(const std::string& path, int bits, bool is_float, size_t frames) {
+    const uint16_t channels = 2;
+    const uint32_t rate = 44100;
+    const uint16_t bytes = static_cast<uint16_t>(bits / 8);
+    const uint32_t data_size = static_cast<uint32_t>(frames * channels * bytes);
+    auto u16 = [](std::ofstream& out, uint16_t v) { out.put(static_cast<char>(v & 0xFF)).put(static_cast<char>(v >> 8)); };
+    auto u32 = [&u16](std::ofstream& out, uint32_t v) { u16(out, v & 0xFFFF); u16(out, static_cast<uint16_t>(v >> 16)); };
+
+    std::ofstream out(path, std::ios::binary);
+    out.write("RIFF", 4); u32(out, 36 + data_size); out.write("WAVE", 4);
+    out.write("fmt ", 4); u32(out, 16); u16(out, is_float ? 3 : 1); u16(out, channels);
+    u32(out, rate); u32(out, rate * channels * bytes); u16(out, channels * bytes); u16(out, static_cast<uint16_t>(bits));
+    out.write("data", 4); u32(out, data_size);
+
+    std::vector<char> sample(bytes);
+    for (size_t i = 0; i < frames * channels; ++i) {
+        double v = 0.5 * std::sin(2.0 * M_PI * 440.0 * (i / channels) / rate);
+        if (is_float) {
+            float f = static_cast<float>(v);
+            std::memcpy(sample.data(), &f, 4);
+        } else {
+            int64_t q = static_cast<int64_t>(v * ((int64_t(1) << (bits - 1)) - 1));
+            for (int b = 0; b < bytes; ++b) {
+                sample[b] = static_cast<char>((q >> (8 * b)) & 0xFF);
+            }
+        }
+        out.write(sample.data(), bytes);
+    }
+}
+
+void benchmark_wav_reader() {
+    std::cout << "\n======== WAV READER BENCHMARK ========" << std::endl;
+
+    // 30s stereo fixtures per sample format, decoded to float in 4096-frame blocks
+    // through the mmap reader and through plain ifstream block reads
+    const size_t frames = 30 * 44100;
+    const size_t block_frames = 4096;
+    struct Fixture { int bits; bool is_float; const char* name; };
+    const Fixture fixtures[] = { {16, false, "pcm16"}, {24, false, "pcm24"}, {32, false, "pcm32"}, {32, true, "float32"} };
+    std::vector<float> block(block_frames * 2);
+    std::vector<char> raw(block_frames * 2 * 4);
+
+    for (const Fixture& fixture : fixtures) {
+        std::string path = (std::filesystem::temp_directory_path() / ("dj_bench_" + std::string(fixture.name) + ".wav")).string();
+        write_wav_fixture(path, fixture.bits, fixture.is_float, frames);
+        double mb = frames * 2.0 * (fixture.bits / 8) / 1e6;
+
+        double mmap_best = 1e9, stream_best = 1e9;
+        for (int run = 0; run < 3; ++run) {
+            auto started = std::chrono::steady_clock::now();
+            WavReader reader;
+            if (!reader.open(path)) {
+                std::cout << fixture.name << ": " << reader.get_error() << std::endl;
+                break;
+            }
+            while (reader.read(block.data(), block_frames) > 0) {
+            }
+            mmap_best = std::min(mmap_best, std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+
+            started = std::chrono::steady_clock::now();
+            std::ifstream in(path, std::ios::binary);
+            in.seekg(44);
+            const size_t frame_bytes = 2 * (fixture.bits / 8);
+            for (size_t f = 0; f < frames; f += block_frames) {
+                size_t n = std::min(block_frames, frames - f);
+                in.read(raw.data(), static_cast<std::streamsize>(n * frame_bytes));
+                WavReader::convert(reinterpret_cast<const unsigned char*>(raw.data()), block.data(),
+                                   n * 2, fixture.bits, fixture.is_float);
+            }
+            stream_best = std::min(stream_best, std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+        }
+        std::cout << fixture.name << ": mmap " << mb / mmap_best << " MB/s, ifstream "
+                  << mb / stream_best << " MB/s" << std::endl;
+        std::remove(path.c_str());
+    }
+}
+
+// Write an MPEG-1 Layer III stream: ID3v2.3 tag, Xing header with seek table, then
+// VBR frames (128..320 kbps) with filler payload. Frames are well-formed but silent noise.
+void write_mp3_fixture(const std::string& path, size_t frames) {
+    const int kbps_cycle[] = { 128, 192, 256, 320 };
+    const int bitrate_index[] = { 9, 11, 12, 14 };
+    auto frame_bytes = [](int kbps) { return static_cast<size_t>(144000 * kbps / 44100); };
+    auto be32 = [](std::string& out, uint32_t v) {
+        for (int s = 24; s >= 0; s -= 8) out.push_back(static_cast<char>((v >> s) & 0xFF));
+    };
+
+    std::string tag_body;
+    auto text_frame = [&](const char* id, const std::string& text) {
+        tag_body.append(id, 4);
+        be32(tag_body, static_cast<uint32_t>(text.size() + 1));
+        tag_body.append(2, '\0');
+        tag_body.push_back('\0');  // ISO-8859-1
+        tag_body += text;
+    };
+    text_frame("TIT2", "Benchmark Tone");
+    text_frame("TPE1", "DJ Bench");
+    text_frame("TBPM", "128");
+    std::string out = "ID3";
+    out.push_back(3); out.push_back(0); out.push_back(0);
+    for (int s = 21; s >= 0; s -= 7) out.push_back(static_cast<char>((tag_body.size() >> s) & 0x7F));
+    out += tag_body;
+
+    // Xing frame at 128 kbps: header, 32 bytes of side info, then the Xing block
+    std::vector<size_t> sizes(frames);
+    size_t audio_bytes = frame_bytes(128);
+    for (size_t f = 0; f < frames; ++f) {
+        sizes[f] = frame_bytes(kbps_cycle[f % 4]);
+        audio_bytes += sizes[f];
+    }
+    std::string xing(frame_bytes(128), '\0');
+    xing[0] = static_cast<char>(0xFF); xing[1] = static_cast<char>(0xFB); xing[2] = static_cast<char>(9 << 4);
+    std::string block = "Xing";
+    be32(block, 0x7);
+    be32(block, static_cast<uint32_t>(frames));
+    be32(block, static_cast<uint32_t>(audio_bytes));
+    size_t offset = frame_bytes(128), f = 0;
+    for (int percent = 0; percent < 100; ++percent) {
+        for (; f < frames * percent / 100; ++f) offset += sizes[f];
+        block.push_back(static_cast<char>(offset * 256 / audio_bytes));
+    }
+    xing.replace(36, block.size(), block);
+    out += xing;
+
+    for (size_t i = 0; i < frames; ++i) {
+        std::string frame(sizes[i], static_cast<char>(0x55 + i % 7));
+        frame[0] = static_cast<char>(0xFF); frame[1] = static_cast<char>(0xFB);
+        frame[2] = static_cast<char>(bitrate_index[i % 4] << 4); frame[3] = 0;
+        out += frame;
+    }
+    std::ofstream(path, std::ios::binary).write(out.data(), static_cast<std::streamsize>(out.size()));
+}
+
+void benchmark_mp3_scanner() {
+    std::cout << "\n======== MP3 SCANNER BENCHMARK ========" << std::endl;
+
+    // ten minutes of VBR frames, scanned header by header on a single thread
+    const size_t frames = 600 * 44100 / 1152;
+    std::string path = (std::filesystem::temp_directory_path() / "dj_bench.mp3").string();
+    write_mp3_fixture(path, frames);
+
+    double best = 1e9;
+    size_t scanned = 0;
+    Mp3Reader reader;
+    for (int run = 0; run < 3; ++run) {
+        auto started = std::chrono::steady_clock::now();
+        if (!reader.open(path)) {
+            std::cout << reader.get_error() << std::endl;
+            std::remove(path.c_str());
+            return;
+        }
+        Mp3Frame frame;
+        scanned = 0;
+        while (reader.next_frame(frame)) {
+            ++scanned;
+        }
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+    }
+    const Id3Tag& tag = reader.get_tag();
+    std::cout << "ID3v2." << tag.version << " \"" << tag.title << "\" by " << tag.artist << ", "
+              << scanned << " frames, " << reader.get_duration_seconds() << "s"
+              << (reader.has_seek_table() ? ", Xing seek table" : "") << std::endl;
+    std::cout << "scan: " << scanned / best / 1e6 << "M frames/sec, " << reader.get_audio_bytes() / best / 1e6
+              << " MB/s, " << reader.get_duration_seconds() / best << "x real time per core" << std::endl;
+
+    Mp3Frame frame;
+    reader.seek(300.0);
+    reader.next_frame(frame);
+    std::cout << "seek to 300s lands on sample " << frame.first_sample << " (" << frame.first_sample / 44100.0
+              << "s)" << std::endl;
+    reader.close();
+    std::remove(path.c_str());
+}
+
+// MSB-first bit packer for the Layer III fixture encoder
+struct BitWriter {
+    std::vector<unsigned char> bytes = {};
+    size_t bits = 0;
+
+    void put(uint32_t value, int count) {
+        for (int b = count - 1; b >= 0; --b) {
+            if (bits % 8 == 0) {
+                bytes.push_back(0);
+            }
+            bytes.back() = static_cast<unsigned char>(bytes.back() | (((value >> b) & 1) << (7 - bits % 8)));
+            ++bits;
+        }
+    }
+};
+
+// One granule of one channel as the fixture encoder codes it; the fields follow the side info
+struct FixtureGranule {
+    int lines[576] = {};  // quantized spectrum in bitstream order
+    int part2_3_length = 0;
+    int big_values = 0;
+    int count1_end = 0;
+    int global_gain = 0;
+    int scalefac_compress = 0;
+    int block_type = 0;
+    int table_select[3] = {};
+    int subblock_gain[3] = {};
+    int region0_count = 0;
+    int region1_count = 0;
+    bool preflag = false;
+    bool scalefac_scale = false;
+    int count1_table = 0;
+    int scalefac_long[22] = {};
+    int scalefac_short[13][3] = {};
+
+    bool window_switching() const { return block_type != 0; }
+};
+
+// Bits to code lines [from, to) as pairs with a big-value table, or -1 if a value does not fit
+int fixture_pair_bits(const int* lines, int from, int to, int table_index) {
+    const Mp3Tables::HuffmanTable& table = Mp3Tables::big_values(table_index);
+    const int limit = table.size - 1 + (table.linbits > 0 ? (1 << table.linbits) - 1 : 0);
+    int bits = 0;
+    for (int i = from; i < to; ++i) {
+        if (std::abs(lines[i]) > limit) {
+            return -1;
+        }
+    }
+    for (int i = from; i < to; i += 2) {
+        const int x = std::abs(lines[i]), y = std::abs(lines[i + 1]);
+        bits += table.lengths[std::min(x, 15) * table.size + std::min(y, 15)];
+        bits += (x >= 15 ? table.linbits : 0) + (y >= 15 ? table.linbits : 0) + (x != 0) + (y != 0);
+    }
+    return bits;
+}
+
+// Cheapest table for a region (0 when it is all zero)
+int fixture_select_table(const int* lines, int from, int to, int& bits) {
+    bits = 0;
+    int best = 0;
+    if (std::all_of(lines + from, lines + to, [](int v) { return v == 0; })) {
+        return best;
+    }
+    bits = -1;
+    for (int t = 1; t < 32; ++t) {
+        if (Mp3Tables::big_values(t).size == 0) {
+            continue;
+        }
+        const int cost = fixture_pair_bits(lines, from, to, t);
+        if (cost >= 0 && (bits < 0 || cost < bits)) {
+            bits = cost;
+            best = t;
+        }
+    }
+    return best;
+}
+
+int fixture_quad_index(const int* lines) {
+    return 8 * std::abs(lines[0]) + 4 * std::abs(lines[1]) + 2 * std::abs(lines[2]) + std::abs(lines[3]);
+}
+
+// Scalefactor bits of a granule; reused (scfsi) groups cost nothing
+int fixture_part2_bits(const FixtureGranule& granule, const bool* reused) {
+    const int slen1 = Mp3Tables::SLEN[0][granule.scalefac_compress];
+    const int slen2 = Mp3Tables::SLEN[1][granule.scalefac_compress];
+    if (granule.block_type == 2) {
+        return 18 * slen1 + 18 * slen2;
+    }
+    const int sizes[4] = { 6, 5, 5, 5 };
+    int bits = 0;
+    for (int group = 0; group < 4; ++group) {
+        bits += reused[group] ? 0 : sizes[group] * (group < 2 ? slen1 : slen2);
+    }
+    return bits;
+}
+
+// Quantize xr (bitstream order) at the granule's gains and split it into regions;
+// returns part2_3_length, or -1 if a line overflows the largest linbits table
+int fixture_quantize(const double* xr, FixtureGranule& granule, const bool* reused, int sample_rate) {
+    const int shift = granule.scalefac_scale ? 4 : 2;
+    const int* long_bands = Mp3Tables::long_bands(sample_rate);
+    const int* short_bands = Mp3Tables::short_bands(sample_rate);
+    auto quantize = [&](int from, int to, int exponent) {
+        const double inverse_step = std::exp2(-exponent / 4.0);
+        for (int i = from; i < to; ++i) {
+            const double q = std::pow(std::fabs(xr[i]) * inverse_step, 0.75);
+            const int magnitude = q > 9000.0 ? 9000 : static_cast<int>(q + 0.5);
+            granule.lines[i] = xr[i] < 0 ? -magnitude : magnitude;
+        }
+    };
+    if (granule.block_type == 2) {
+        for (int band = 0; band < 13; ++band) {
+            const int width = short_bands[band + 1] - short_bands[band];
+            for (int w = 0; w < 3; ++w) {
+                const int from = 3 * short_bands[band] + w * width;
+                quantize(from, from + width, granule.global_gain - 210 - 8 * granule.subblock_gain[w]
+                                             - shift * granule.scalefac_short[band][w]);
+            }
+        }
+    } else {
+        for (int band = 0; band < 22; ++band) {
+            const int boost = granule.preflag ? Mp3Tables::PRETAB[band] : 0;
+            quantize(long_bands[band], long_bands[band + 1],
+                     granule.global_gain - 210 - shift * (granule.scalefac_long[band] + boost));
+        }
+    }
+    if (std::any_of(granule.lines, granule.lines + 576, [](int v) { return std::abs(v) > 15 + 8191; })) {
+        return -1;
+    }
+
+    // zeros at the top, then quadruples of -1/0/1, then pairs
+    int end = 576;
+    while (end > 0 && granule.lines[end - 1] == 0) {
+        --end;
+    }
+    end += end % 2;
+    int start = end;
+    while (start >= 4 && std::all_of(granule.lines + start - 4, granule.lines + start, [](int v) { return std::abs(v) <= 1; })) {
+        start -= 4;
+    }
+    granule.big_values = start / 2;
+    granule.count1_end = end;
+
+    int region1 = 36, region2 = 576;
+    if (!granule.window_switching()) {
+        region1 = long_bands[std::min(granule.region0_count + 1, 22)];
+        region2 = long_bands[std::min(granule.region0_count + granule.region1_count + 2, 22)];
+    }
+    const int bounds[4] = { 0, std::min(region1, start), std::min(region2, start), start };
+    int bits = fixture_part2_bits(granule, reused);
+    for (int r = 0; r < 3; ++r) {
+        int region_bits = 0;
+        granule.table_select[r] = fixture_select_table(granule.lines, bounds[r], bounds[r + 1], region_bits);
+        bits += region_bits;
+    }
+    for (int i = start; i < end; i += 4) {
+        bits += Mp3Tables::count1(granule.count1_table).lengths[fixture_quad_index(granule.lines + i)];
+        bits += static_cast<int>(std::count_if(granule.lines + i, granule.lines + i + 4, [](int v) { return v != 0; }));
+    }
+    granule.part2_3_length = bits;
+    return bits;
+}
+
+void fixture_write_main_data(BitWriter& out, const FixtureGranule& granule, const bool* reused, int sample_rate) {
+    const int slen1 = Mp3Tables::SLEN[0][granule.scalefac_compress];
+    const int slen2 = Mp3Tables::SLEN[1][granule.scalefac_compress];
+    if (granule.block_type == 2) {
+        for (int band = 0; band < 12; ++band) {
+            for (int w = 0; w < 3; ++w) {
+                out.put(static_cast<uint32_t>(granule.scalefac_short[band][w]), band < 6 ? slen1 : slen2);
+            }
+        }
+    } else {
+        const int groups[5] = { 0, 6, 11, 16, 21 };
+        for (int group = 0; group < 4; ++group) {
+            for (int band = groups[group]; !reused[group] && band < groups[group + 1]; ++band) {
+                out.put(static_cast<uint32_t>(granule.scalefac_long[band]), band < 11 ? slen1 : slen2);
+            }
+        }
+    }
+
+    int region1 = 36, region2 = 576;
+    if (!granule.window_switching()) {
+        const int* long_bands = Mp3Tables::long_bands(sample_rate);
+        region1 = long_bands[std::min(granule.region0_count + 1, 22)];
+        region2 = long_bands[std::min(granule.region0_count + granule.region1_count + 2, 22)];
+    }
+    for (int i = 0; i < granule.big_values * 2; i += 2) {
+        const int select = granule.table_select[i < region1 ? 0 : i < region2 ? 1 : 2];
+        const Mp3Tables::HuffmanTable& table = Mp3Tables::big_values(select);
+        if (table.size == 0) {
+            continue;
+        }
+        const int x = std::abs(granule.lines[i]), y = std::abs(granule.lines[i + 1]);
+        const int entry = std::min(x, 15) * table.size + std::min(y, 15);
+        out.put(table.codes[entry], table.lengths[entry]);
+        if (x >= 15 && table.linbits > 0) {
+            out.put(static_cast<uint32_t>(x - 15), table.linbits);
+        }
+        if (x != 0) {
+            out.put(granule.lines[i] < 0, 1);
+        }
+        if (y >= 15 && table.linbits > 0) {
+            out.put(static_cast<uint32_t>(y - 15), table.linbits);
+        }
+        if (y != 0) {
+            out.put(granule.lines[i + 1] < 0, 1);
+        }
+    }
+    const Mp3Tables::HuffmanTable& quads = Mp3Tables::count1(granule.count1_table);
+    for (int i = granule.big_values * 2; i < granule.count1_end; i += 4) {
+        const int quad = fixture_quad_index(granule.lines + i);
+        out.put(quads.codes[quad], quads.lengths[quad]);
+        for (int q = 0; q < 4; ++q) {
+            if (granule.lines[i + q] != 0) {
+                out.put(granule.lines[i + q] < 0, 1);
+            }
+        }
+    }
+}
+
+void fixture_write_side_info(BitWriter& out, const FixtureGranule granules[2][2], const bool scfsi[2][4], int main_data_begin) {
+    out.put(static_cast<uint32_t>(main_data_begin), 9);
+    out.put(0, 3);  // private bits
+    for (int ch = 0; ch < 2; ++ch) {
+        for (int group = 0; group < 4; ++group) {
+            out.put(scfsi[ch][group], 1);
+        }
+    }
+    for (int gr = 0; gr < 2; ++gr) {
+        for (int ch = 0; ch < 2; ++ch) {
+            const FixtureGranule& granule = granules[gr][ch];
+            out.put(static_cast<uint32_t>(granule.part2_3_length), 12);
+            out.put(static_cast<uint32_t>(granule.big_values), 9);
+            out.put(static_cast<uint32_t>(granule.global_gain), 8);
+            out.put(static_cast<uint32_t>(granule.scalefac_compress), 4);
+            out.put(granule.window_switching(), 1);
+            if (granule.window_switching()) {
+                out.put(static_cast<uint32_t>(granule.block_type), 2);
+                out.put(0, 1);  // mixed_block_flag
+                for (int r = 0; r < 2; ++r) {
+                    out.put(static_cast<uint32_t>(granule.table_select[r]), 5);
+                }
+                for (int w = 0; w < 3; ++w) {
+                    out.put(static_cast<uint32_t>(granule.subblock_gain[w]), 3);
+                }
+            } else {
+                for (int r = 0; r < 3; ++r) {
+                    out.put(static_cast<uint32_t>(granule.table_select[r]), 5);
+                }
+                out.put(static_cast<uint32_t>(granule.region0_count), 4);
+                out.put(static_cast<uint32_t>(granule.region1_count), 3);
+            }
+            out.put(granule.preflag, 1);
+            out.put(granule.scalefac_scale, 1);
+            out.put(static_cast<uint32_t>(granule.count1_table), 1);
+        }
+    }
+}
+
+// Cosine kernels of the fixture encoder's filterbank, windows folded in
+struct FixtureKernels {
+    double analysis[32][64];   // cos((2 sb + 1)(i - 16) pi/64)
+    double mdct[4][18][36];    // long blocks by type (0, 1, 3): window x cos(pi/72 (2i + 19)(2k + 1)) / 9
+    double short_mdct[6][12];  // short window x cos(pi/24 (2i + 7)(2k + 1)) / 3
+
+    FixtureKernels() : analysis(), mdct(), short_mdct() {
+        for (int sb = 0; sb < 32; ++sb) {
+            for (int i = 0; i < 64; ++i) {
+                analysis[sb][i] = std::cos((2 * sb + 1) * (i - 16) * M_PI / 64.0);
+            }
+        }
+        for (int type = 0; type < 4; ++type) {
+            for (int i = 0; i < 36; ++i) {
+                double w = std::sin(M_PI / 36.0 * (i + 0.5));
+                if (type == 1 && i >= 18) {
+                    w = i < 24 ? 1.0 : i < 30 ? std::sin(M_PI / 12.0 * (i - 18 + 0.5)) : 0.0;
+                } else if (type == 3 && i < 18) {
+                    w = i < 6 ? 0.0 : i < 12 ? std::sin(M_PI / 12.0 * (i - 6 + 0.5)) : 1.0;
+                }
+                for (int k = 0; k < 18; ++k) {
+                    mdct[type][k][i] = w * std::cos(M_PI / 72.0 * (2 * i + 1 + 18) * (2 * k + 1)) / 9.0;
+                }
+            }
+        }
+        for (int k = 0; k < 6; ++k) {
+            for (int i = 0; i < 12; ++i) {
+                short_mdct[k][i] = std::sin(M_PI / 12.0 * (i + 0.5)) *
+                                   std::cos(M_PI / 24.0 * (2 * i + 1 + 6) * (2 * k + 1)) / 3.0;
+            }
+        }
+    }
+};
+
+// Hybrid filterbank of the fixture encoder, the decoder's in reverse: ISO polyphase
+// analysis into 32 subbands, then an MDCT per subband over two granules
+struct FixtureFilterbank {
+    double history[512] = {};
+    double previous[32][18] = {};  // last granule's subband samples
+
+    // 576 input samples (every stride-th float) -> 576 lines, short blocks in bitstream order
+    void run(const float* in, size_t stride, int block_type, int sample_rate, double* xr) {
+        static const FixtureKernels kernels;
+        const float* window = Mp3Tables::synthesis_window();
+        double current[32][18];
+        for (int slot = 0; slot < 18; ++slot) {
+            std::memmove(history + 32, history, 480 * sizeof(double));
+            for (int n = 0; n < 32; ++n) {
+                history[31 - n] = in[(slot * 32 + n) * stride];
+            }
+            double folded[64] = {};
+            for (int i = 0; i < 64; ++i) {
+                for (int j = 0; j < 8; ++j) {
+                    folded[i] += window[i + 64 * j] / 32.0 * history[i + 64 * j];
+                }
+            }
+            for (int sb = 0; sb < 32; ++sb) {
+                double sum = 0.0;
+                for (int i = 0; i < 64; ++i) {
+                    sum += kernels.analysis[sb][i] * folded[i];
+                }
+                // the decoder undoes this frequency inversion after its IMDCT
+                current[sb][slot] = sb % 2 == 1 && slot % 2 == 1 ? -sum : sum;
+            }
+        }
+
+        for (int sb = 0; sb < 32; ++sb) {
+            double z[36];
+            std::copy(previous[sb], previous[sb] + 18, z);
+            std::copy(current[sb], current[sb] + 18, z + 18);
+            double* x = xr + 18 * sb;
+            if (block_type == 2) {
+                for (int w = 0; w < 3; ++w) {
+                    for (int k = 0; k < 6; ++k) {
+                        double sum = 0.0;
+                        for (int i = 0; i < 12; ++i) {
+                            sum += kernels.short_mdct[k][i] * z[6 + 6 * w + i];
+                        }
+                        x[3 * k + w] = sum;
+                    }
+                }
+            } else {
+                for (int k = 0; k < 18; ++k) {
+                    double sum = 0.0;
+                    for (int i = 0; i < 36; ++i) {
+                        sum += kernels.mdct[block_type][k][i] * z[i];
+                    }
+                    x[k] = sum;
+                }
+            }
+            std::copy(current[sb], current[sb] + 18, previous[sb]);
+        }
+
+        if (block_type == 2) {
+            // interleaved windows -> band by band, window by window
+            const int* short_bands = Mp3Tables::short_bands(sample_rate);
+            double ordered[576];
+            for (int band = 0; band < 13; ++band) {
+                const int width = short_bands[band + 1] - short_bands[band];
+                const int base = 3 * short_bands[band];
+                for (int w = 0; w < 3; ++w) {
+                    for (int i = 0; i < width; ++i) {
+                        ordered[base + w * width + i] = xr[base + 3 * i + w];
+                    }
+                }
+            }
+            std::copy(ordered, ordered + 576, xr);
+        } else {
+            // inverse of the decoder's alias-reduction butterflies
+            for (int sb = 1; sb < 32; ++sb) {
+                for (int i = 0; i < 8; ++i) {
+                    const double c = Mp3Tables::ALIAS_COEFFICIENTS[i];
+                    const double cs = 1.0 / std::sqrt(1.0 + c * c), ca = c / std::sqrt(1.0 + c * c);
+                    const double a = xr[18 * sb - 1 - i], b = xr[18 * sb + i];
+                    xr[18 * sb - 1 - i] = a * cs + b * ca;
+                    xr[18 * sb + i] = b * cs - a * ca;
+                }
+            }
+        }
+    }
+};
+
+// Stereo 44.1 kHz MPEG-1 Layer III stream of `stereo` (interleaved) at a constant bitrate.
+// No psychoacoustics: one global gain per frame, searched to fill the frame and the bit
+// reservoir, with seeded random scalefactors, scfsi, preflag, subblock gains, region splits
+// and count1 tables, a start/short/short/stop block sequence every four frames and mid/side
+// stereo on three frames out of four, so the stream covers the decoder's syntax.
+// Returns the largest main_data_begin used.
+int write_mp3_stream(const std::string& path, const std::vector<float>& stereo, int kbps) {
+    const int sample_rate = 44100;
+    const int bitrate_index[15] = { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 };
+    const int index = static_cast<int>(std::find(bitrate_index, bitrate_index + 15, kbps) - bitrate_index);
+    const int block_cycle[8] = { 0, 0, 0, 1, 2, 2, 3, 0 };
+
+    // one frame of zeros past the end flushes the filterbank delay
+    const size_t frames = (stereo.size() / 2 + 1152 - 1) / 1152 + 2;
+    std::vector<float> input(frames * 1152 * 2, 0.0f);
+    std::copy(stereo.begin(), stereo.end(), input.begin());
+
+    std::mt19937 rng(39);
+    FixtureFilterbank filterbanks[2];
+    std::vector<unsigned char> stream;       // main data areas of all frames, back to back
+    std::string out;
+    std::vector<size_t> areas;               // offset of each frame's main data area in `out`
+    int max_begin = 0;
+    size_t data_end = 0;                     // end of the last frame's main data in `stream`
+    int padding_rest = 0;
+
+    for (size_t f = 0; f < frames; ++f) {
+        padding_rest += 144000 * kbps % sample_rate;
+        const bool padding = padding_rest >= sample_rate;
+        if (padding) {
+            padding_rest -= sample_rate;
+        }
+        const size_t frame_bytes = static_cast<size_t>(144000 * kbps / sample_rate) + (padding ? 1 : 0);
+        const bool mid_side = f % 4 != 3;
+
+        FixtureGranule granules[2][2];
+        bool scfsi[2][4] = {};
+        double xr[2][2][576];
+        for (int gr = 0; gr < 2; ++gr) {
+            const int block_type = block_cycle[(2 * f + static_cast<size_t>(gr)) % 8];
+            for (int ch = 0; ch < 2; ++ch) {
+                filterbanks[ch].run(input.data() + (f * 1152 + static_cast<size_t>(gr) * 576) * 2 + ch, 2,
+                                    block_type, sample_rate, xr[gr][ch]);
+                FixtureGranule& granule = granules[gr][ch];
+                granule.block_type = block_type;
+                granule.scalefac_compress = static_cast<int>(rng() % 16);
+                granule.scalefac_scale = rng() % 2 == 0;
+                granule.preflag = block_type != 2 && rng() % 3 == 0;
+                granule.count1_table = static_cast<int>(rng() % 2);
+                granule.region0_count = static_cast<int>(rng() % 13);
+                granule.region1_count = static_cast<int>(rng() % (std::min(7, 20 - granule.region0_count) + 1));
+                const int max1 = (1 << Mp3Tables::SLEN[0][granule.scalefac_compress]) - 1;
+                const int max2 = (1 << Mp3Tables::SLEN[1][granule.scalefac_compress]) - 1;
+                for (int w = 0; w < 3; ++w) {
+                    granule.subblock_gain[w] = static_cast<int>(rng() % 3);
+                }
+                for (int band = 0; band < 21; ++band) {
+                    granule.scalefac_long[band] = static_cast<int>(rng() % (std::min(band < 11 ? max1 : max2, 2) + 1));
+                }
+                for (int band = 0; band < 12; ++band) {
+                    for (int w = 0; w < 3; ++w) {
+                        granule.scalefac_short[band][w] = static_cast<int>(rng() % (std::min(band < 6 ? max1 : max2, 2) + 1));
+                    }
+                }
+                if (gr == 1 && block_type != 2 && granules[0][ch].block_type != 2) {
+                    const int groups[5] = { 0, 6, 11, 16, 21 };
+                    for (int group = 0; group < 4; ++group) {
+                        scfsi[ch][group] = rng() % 2 == 0;
+                        for (int band = groups[group]; scfsi[ch][group] && band < groups[group + 1]; ++band) {
+                            granule.scalefac_long[band] = granules[0][ch].scalefac_long[band];
+                        }
+                    }
+                }
+            }
+            if (mid_side) {
+                for (int i = 0; i < 576; ++i) {
+                    const double left = xr[gr][0][i], right = xr[gr][1][i];
+                    xr[gr][0][i] = (left + right) * M_SQRT1_2;
+                    xr[gr][1][i] = (left - right) * M_SQRT1_2;
+                }
+            }
+        }
+
+        // main data may start up to 511 bytes back, in space earlier frames left unused
+        const size_t area_start = stream.size();
+        const size_t area_bytes = frame_bytes - 4 - 32;
+        const size_t begin = std::max(data_end, area_start >= 511 ? area_start - 511 : 0);
+        const size_t budget = (area_start + area_bytes - begin) * 8;
+        const bool no_reuse[4] = {};
+        auto fits = [&](int gain) {
+            size_t total = 0;
+            for (int gr = 0; gr < 2; ++gr) {
+                for (int ch = 0; ch < 2; ++ch) {
+                    granules[gr][ch].global_gain = gain;
+                    const int bits = fixture_quantize(xr[gr][ch], granules[gr][ch], gr == 1 ? scfsi[ch] : no_reuse, sample_rate);
+                    if (bits < 0 || bits > 4095) {
+                        return false;
+                    }
+                    total += static_cast<size_t>(bits);
+                }
+            }
+            return total <= budget;
+        };
+        int low = 0, high = 255;
+        while (low < high) {
+            const int mid = (low + high) / 2;
+            if (fits(mid)) {
+                high = mid;
+            } else {
+                low = mid + 1;
+            }
+        }
+        fits(low);
+
+        BitWriter main_data;
+        for (int gr = 0; gr < 2; ++gr) {
+            for (int ch = 0; ch < 2; ++ch) {
+                fixture_write_main_data(main_data, granules[gr][ch], gr == 1 ? scfsi[ch] : no_reuse, sample_rate);
+            }
+        }
+        const int main_data_begin = static_cast<int>(area_start - begin);
+        max_begin = std::max(max_begin, main_data_begin);
+        stream.resize(area_start + area_bytes, 0);
+        std::copy(main_data.bytes.begin(), main_data.bytes.end(), stream.begin() + static_cast<std::ptrdiff_t>(begin));
+        data_end = begin + main_data.bytes.size();
+
+        BitWriter side;
+        fixture_write_side_info(side, granules, scfsi, main_data_begin);
+        out.push_back(static_cast<char>(0xFF));
+        out.push_back(static_cast<char>(0xFB));  // MPEG-1 Layer III, no CRC
+        out.push_back(static_cast<char>((index << 4) | (padding ? 2 : 0)));
+        out.push_back(static_cast<char>(mid_side ? 0x60 : 0x40));  // joint stereo, mode extension
+        out.append(side.bytes.begin(), side.bytes.end());
+        areas.push_back(out.size());
+        out.append(area_bytes, '\0');
+    }
+    // a frame's area is final only once later frames stop borrowing it: copy them in at the end
+    size_t copied = 0;
+    for (size_t f = 0; f < areas.size(); ++f) {
+        const size_t area_bytes = (f + 1 < areas.size() ? areas[f + 1] - 36 : out.size()) - areas[f];
+        std::copy(stream.begin() + static_cast<std::ptrdiff_t>(copied),
+                  stream.begin() + static_cast<std::ptrdiff_t>(copied + area_bytes),
+                  out.begin() + static_cast<std::ptrdiff_t>(areas[f]));
+        copied += area_bytes;
+    }
+    std::ofstream(path, std::ios::binary).write(out.data(), static_cast<std::streamsize>(out.size()));
+    return max_begin;
+}
+
+// Stereo test signal for the decoder: two tones per channel plus a decaying noise burst
+// every quarter second, so the encoder's short blocks code real transients
+std::vector<float> make_mp3_source(size_t frames) {
+    std::vector<float> stereo(frames * 2);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    for (size_t i = 0; i < frames; ++i) {
+        const double t = static_cast<double>(i) / 44100.0;
+        const size_t phase = i % 11025;
+        const double burst = phase < 400 ? 0.3 * noise(rng) * (1.0 - phase / 400.0) : 0.0;
+        stereo[2 * i] = static_cast<float>(0.4 * std::sin(2 * M_PI * 440.0 * t) + 0.15 * std::sin(2 * M_PI * 2637.0 * t) + burst);
+        stereo[2 * i + 1] = static_cast<float>(0.35 * std::sin(2 * M_PI * 554.37 * t) + 0.1 * std::sin(2 * M_PI * 6000.0 * t) + 0.5 * burst);
+    }
+    return stereo;
+}
+
+// Decode every frame of an open reader; returns the interleaved PCM and counts failed frames
+std::vector<float> decode_mp3(Mp3Reader& reader, Mp3Decoder& decoder, size_t& failed) {
+    std::vector<float> pcm;
+    std::vector<float> block(static_cast<size_t>(Mp3Decoder::MAX_FRAME_SAMPLES) * 2);
+    Mp3Frame frame;
+    failed = 0;
+    while (reader.next_frame(frame)) {
+        failed += !decoder.decode(frame, block.data());
+        pcm.insert(pcm.end(), block.begin(), block.begin() + frame.header.samples * frame.header.channels);
+    }
+    return pcm;
+}
+
+void benchmark_mp3_decoder() {
+    std::cout << "\n======== MP3 DECODER BENCHMARK ========" << std::endl;
+
+    // ten seconds at 192 kbps, decoded frame by frame on a single thread
+    const size_t frames = 10 * 44100;
+    std::string path = (std::filesystem::temp_directory_path() / "dj_bench_decode.mp3").string();
+    write_mp3_stream(path, make_mp3_source(frames), 192);
+
+    double best = 1e9;
+    size_t decoded = 0, failed = 0;
+    Mp3Reader reader;
+    for (int run = 0; run < 3; ++run) {
+        if (!reader.open(path)) {
+            std::cout << reader.get_error() << std::endl;
+            std::remove(path.c_str());
+            return;
+        }
+        Mp3Decoder decoder;
+        auto started = std::chrono::steady_clock::now();
+        decoded = decode_mp3(reader, decoder, failed).size() / 2;
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+    }
+    const double frame_count = static_cast<double>(decoded) / Mp3Decoder::MAX_FRAME_SAMPLES;
+    std::cout << "decode: " << frame_count << " frames (" << failed << " failed), " << frame_count / best
+              << " frames/sec, " << reader.get_audio_bytes() / best / 1e6 << " MB/s, "
+              << static_cast<double>(decoded) / 44100.0 / best << "x real time per core" << std::endl;
+    reader.close();
+    std::remove(path.c_str());
+}
+
+// The hybrid filterbank delays the decoded signal by 481 + 576 samples. At 320 kbps the
+// fixture encoder keeps every granule near 40 dB; a Huffman, requantization or transform
+// error drops the SNR far below that.
+constexpr size_t MP3_CODEC_DELAY = 1057;
+constexpr double MP3_MIN_SNR_DB = 40.0;
+constexpr double MP3_WAVEFORM_ENERGY_TOLERANCE = 0.02;
+
+// Signal-to-noise ratio of decoded channel `ch` against the source, where decoded sample
+// `first + i` carries source sample `first + i - MP3_CODEC_DELAY`
+double mp3_snr(const std::vector<float>& source, const std::vector<float>& decoded, size_t first, int ch) {
+    double signal = 0.0, noise = 0.0;
+    for (size_t i = first; i * 2 + 1 < decoded.size() && (i - MP3_CODEC_DELAY) * 2 + 1 < source.size(); ++i) {
+        const double expected = source[(i - MP3_CODEC_DELAY) * 2 + static_cast<size_t>(ch)];
+        const double error = decoded[i * 2 + static_cast<size_t>(ch)] - expected;
+        signal += expected * expected;
+        noise += error * error;
+    }
+    return noise > 0.0 ? 10.0 * std::log10(signal / noise) : 200.0;
+}
+
+bool check_mp3_decoder() {
+    std::string path = (std::filesystem::temp_directory_path() / "dj_check.mp3").string();
+    const size_t frames = 2 * 44100;
+    const std::vector<float> source = make_mp3_source(frames);
+    const int reservoir = write_mp3_stream(path, source, 320);
+
+    // straight through, from the first frame
+    Mp3Reader reader;
+    Mp3Decoder decoder;
+    size_t failed = 0;
+    std::vector<float> decoded;
+    const bool opened = reader.open(path);
+    if (opened) {
+        decoded = decode_mp3(reader, decoder, failed);
+    }
+    const double left = mp3_snr(source, decoded, MP3_CODEC_DELAY, 0);
+    const double right = mp3_snr(source, decoded, MP3_CODEC_DELAY, 1);
+
+    // after a seek: frames before the reservoir refills are silent, the filterbanks
+    // settle within two frames of the first one decoded
+    double seeked = 0.0;
+    if (opened) {
+        reader.seek(1.0);
+        decoder.reset();
+        std::vector<float> block(static_cast<size_t>(Mp3Decoder::MAX_FRAME_SAMPLES) * 2);
+        std::vector<float> pcm;
+        Mp3Frame frame;
+        size_t first = 0;
+        bool started = false;
+        while (reader.next_frame(frame)) {
+            if (!started && decoder.decode(frame, block.data())) {
+                started = true;
+                first = frame.first_sample;
+                pcm.assign(first * 2, 0.0f);
+            } else if (started) {
+                decoder.decode(frame, block.data());
+            }
+            if (started) {
+                pcm.insert(pcm.end(), block.begin(), block.begin() + frame.header.samples * 2);
+            }
+        }
+        seeked = std::min(mp3_snr(source, pcm, first + 2 * Mp3Decoder::MAX_FRAME_SAMPLES, 0),
+                          mp3_snr(source, pcm, first + 2 * Mp3Decoder::MAX_FRAME_SAMPLES, 1));
+    }
+    reader.close();
+
+    // the track's waveform is the decoded mono sum at the analysis rate
+    MutedOutput mute;
+    MP3Track track("Decode", {"Check"}, 2, 128, 320);
+    track.set_file_path(path);
+    track.load();
+    mute.restore();
+    const WaveformView waveform = track.get_waveform();
+    double track_energy = 0.0, source_energy = 0.0;
+    for (float v : waveform) {
+        track_energy += static_cast<double>(v) * v;
+    }
+    for (size_t i = 0; i + 4 <= frames; i += 4) {
+        // the track averages four 44.1 kHz sample frames per analysis sample
+        double mono = 0.0;
+        for (size_t j = i; j < i + 4; ++j) {
+            mono += (source[2 * j] + source[2 * j + 1]) / 8.0;
+        }
+        source_energy += mono * mono;
+    }
+    const double energy_ratio = source_energy > 0.0 ? track_energy / source_energy : 0.0;
+    const size_t expected_size = decoded.size() / 2 / 4;
+    std::remove(path.c_str());
+
+    const bool passed = failed == 0 && reservoir > 0 && std::min(left, right) >= MP3_MIN_SNR_DB &&
+                        seeked >= MP3_MIN_SNR_DB && waveform.size() == expected_size &&
+                        std::fabs(energy_ratio - 1.0) <= MP3_WAVEFORM_ENERGY_TOLERANCE;
+    std::cout << "[Check] mp3 decoder: " << decoded.size() / 2 / Mp3Decoder::MAX_FRAME_SAMPLES << " frames, "
+              << failed << " failed, reservoir up to " << reservoir << " bytes, SNR " << left << " / " << right
+              << " dB, " << seeked << " dB after a seek (limit " << MP3_MIN_SNR_DB << "), waveform "
+              << waveform.size() << "/" << expected_size << " samples, energy ratio " << energy_ratio << ": "
+              << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed;
+}
+
+void benchmark_seek_index() {
+    std::cout << "\n======== SEEK INDEX BENCHMARK ========" << std::endl;
+
+    // the longest track in the library: 645 s of 320 kbps frames
+    MP3Track strobe("Strobe", {"deadmau5"}, 645, 128, 320);
+    strobe.load();
+    const SeekIndex& index = strobe.get_seek_index();
+    std::cout << index.size() << " frames indexed, " << index.memory_bytes() / 1024 << " KiB" << std::endl;
+
+    for (size_t slot = 0; slot < TrackNavigation::HOT_CUE_SLOTS; ++slot) {
+        strobe.seek(slot * 80.0 + 7.5);
+        strobe.set_hot_cue(slot);
+    }
+
+    // jump between hot cues in a scrambled order
+    const size_t jumps = 1000000;
+    uint64_t offsets = 0;
+    auto started = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < jumps; ++i) {
+        strobe.jump_to_hot_cue((i * 5) % TrackNavigation::HOT_CUE_SLOTS);
+        offsets += strobe.get_position_offset();
+    }
+    double indexed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    // baseline: step frame by frame from the start of the track, as without an index
+    // (only the arithmetic; a real walk also has to read and parse every header)
+    const size_t walks = 1000;
+    const uint64_t frame_bytes = 1152 * 320 * 1000 / 8 / 44100;
+    uint64_t walked = 0;
+    started = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < walks; ++i) {
+        uint64_t target = index.to_samples(((i * 5) % TrackNavigation::HOT_CUE_SLOTS) * 80.0 + 7.5);
+        uint64_t offset = 0;
+        for (uint64_t sample = 1152; sample <= target; sample += 1152) {
+            offset += frame_bytes + (sample % 3 == 0);
+        }
+        walked += offset;
+    }
+    double linear = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::cout << "hot-cue jump: " << indexed / jumps * 1e9 << " ns indexed, " << linear / walks * 1e9
+              << " ns stepping from the start (" << (linear / walks) / (indexed / jumps) << "x); mean offsets "
+              << offsets / jumps << " / " << walked / walks << std::endl;
+
+    // clones share the index and the cues
+    PointerWrapper<AudioTrack> copy = strobe.clone();
+    copy->jump_to_hot_cue(7);
+    std::cout << "clone jumps to hot cue 8 at " << copy->get_position() << "s, byte "
+              << copy->get_position_offset() << std::endl;
+}
+
+void benchmark_waveform_overview() {
+    std::cout << "\n======== WAVEFORM OVERVIEW BENCHMARK ========" << std::endl;
+
+    // the 645 s "Strobe" at the analysis rate, a tone under a slow swell
+    const double rate = AudioAnalyzer::ANALYSIS_SAMPLE_RATE;
+    const size_t count = static_cast<size_t>(645 * rate);
+    std::vector<float> samples(count);
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] = static_cast<float>(std::sin(2.0 * M_PI * 110.0 * i / rate) *
+                                        (0.5 + 0.5 * std::sin(2.0 * M_PI * i / (30.0 * rate))));
+    }
+
+    WaveformPyramid pyramid;
+    auto started = std::chrono::steady_clock::now();
+    pyramid.build(WaveformView(samples.data(), count));
+    double build = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cout << count << " samples, " << pyramid.levels() << " levels, " << pyramid.memory_bytes() / 1024
+              << " KiB, built in " << build * 1000.0 << " ms" << std::endl;
+
+    // one 1000-pixel view at three zooms, from the pyramid and by scanning every sample
+    const size_t pixels = 1000;
+    std::vector<float> lo(pixels), hi(pixels), rms(pixels);
+    const double windows[] = { 645.0, 30.0, 1.0 };
+    for (double window : windows) {
+        const size_t span = static_cast<size_t>(window * rate);
+        const size_t first = (count - span) / 2;
+        const int rounds = 20;
+
+        started = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            pyramid.render(first, span, pixels, lo.data(), hi.data(), rms.data());
+        }
+        double view = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() / rounds;
+        float pyramid_peak = *std::max_element(hi.begin(), hi.end());
+
+        started = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            for (size_t p = 0; p < pixels; ++p) {
+                size_t begin = first + p * span / pixels;
+                size_t end = std::max(begin + 1, first + (p + 1) * span / pixels);
+                float top = samples[begin];
+                for (size_t i = begin; i < end; ++i) {
+                    top = std::max(top, samples[i]);
+                }
+                hi[p] = top;
+            }
+        }
+        double scan = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() / rounds;
+
+        std::cout << window << "s window: level " << pyramid.level_for(static_cast<double>(span) / pixels)
+                  << ", " << view * 1e6 << " us from the pyramid vs " << scan * 1e6 << " us scanning samples ("
+                  << scan / view << "x), peak " << pyramid_peak << " / " << *std::max_element(hi.begin(), hi.end())
+                  << std::endl;
+    }
+}
+
+// A catalog around 126 BPM with unknown (0) and corrupt tempos mixed in, a quality
+// score per track and 200 playing tempos to look up
+struct BpmFixture {
+    std::vector<int32_t> bpms;
+    std::vector<double> quality;
+    std::vector<int> playing;
+    size_t out_of_range = 0;
+};
+
+BpmFixture make_bpm_fixture(size_t count) {
+    BpmFixture fixture;
+    std::mt19937 rng(31);
+    std::normal_distribution<double> tempo(126.0, 15.0);
+    fixture.bpms.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        fixture.bpms[i] = std::max(60, std::min(200, static_cast<int>(std::lround(tempo(rng)))));
+    }
+    for (size_t i = 0; i < count; i += 1000) {
+        fixture.bpms[i] = 0;
+        ++fixture.out_of_range;
+    }
+    fixture.bpms[7] = 2000000000;
+    ++fixture.out_of_range;
+
+    fixture.playing.resize(200);
+    for (int& bpm : fixture.playing) {
+        bpm = static_cast<int>(std::lround(tempo(rng)));
+    }
+    std::uniform_real_distribution<double> score(0.0, 1.0);
+    fixture.quality.resize(count);
+    for (double& q : fixture.quality) {
+        q = score(rng);
+    }
+    return fixture;
+}
+
+// What BpmIndex::nearest must find, by scanning every track; matches counts the tracks in the window
+TrackId scan_nearest(const BpmFixture& fixture, int bpm, int tolerance, TrackId exclude, size_t& matches) {
+    const std::vector<int32_t>& bpms = fixture.bpms;
+    const std::vector<double>& quality = fixture.quality;
+    TrackId best = INVALID_TRACK_ID;
+    long long best_diff = 0;
+    for (size_t i = 0; i < bpms.size(); ++i) {
+        const long long diff = std::llabs(static_cast<long long>(bpms[i]) - bpm);
+        if (bpms[i] < BpmIndex::MIN_BPM || bpms[i] > BpmIndex::MAX_BPM || diff > tolerance) {
+            continue;
+        }
+        ++matches;
+        if (i == exclude) {
+            continue;
+        }
+        if (best == INVALID_TRACK_ID || diff < best_diff || (diff == best_diff && quality[i] > quality[best])) {
+            best = static_cast<TrackId>(i);
+            best_diff = diff;
+        }
+    }
+    return best;
+}
+
+void benchmark_bpm_index() {
+    std::cout << "\n======== BPM INDEX BENCHMARK ========" << std::endl;
+
+    // a million-track catalog
+    const size_t count = 1000000;
+    const BpmFixture fixture = make_bpm_fixture(count);
+    const std::vector<int32_t>& bpms = fixture.bpms;
+    const std::vector<double>& quality = fixture.quality;
+    const std::vector<int>& playing = fixture.playing;
+
+    BpmIndex index;
+    auto started = std::chrono::steady_clock::now();
+    index.build(bpms);
+    double build = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cout << count << " tracks indexed in " << build * 1000.0 << " ms, " << index.unindexed()
+              << " left out for a BPM outside " << BpmIndex::MIN_BPM << ".." << BpmIndex::MAX_BPM << std::endl;
+
+    // each playing tempo looked up as a range and as a suggestion: the closest BPM within
+    // tolerance, ties to the higher quality (BpmIndex::nearest, as DJSession::suggest_next_track uses it)
+    const int tolerance = 3;
+
+    size_t indexed_hits = 0;
+    started = std::chrono::steady_clock::now();
+    for (int bpm : playing) {
+        indexed_hits += index.query(bpm, tolerance).size();
+    }
+    double query = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() / playing.size();
+
+    size_t copied_hits = 0;
+    started = std::chrono::steady_clock::now();
+    for (int bpm : playing) {
+        copied_hits += index.findWithin(bpm, tolerance).size();
+    }
+    double copy = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() / playing.size();
+
+    double indexed_pick = 0.0;
+    started = std::chrono::steady_clock::now();
+    for (int bpm : playing) {
+        TrackId best = index.nearest(bpm, tolerance, quality);
+        indexed_pick += best == INVALID_TRACK_ID ? 0.0 : quality[best];
+    }
+    double suggest = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() / playing.size();
+
+    size_t scanned_hits = 0;
+    double scanned_pick = 0.0;
+    started = std::chrono::steady_clock::now();
+    for (int bpm : playing) {
+        TrackId best = scan_nearest(fixture, bpm, tolerance, INVALID_TRACK_ID, scanned_hits);
+        scanned_pick += best == INVALID_TRACK_ID ? 0.0 : quality[best];
+    }
+    double scan = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() / playing.size();
+
+    std::cout << "+/-" << tolerance << " BPM, " << indexed_hits / playing.size() << " matches per lookup: range "
+              << query * 1e6 << " us (copied out: " << copy * 1e6 << " us)" << std::endl;
+    std::cout << "suggestion: " << suggest * 1e6 << " us through the index vs " << scan * 1e6
+              << " us scanning the catalog (" << scan / suggest << "x), results "
+              << (indexed_hits == scanned_hits && copied_hits == scanned_hits && indexed_pick == scanned_pick
+                      ? "match" : "DIFFER") << std::endl;
+}
+
+bool check_bpm_index() {
+    const BpmFixture fixture = make_bpm_fixture(100000);
+    BpmIndex index;
+    index.build(fixture.bpms);
+
+    // the fixture's tempos plus the edges: below and above the catalog and the indexable range
+    std::vector<int> tempos = fixture.playing;
+    tempos.insert(tempos.end(), { 0, BpmIndex::MIN_BPM, 55, 205, BpmIndex::MAX_BPM, 1500 });
+    const int tolerances[] = { 0, 3, 10 };
+    size_t lookups = 0;
+    size_t differences = index.unindexed() == fixture.out_of_range ? 0 : 1;
+    for (int tolerance : tolerances) {
+        for (int bpm : tempos) {
+            size_t matches = 0;
+            const TrackId expected = scan_nearest(fixture, bpm, tolerance, INVALID_TRACK_ID, matches);
+            differences += index.query(bpm, tolerance).size() != matches;
+            differences += index.nearest(bpm, tolerance, fixture.quality) != expected;
+            ++lookups;
+            // as in a session, where the playing track is never suggested
+            if (expected != INVALID_TRACK_ID) {
+                const TrackId runner_up = scan_nearest(fixture, bpm, tolerance, expected, matches);
+                differences += index.nearest(bpm, tolerance, fixture.quality, expected) != runner_up;
+                ++lookups;
+            }
+        }
+    }
+    std::cout << "[Check] BPM index: " << lookups << " lookups against a catalog scan, " << differences
+              << " differ: " << (differences == 0 ? "PASS" : "FAIL") << std::endl;
+    return differences == 0;
+}
+
+void benchmark_playlist_optimizer() {
+    std::cout << "\n======== PLAYLIST OPTIMIZER BENCHMARK ========" << std::endl;
+
+    // shuffled playlists around 126 BPM, keys spread over the wheel, a tenth of them undetected
+    const size_t sizes[] = { 100, 1000, 4096, 10000 };
+    for (size_t n : sizes) {
+        std::mt19937 rng(33);
+        std::normal_distribution<double> tempo(126.0, 15.0);
+        std::uniform_int_distribution<int> key(0, 12);
+        std::vector<float> bpms(n);
+        std::vector<int> camelot(n);
+        std::vector<bool> minor(n);
+        for (size_t i = 0; i < n; ++i) {
+            bpms[i] = static_cast<float>(std::lround(tempo(rng)));
+            camelot[i] = key(rng) > 0 && i % 10 != 0 ? key(rng) : 0;
+            minor[i] = rng() % 2 == 0;
+        }
+
+        PlaylistOptimizer optimizer(bpms, camelot, minor);
+        PlaylistOptimizer::Result result = optimizer.solve();
+        const double transitions = static_cast<double>(n - 1);
+        std::cout << n << " tracks (" << (n <= PlaylistOptimizer::MATRIX_LIMIT ? "cost matrix" : "costs on the fly")
+                  << "): cost per transition " << result.initial_cost / transitions << " -> "
+                  << result.final_cost / transitions << " ("
+                  << 100.0 * (result.initial_cost - result.final_cost) / result.initial_cost << "% lower) in "
+                  << result.solve_ms << " ms" << std::endl;
+    }
+}
+
+// Int16 quantization moves a sample by at most 1/65534, so per-block and overall RMS
+// should differ by far less than these; keys must match exactly.
+constexpr double FORMAT_ENERGY_TOLERANCE = 1e-4;
+constexpr double FORMAT_RMS_TOLERANCE = 1e-4;
+
+// one minute of a C major chord under a 2 Hz pulse at the analysis rate
+std::vector<float> make_chord_fixture() {
+    const double rate = AudioAnalyzer::ANALYSIS_SAMPLE_RATE;
+    const size_t count = static_cast<size_t>(60 * rate);
+    std::vector<float> reference(count);
+    for (size_t i = 0; i < count; ++i) {
+        double t = i / rate;
+        double chord = std::sin(2.0 * M_PI * 261.63 * t) + 0.8 * std::sin(2.0 * M_PI * 329.63 * t) +
+                       0.7 * std::sin(2.0 * M_PI * 392.00 * t);
+        reference[i] = static_cast<float>(0.3 * chord * (0.6 + 0.4 * std::cos(2.0 * M_PI * 2.0 * t)));
+    }
+    return reference;
+}
+
+// Analysis of the same audio stored as float32 and as an int16 round trip
+struct FormatComparison {
+    TrackAnalysis from_float = TrackAnalysis();
+    TrackAnalysis from_int16 = TrackAnalysis();
+    double snr_db = 0.0;
+    double energy_error = 0.0;  // largest energy block difference
+    double rms_error = 0.0;
+    bool keys_match = false;
+
+    bool passed() const {
+        return keys_match && from_float.energy_profile.size() == from_int16.energy_profile.size() &&
+               energy_error <= FORMAT_ENERGY_TOLERANCE && rms_error <= FORMAT_RMS_TOLERANCE;
+    }
+};
+
+FormatComparison compare_formats(const std::vector<float>& reference, const std::vector<float>& restored) {
+    FormatComparison result;
+    double signal = 0.0, noise = 0.0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        signal += static_cast<double>(reference[i]) * reference[i];
+        noise += (static_cast<double>(restored[i]) - reference[i]) * (static_cast<double>(restored[i]) - reference[i]);
+    }
+    result.snr_db = 10.0 * std::log10(signal / noise);
+
+    AudioAnalyzer::analyze_features(result.from_float, WaveformView(reference.data(), reference.size()));
+    AudioAnalyzer::analyze_features(result.from_int16, WaveformView(restored.data(), restored.size()));
+    const size_t blocks = std::min(result.from_float.energy_profile.size(), result.from_int16.energy_profile.size());
+    for (size_t b = 0; b < blocks; ++b) {
+        result.energy_error = std::max(result.energy_error, static_cast<double>(std::fabs(
+            result.from_float.energy_profile[b] - result.from_int16.energy_profile[b])));
+    }
+    result.rms_error = std::fabs(result.from_float.rms - result.from_int16.rms);
+    result.keys_match = result.from_float.camelot_number == result.from_int16.camelot_number &&
+                        result.from_float.camelot_letter == result.from_int16.camelot_letter;
+    return result;
+}
+
+void benchmark_sample_formats() {
+    std::cout << "\n======== SAMPLE FORMAT BENCHMARK ========" << std::endl;
+
+    const double rate = AudioAnalyzer::ANALYSIS_SAMPLE_RATE;
+    const std::vector<float> reference = make_chord_fixture();
+    const size_t count = reference.size();
+
+    // cold storage round trip: float32 -> int16 -> float32
+    std::vector<int16_t> packed(count);
+    std::vector<float> restored(count);
+    const int rounds = 20;
+    auto started = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        SampleConverter::to_int16(reference.data(), packed.data(), count);
+    }
+    double pack = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() / rounds;
+    started = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        SampleConverter::to_float(packed.data(), restored.data(), count);
+    }
+    double unpack = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() / rounds;
+    std::cout << "float32 -> int16: " << count / pack / 1e6 << "M samples/sec, int16 -> float32: "
+              << count / unpack / 1e6 << "M samples/sec" << std::endl;
+
+    // analysis outputs must not depend on the storage format (make check fails if they do)
+    const FormatComparison comparison = compare_formats(reference, restored);
+    std::cout << "round trip SNR " << comparison.snr_db << " dB" << std::endl;
+    const TrackAnalysis* results[] = { &comparison.from_float, &comparison.from_int16 };
+    const SampleFormat formats[] = { SampleFormat::Float32, SampleFormat::Int16 };
+    for (int f = 0; f < 2; ++f) {
+        std::cout << SampleConverter::name(formats[f]) << ": key " << results[f]->camelot_number
+                  << results[f]->camelot_letter << " (confidence " << results[f]->key_confidence << "), rms "
+                  << results[f]->rms << ", " << results[f]->energy_profile.size() << " energy blocks" << std::endl;
+    }
+    std::cout << "max energy block difference " << comparison.energy_error << ", keys "
+              << (comparison.keys_match ? "match" : "DIFFER") << ": "
+              << (comparison.passed() ? "within tolerance" : "OUT OF TOLERANCE") << std::endl;
+
+    // footprint of the 645 s "Strobe" waveform at the analysis rate
+    const size_t strobe = static_cast<size_t>(645 * rate);
+    std::cout << "645s waveform: " << strobe * sizeof(double) / 1024 << " KiB as double, "
+              << strobe * SampleConverter::bytes_per_sample(SampleFormat::Float32) / 1024 << " KiB as float32, "
+              << strobe * SampleConverter::bytes_per_sample(SampleFormat::Int16) / 1024 << " KiB as int16" << std::endl;
+}
+
+void benchmark_cold_tier() {
+    std::cout << "\n======== COLD TIER BENCHMARK ========" << std::endl;
+
+    // a three-minute WAV track, analyzed and cached as int16, then evicted and re-used
+    std::string path = (std::filesystem::temp_directory_path() / "dj_bench_cold.wav").string();
+    write_wav_fixture(path, 16, false, 180 * 44100);
+    WAVTrack source("Cold", {"Bench"}, 180, 128, 44100, 16);
+    source.set_file_path(path);
+    source.set_id(0);
+
+    const int rounds = 5;
+    PointerWrapper<AudioTrack> cached;
+    auto started = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        cached = source.clone();
+        cached->load();
+        cached->analyze_beatgrid();
+        cached->set_sample_format(SampleFormat::Int16);
+    }
+    double reload = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() / rounds;
+
+    ColdTrackStore cold(1);
+    double demote = 0.0, promote = 0.0;
+    size_t compressed = 0, raw = 0;
+    for (int r = 0; r < rounds; ++r) {
+        started = std::chrono::steady_clock::now();
+        cold.put(std::move(cached));
+        demote += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        compressed = cold.compressed_bytes();
+        raw = cold.raw_bytes();
+        started = std::chrono::steady_clock::now();
+        cached = cold.take(0);
+        promote += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+    demote /= rounds;
+    promote /= rounds;
+    std::cout << "re-load (clone + load + analyze): " << reload * 1000.0 << " ms, promote from cold tier: "
+              << promote * 1000.0 << " ms (" << reload / promote << "x), demote " << demote * 1000.0 << " ms"
+              << std::endl;
+    std::cout << "pure tone fixture: " << raw / 1024 << " KiB -> " << compressed / 1024 << " KiB ("
+              << static_cast<double>(raw) / compressed << ":1), analysis kept: "
+              << (cached && cached->get_analysis().analyzed && cached->get_overview() != nullptr ? "yes" : "NO")
+              << std::endl;
+    std::remove(path.c_str());
+
+    // compression ratio on a busier signal: chord, pulse and noise, as int16
+    const double rate = AudioAnalyzer::ANALYSIS_SAMPLE_RATE;
+    const size_t count = static_cast<size_t>(180 * rate);
+    std::vector<int16_t> music(count);
+    uint32_t noise = 12345;
+    for (size_t i = 0; i < count; ++i) {
+        double t = i / rate;
+        noise = noise * 1664525u + 1013904223u;
+        double v = 0.25 * (std::sin(2.0 * M_PI * 261.63 * t) + 0.8 * std::sin(2.0 * M_PI * 329.63 * t)) *
+                   (0.6 + 0.4 * std::cos(2.0 * M_PI * 2.0 * t)) + 0.02 * (static_cast<double>(noise >> 8) / (1 << 24) - 0.5);
+        music[i] = static_cast<int16_t>(std::lround(v * 32767.0));
+    }
+    std::vector<unsigned char> plain, planes;
+    Lz4Block::compress(reinterpret_cast<const unsigned char*>(music.data()), count * 2, plain);
+    ColdTrackStore::compress(music.data(), count, 2, planes);
+    std::cout << "chord + noise: LZ4 alone " << count * 2.0 / plain.size() << ":1, delta + byte planes + LZ4 "
+              << count * 2.0 / planes.size() << ":1" << std::endl;
+}
+
+// Float32 samples and analysis of a cached track, to compare a copy restored from a tier against
+struct TrackSnapshot {
+    std::vector<float> samples;
+    TrackAnalysis analysis;
+};
+
+TrackSnapshot snapshot(const AudioTrack& track) {
+    PointerWrapper<AudioTrack> copy = track.clone();
+    copy->set_sample_format(SampleFormat::Float32);
+    return TrackSnapshot{ std::vector<float>(copy->get_waveform().begin(), copy->get_waveform().end()),
+                          track.get_analysis() };
+}
+
+// Converts restored to float32; its overview must have been rebuilt too
+bool restored_identical(const TrackSnapshot& before, AudioTrack& restored) {
+    restored.set_sample_format(SampleFormat::Float32);
+    const TrackAnalysis& after = restored.get_analysis();
+    return restored.get_waveform_size() == before.samples.size() &&
+           std::equal(before.samples.begin(), before.samples.end(), restored.get_waveform().begin()) &&
+           after.camelot_number == before.analysis.camelot_number && after.rms == before.analysis.rms &&
+           after.energy_profile == before.analysis.energy_profile && restored.get_overview() != nullptr;
+}
+
+void benchmark_spill_tier() {
+    std::cout << "\n======== SPILL TIER BENCHMARK ========" << std::endl;
+
+    std::string wav = (std::filesystem::temp_directory_path() / "dj_bench_spill.wav").string();
+    std::string segment = (std::filesystem::temp_directory_path() / "dj_bench_spill.seg").string();
+    write_wav_fixture(wav, 16, false, 180 * 44100);
+    WAVTrack source("Spill", {"Bench"}, 180, 128, 44100, 16);
+    source.set_file_path(wav);
+    source.set_id(0);
+
+    SpillStore spill;
+    if (!spill.open(segment)) {
+        std::cout << spill.get_error() << std::endl;
+        return;
+    }
+    ColdTrackStore cold(0);  // no memory tier: evictions go straight to disk
+    cold.set_spill_target(&spill);
+
+    // cold load, as on a miss: clone + decode + analyze
+    auto started = std::chrono::steady_clock::now();
+    PointerWrapper<AudioTrack> track = source.clone();
+    track->load();
+    track->analyze_beatgrid();
+    track->set_sample_format(SampleFormat::Int16);
+    double cold_load = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    const TrackSnapshot before = snapshot(*track);
+
+    const int rounds = 10;
+    double demote = 0.0, reload = 0.0;
+    for (int r = 0; r < rounds; ++r) {
+        started = std::chrono::steady_clock::now();
+        cold.put(std::move(track));
+        demote += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        started = std::chrono::steady_clock::now();
+        track = spill.take(0, source);
+        track->ensure_analyzed();
+        track->set_sample_format(SampleFormat::Int16);
+        reload += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+    demote /= rounds;
+    reload /= rounds;
+
+    bool same = restored_identical(before, *track);
+    std::cout << "cold load " << cold_load * 1000.0 << " ms, reload from disk " << reload * 1000.0 << " ms ("
+              << cold_load / reload << "x), spill " << demote * 1000.0 << " ms; restored track "
+              << (same ? "identical" : "DIFFERS") << std::endl;
+
+    // churn: many tracks spilled and reloaded, so dead records pile up and compaction runs
+    const TrackId tracks = 16;
+    const int cycles = 200;
+    for (TrackId id = 1; id <= tracks; ++id) {
+        PointerWrapper<AudioTrack> copy = track->clone();
+        copy->set_id(id);
+        cold.put(std::move(copy));
+    }
+    size_t peak = 0;
+    started = std::chrono::steady_clock::now();
+    for (int c = 0; c < cycles; ++c) {
+        PointerWrapper<AudioTrack> copy = spill.take(1 + (c * 7) % tracks, source);
+        copy->set_id(1 + (c * 7) % tracks);
+        cold.put(std::move(copy));
+        peak = std::max(peak, spill.segment_bytes());
+    }
+    spill.flush();
+    double churn = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cout << cycles << " reload/spill cycles over " << tracks << " tracks: " << churn / cycles * 1e6
+              << " us each, " << spill.compactions() << " background compactions, segment peak "
+              << peak / 1024 << " KiB, now " << spill.segment_bytes() / 1024 << " KiB for "
+              << spill.live_bytes() / 1024 << " KiB live" << std::endl;
+    spill.close();
+    std::remove(wav.c_str());
+}
+
+bool check_spill_round_trip() {
+    std::string wav = (std::filesystem::temp_directory_path() / "dj_check_spill.wav").string();
+    std::string segment = (std::filesystem::temp_directory_path() / "dj_check_spill.seg").string();
+    write_wav_fixture(wav, 16, false, 20 * 44100);
+    MutedOutput mute;
+    WAVTrack source("Spill", {"Check"}, 20, 128, 44100, 16);
+    source.set_file_path(wav);
+    source.set_id(0);
+
+    SpillStore spill;
+    if (!spill.open(segment)) {
+        mute.restore();
+        std::cout << "[Check] spill tier: " << spill.get_error() << ": FAIL" << std::endl;
+        std::remove(wav.c_str());
+        return false;
+    }
+    ColdTrackStore cold(0);
+    cold.set_spill_target(&spill);
+
+    PointerWrapper<AudioTrack> track = source.clone();
+    track->load();
+    track->analyze_beatgrid();
+    track->set_sample_format(SampleFormat::Int16);
+    const TrackSnapshot before = snapshot(*track);
+
+    // spill and reload tracks until dead records force compactions, then restore every one
+    const TrackId tracks = 8;
+    for (TrackId id = 1; id <= tracks; ++id) {
+        PointerWrapper<AudioTrack> copy = track->clone();
+        copy->set_id(id);
+        cold.put(std::move(copy));
+    }
+    for (int c = 0; c < 100; ++c) {
+        const TrackId id = static_cast<TrackId>(1 + (c * 3) % tracks);
+        PointerWrapper<AudioTrack> copy = spill.take(id, source);
+        copy->set_id(id);
+        cold.put(std::move(copy));
+    }
+    spill.flush();
+    size_t restored = 0;
+    for (TrackId id = 1; id <= tracks; ++id) {
+        PointerWrapper<AudioTrack> copy = spill.take(id, source);
+        if (copy) {
+            copy->ensure_analyzed();
+            restored += restored_identical(before, *copy);
+        }
+    }
+    const size_t compactions = spill.compactions();
+    spill.close();
+    std::remove(wav.c_str());
+    mute.restore();
+
+    std::cout << "[Check] spill tier: " << restored << "/" << tracks << " tracks identical after 100 reload/spill"
+              << " cycles (" << compactions << " compactions): " << (restored == tracks ? "PASS" : "FAIL") << std::endl;
+    return restored == tracks;
+}
+
+void benchmark_cache_admission() {
+    std::cout << "\n======== CACHE ADMISSION BENCHMARK ========" << std::endl;
+
+    // synthetic request streams over a 1000-track library with a 50-track cache
+    const size_t library_size = 1000;
+    const size_t cache_size = 50;
+    const size_t requests = 20000;
+    struct Workload { const char* name; double skew; size_t scan_every; };
+    const Workload workloads[] = { {"zipf 0.8", 0.8, 0}, {"zipf 1.0", 1.0, 0},
+                                   {"zipf 1.0 + one-off playlists", 1.0, 1000} };
+
+    std::ostringstream report;
+    MutedOutput mute;
+    std::vector<PointerWrapper<AudioTrack>> library = make_metadata_library(library_size + requests);
+    for (const Workload& workload : workloads) {
+        ZipfSampler zipf(library_size, workload.skew);
+        std::mt19937 rng(42);
+        std::vector<TrackId> stream;
+        TrackId next_one_off = static_cast<TrackId>(library_size);
+        while (stream.size() < requests) {
+            if (workload.scan_every > 0 && stream.size() % workload.scan_every == 0) {
+                // a long playlist of tracks played once and never again
+                for (size_t s = 0; s < 2 * cache_size && stream.size() < requests; ++s) {
+                    stream.push_back(next_one_off++);
+                }
+            }
+            stream.push_back(zipf(rng));
+        }
+
+        double ratio[2];
+        for (int tinylfu = 0; tinylfu < 2; ++tinylfu) {
+            DJControllerService controller(cache_size);
+            controller.set_admission_filter(tinylfu == 1);
+            size_t hits = 0;
+            for (TrackId id : stream) {
+                hits += controller.loadTrackToCache(*library[id]) == 1;
+            }
+            ratio[tinylfu] = 100.0 * hits / stream.size();
+        }
+        report << workload.name << ": LRU " << ratio[0] << "% hits, TinyLFU " << ratio[1] << "% hits\n";
+    }
+    mute.restore();
+    std::cout << report.str();
+}
+
+void benchmark_adaptive_cache() {
+    std::cout << "\n======== ADAPTIVE CACHE BENCHMARK ========" << std::endl;
+
+    // zipf 1.0 requests over 1000 metadata-only tracks; the adaptive cache starts at
+    // 8 slots, may grow to 256 and has a budget of 100 tracks of cached waveform
+    const size_t library_size = 1000;
+    const size_t requests = 20000;
+    std::ostringstream report;
+    MutedOutput mute;
+    std::vector<PointerWrapper<AudioTrack>> library = make_metadata_library(library_size);
+    const size_t track_bytes = library[0]->get_waveform_size() * SampleConverter::bytes_per_sample(SampleFormat::Int16);
+
+    ZipfSampler zipf(library_size, 1.0);
+    std::mt19937 rng(7);
+    std::vector<TrackId> stream(requests);
+    for (TrackId& id : stream) {
+        id = zipf(rng);
+    }
+
+    const char* names[] = { "fixed 8 slots", "adaptive" };
+    for (int adaptive = 0; adaptive < 2; ++adaptive) {
+        DJControllerService controller(8);
+        if (adaptive == 1) {
+            controller.set_adaptive_capacity(256, 100 * track_bytes);
+        }
+        size_t hits = 0;
+        for (TrackId id : stream) {
+            hits += controller.loadTrackToCache(*library[id]) == 1;
+        }
+        report << names[adaptive] << ": " << 100.0 * hits / requests << "% hits, ends at "
+               << controller.get_cache_size() << " slots, " << controller.get_cache_waveform_bytes() / 1024
+               << " KiB cached";
+        if (adaptive == 1) {
+            const AdaptiveCapacity& state = controller.get_adaptive_capacity();
+            report << " (grew " << state.grows << ", shrank " << state.shrinks << " times)";
+
+            // shrinking a full cache evicts in LRU order
+            auto started = std::chrono::steady_clock::now();
+            controller.set_cache_size(8);
+            double shrink = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+            report << "\nshrink to 8 slots: " << shrink * 1e6 << " us";
+        }
+        report << "\n";
+    }
+    mute.restore();
+    std::cout << report.str();
+}
+
+bool check_cache_shrink() {
+    // eight tracks touched in a known order, then the cache shrinks to three slots
+    MutedOutput mute;
+    std::vector<PointerWrapper<AudioTrack>> library = make_metadata_library(9);
+    LRUCache cache(8);
+    for (TrackId id = 0; id < 8; ++id) {
+        cache.put(std::move(library[id]));
+    }
+    const TrackId touched[] = { 3, 7, 0, 5, 1, 6, 2, 4 };  // least to most recently used
+    for (TrackId id : touched) {
+        cache.get(id);
+    }
+    const size_t evicted = cache.set_capacity(3);
+
+    // the three most recent survive, still in LRU order: the next put evicts 6
+    bool passed = evicted == 5 && cache.size() == 3 && cache.capacity() == 3 && cache.lru_id() == 6;
+    for (TrackId id = 0; id < 8; ++id) {
+        passed = passed && cache.contains(id) == (id == 6 || id == 2 || id == 4);
+    }
+    passed = passed && cache.put(std::move(library[8])) && !cache.contains(6) && cache.contains(8) &&
+             cache.lru_id() == 2;
+    mute.restore();
+
+    std::cout << "[Check] cache shrink: 8 tracks to 3 slots evicted " << evicted
+              << " in LRU order: " << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed;
+}
+
+void benchmark_cache_warm_up() {
+    std::cout << "\n======== CACHE WARM-UP BENCHMARK ========" << std::endl;
+
+    // eight one-minute WAV tracks, pre-loaded as a session start would from its access log
+    const size_t track_count = 8;
+    std::vector<std::string> paths;
+    std::vector<PointerWrapper<AudioTrack>> library;
+    std::vector<AudioTrack*> likely;
+    for (size_t i = 0; i < track_count; ++i) {
+        paths.push_back((std::filesystem::temp_directory_path() / ("dj_bench_warm_" + std::to_string(i) + ".wav")).string());
+        write_wav_fixture(paths.back(), 16, false, 60 * 44100);
+        WAVTrack* track = new WAVTrack("Warm " + std::to_string(i), {"Bench"}, 60, 128, 44100, 16);
+        track->set_file_path(paths.back());
+        track->set_id(static_cast<TrackId>(i));
+        library.emplace_back(track);
+        likely.push_back(track);
+    }
+
+    const unsigned thread_counts[] = { 1, 0 };
+    for (unsigned threads : thread_counts) {
+        DJControllerService controller(track_count);
+        WarmUpStats warm = controller.warm_cache(likely, threads);
+        size_t hits = 0;
+        for (AudioTrack* track : likely) {
+            hits += static_cast<bool>(controller.getTrackFromCache(track->get_id()));
+        }
+        std::cout << (threads == 1 ? "1 thread" : "all threads") << ": " << warm.tracks << " tracks warmed in "
+                  << warm.ms << " ms, first pass " << hits << "/" << track_count << " hits" << std::endl;
+    }
+    for (const std::string& path : paths) {
+        std::remove(path.c_str());
+    }
+}
+
+void benchmark_metrics() {
+    std::cout << "\n======== METRICS BENCHMARK ========" << std::endl;
+
+    // cost of one update, from the instrumented thread's side
+    const size_t updates = 1000000;
+    MetricsRegistry registry;
+    Counter& counter = registry.counter("bench_events_total", "Benchmark events");
+    Histogram& histogram = registry.histogram("bench_seconds", "Benchmark durations");
+    auto started = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < updates; ++i) {
+        counter.inc();
+    }
+    double counter_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+    started = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < updates; ++i) {
+        histogram.observe(static_cast<double>(i % 1000) * 1e-5);
+    }
+    double histogram_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+    std::cout << "counter inc: " << counter_ns / updates << " ns, histogram observe: " << histogram_ns / updates
+              << " ns" << std::endl;
+
+    // the same lookups with metrics off, then published and exported every 5 ms
+    const size_t library_size = 200;
+    const size_t requests = 20000;
+    const std::string path = (std::filesystem::temp_directory_path() / "dj_bench_metrics.prom").string();
+    std::ostringstream report;
+    MutedOutput mute;
+    std::vector<PointerWrapper<AudioTrack>> library = make_metadata_library(library_size);
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<size_t> pick(0, library_size - 1);
+    std::vector<TrackId> stream(requests);
+    for (TrackId& id : stream) {
+        id = static_cast<TrackId>(pick(rng));
+    }
+
+    for (int exported = 0; exported < 2; ++exported) {
+        MetricsRegistry session_metrics;
+        MetricsExporter exporter(session_metrics);
+        DJControllerService controller(50);
+        controller.set_cold_cache_size(50);
+        if (exported == 1) {
+            controller.set_metrics(&session_metrics);
+            exporter.start(path, 5);
+        }
+        started = std::chrono::steady_clock::now();
+        for (TrackId id : stream) {
+            controller.loadTrackToCache(*library[id]);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        report << (exported == 1 ? "metrics + export every 5 ms" : "metrics off") << ": " << requests
+               << " lookups in " << ms << " ms";
+        if (exported == 1) {
+            exporter.stop();
+            started = std::chrono::steady_clock::now();
+            const std::string text = session_metrics.render();
+            double render_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started).count();
+            report << " (" << exporter.writes() << " exports; one render: " << text.size() << " bytes in "
+                   << render_us << " us)";
+        }
+        report << "\n";
+    }
+    std::remove(path.c_str());
+    mute.restore();
+    std::cout << report.str();
+}
+
+void benchmark_tracing() {
+    std::cout << "\n======== TRACING BENCHMARK ========" << std::endl;
+
+    // a span with a track title as its detail, as the services record them;
+    // tracing stays enabled after this, so it runs last
+    const size_t spans = 200000;
+    const std::string title = "Benchmark Track";
+    double ns[2];
+    for (int enabled = 0; enabled < 2; ++enabled) {
+        if (enabled == 1) {
+            Tracer::enable();
+        }
+        auto started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < spans; ++i) {
+            TraceSpan span("bench", title);
+        }
+        ns[enabled] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+    }
+    std::cout << "span disabled: " << ns[0] / spans << " ns, enabled: " << ns[1] / spans << " ns" << std::endl;
+
+    const std::string path = (std::filesystem::temp_directory_path() / "dj_bench_trace.json").string();
+    auto started = std::chrono::steady_clock::now();
+    Tracer::dump(path);
+    double dump_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    std::cout << "dump of " << Tracer::span_count() << " spans: " << dump_ms << " ms, "
+              << std::filesystem::file_size(path) / 1024 << " KiB" << std::endl;
+    std::remove(path.c_str());
+}
+
+bool check_sample_formats() {
+    const std::vector<float> reference = make_chord_fixture();
+    std::vector<int16_t> packed(reference.size());
+    std::vector<float> restored(reference.size());
+    SampleConverter::to_int16(reference.data(), packed.data(), reference.size());
+    SampleConverter::to_float(packed.data(), restored.data(), reference.size());
+
+    const FormatComparison comparison = compare_formats(reference, restored);
+    std::cout << "[Check] sample formats: key " << comparison.from_float.camelot_number
+              << comparison.from_float.camelot_letter << " / " << comparison.from_int16.camelot_number
+              << comparison.from_int16.camelot_letter << ", energy blocks " << comparison.from_float.energy_profile.size()
+              << " / " << comparison.from_int16.energy_profile.size() << ", max energy block difference "
+              << comparison.energy_error << " (limit " << FORMAT_ENERGY_TOLERANCE << "), rms difference "
+              << comparison.rms_error << " (limit " << FORMAT_RMS_TOLERANCE << "): "
+              << (comparison.passed() ? "PASS" : "FAIL") << std::endl;
+    return comparison.passed();
+}
+
+} // namespace
+
+void run_benchmarks() {
+    benchmark_time_stretch();
+    benchmark_crossfade();
+    benchmark_deck_mixer();
+    benchmark_wav_reader();
+    benchmark_mp3_scanner();
+    benchmark_mp3_decoder();
+    benchmark_seek_index();
+    benchmark_waveform_overview();
+    benchmark_bpm_index();
+    benchmark_playlist_optimizer();
+    benchmark_sample_formats();
+    benchmark_cold_tier();
+    benchmark_spill_tier();
+    benchmark_cache_admission();
+    benchmark_adaptive_cache();
+    benchmark_cache_warm_up();
+    benchmark_metrics();
+    benchmark_tracing();
+}
+
+bool run_checks() {
+    // every check runs, so one failure does not hide another
+    bool passed = check_sample_formats();
+    passed = check_bpm_index() && passed;
+    passed = check_spill_round_trip() && passed;
+    passed = check_cache_shrink() && passed;
+    passed = check_mp3_decoder() && passed;
+    return passed;
+}
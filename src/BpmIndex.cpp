@@ -0,0 +1,108 @@
+#include "BpmIndex.h"
+#include <algorithm>
+
+namespace {
+
+bool indexable(int32_t bpm) {
+    return bpm >= BpmIndex::MIN_BPM && bpm <= BpmIndex::MAX_BPM;
+}
+
+} // namespace
+
+BpmIndex::BpmIndex() : min_bpm(0), skipped(0), offsets(), ids() {}
+
+void BpmIndex::build(const std::vector<int32_t>& bpms) {
+    offsets.clear();
+    ids.clear();
+    min_bpm = 0;
+    skipped = 0;
+
+    int32_t lowest = MAX_BPM;
+    int32_t highest = MIN_BPM;
+    for (int32_t bpm : bpms) {
+        if (indexable(bpm)) {
+            lowest = std::min(lowest, bpm);
+            highest = std::max(highest, bpm);
+        } else {
+            ++skipped;
+        }
+    }
+    if (skipped == bpms.size()) {
+        return;
+    }
+    min_bpm = lowest;
+    const size_t buckets = static_cast<size_t>(highest - min_bpm) + 1;
+
+    // count per bucket, then prefix-sum into start offsets
+    offsets.assign(buckets + 1, 0);
+    for (int32_t bpm : bpms) {
+        if (indexable(bpm)) {
+            ++offsets[static_cast<size_t>(bpm - min_bpm) + 1];
+        }
+    }
+    for (size_t b = 1; b <= buckets; ++b) {
+        offsets[b] += offsets[b - 1];
+    }
+
+    // scatter ids into their buckets
+    ids.resize(bpms.size() - skipped);
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < bpms.size(); ++i) {
+        if (indexable(bpms[i])) {
+            ids[cursor[static_cast<size_t>(bpms[i] - min_bpm)]++] = static_cast<TrackId>(i);
+        }
+    }
+}
+
+BpmIndex::Range BpmIndex::query(int bpm, int tolerance) const {
+    const TrackId* base = ids.data();
+    Range empty_range = { base, base };
+    if (ids.empty() || tolerance < 0) {
+        return empty_range;
+    }
+
+    const long long buckets = static_cast<long long>(offsets.size()) - 1;
+    long long lo = static_cast<long long>(bpm) - tolerance - min_bpm;
+    long long hi = static_cast<long long>(bpm) + tolerance - min_bpm;
+    if (hi < 0 || lo >= buckets) {
+        return empty_range;
+    }
+    lo = std::max(lo, 0LL);
+    hi = std::min(hi, buckets - 1);
+
+    Range range = { base + offsets[static_cast<size_t>(lo)], base + offsets[static_cast<size_t>(hi) + 1] };
+    return range;
+}
+
+std::vector<TrackId> BpmIndex::findWithin(int bpm, int tolerance) const {
+    Range range = query(bpm, tolerance);
+    return std::vector<TrackId>(range.begin(), range.end());
+}
+
+TrackId BpmIndex::nearest(int bpm, int tolerance, const std::vector<double>& score, TrackId exclude) const {
+    if (query(bpm, tolerance).empty()) {
+        return INVALID_TRACK_ID;
+    }
+
+    // the window is not empty, so bpm - tolerance .. bpm + tolerance overlaps the buckets
+    const long long buckets = static_cast<long long>(offsets.size()) - 1;
+    const long long center = static_cast<long long>(bpm) - min_bpm;
+    TrackId best = INVALID_TRACK_ID;
+    for (long long diff = 0; diff <= tolerance && best == INVALID_TRACK_ID && (center - diff >= 0 || center + diff < buckets);
+         ++diff) {
+        const long long sides[] = { center - diff, center + diff };
+        for (size_t side = 0; side < (diff == 0 ? 1u : 2u); ++side) {
+            const long long b = sides[side];
+            if (b < 0 || b >= buckets) {
+                continue;
+            }
+            for (uint32_t slot = offsets[static_cast<size_t>(b)]; slot < offsets[static_cast<size_t>(b) + 1]; ++slot) {
+                const TrackId id = ids[slot];
+                if (id != exclude && (best == INVALID_TRACK_ID || score[id] > score[best])) {
+                    best = id;
+                }
+            }
+        }
+    }
+    return best;
+}
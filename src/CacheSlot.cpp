@@ -2,12 +2,14 @@
 
 CacheSlot::CacheSlot() : 
     track(nullptr), 
+    track_id(INVALID_TRACK_ID),
     last_access_time(0), 
     occupied(false){
 }
 
 void CacheSlot::store(PointerWrapper<AudioTrack> track_ptr, uint64_t access_time) {
     track = std::move(track_ptr);
+    track_id = track->get_id();
     last_access_time = access_time;
     occupied = true;
 }
@@ -23,6 +25,13 @@ AudioTrack* CacheSlot::access(uint64_t access_time) {
 
 void CacheSlot::clear() {
     track.reset(nullptr);
+    track_id = INVALID_TRACK_ID;
     occupied = false;
     last_access_time = 0;
+}
+
+PointerWrapper<AudioTrack> CacheSlot::release() {
+    PointerWrapper<AudioTrack> released = std::move(track);
+    clear();
+    return released;
 }
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "ColdTrackStore.h"
+#include "Lz4Block.h"
+#include "Tracer.h"
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// Scratch buffer for the transformed samples; compression runs on the
+// controller thread only, so one buffer per thread is enough.
+std::vector<unsigned char>& scratch(size_t bytes) {
+    thread_local std::vector<unsigned char> buffer;
+    if (buffer.size() < bytes) {
+        buffer.resize(bytes);
+    }
+    return buffer;
+}
+
+// Delta against the previous sample (modulo 2^bits, so it is exactly reversible)
+// and scatter the bytes of each difference into W planes of count bytes each.
+template <typename Word>
+void split_planes(const unsigned char* in, size_t count, unsigned char* out) {
+    constexpr size_t W = sizeof(Word);
+    Word previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Word value;
+        std::memcpy(&value, in + i * W, W);
+        const Word delta = static_cast<Word>(value - previous);
+        previous = value;
+        for (size_t b = 0; b < W; ++b) {
+            out[b * count + i] = static_cast<unsigned char>(delta >> (8 * b));
+        }
+    }
+}
+
+template <typename Word>
+void join_planes(const unsigned char* in, size_t count, unsigned char* out) {
+    constexpr size_t W = sizeof(Word);
+    Word previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Word delta = 0;
+        for (size_t b = 0; b < W; ++b) {
+            delta = static_cast<Word>(delta | (static_cast<Word>(in[b * count + i]) << (8 * b)));
+        }
+        previous = static_cast<Word>(previous + delta);
+        std::memcpy(out + i * W, &previous, W);
+    }
+}
+
+} // namespace
+
+ColdTrackStore::ColdTrackStore(size_t capacity)
+    : entries(), max_size(capacity), store_counter(0), spill_target(nullptr) {}
+
+bool ColdTrackStore::put(PointerWrapper<AudioTrack> track) {
+    if (!track || (max_size == 0 && spill_target == nullptr)) {
+        return false;
+    }
+    const TrackId id = track->get_id();
+    const size_t existing = find(id);
+    if (existing != entries.size()) {
+        entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(existing));
+    }
+    if (entries.size() >= max_size) {
+        drop_oldest();
+    }
+
+    Entry entry{PointerWrapper<AudioTrack>(), id, track->get_sample_format(), track->get_waveform_size(),
+                std::vector<unsigned char>(), ++store_counter};
+    compress(track->get_sample_data(), entry.samples, SampleConverter::bytes_per_sample(entry.format),
+             entry.compressed);
+    entry.compressed.shrink_to_fit();
+    track->release_waveform();
+    entry.track = std::move(track);
+    if (max_size == 0) {
+        spill(entry);
+        return true;
+    }
+    entries.push_back(std::move(entry));
+    return true;
+}
+
+PointerWrapper<AudioTrack> ColdTrackStore::take(TrackId track_id) {
+    const size_t idx = find(track_id);
+    if (idx == entries.size()) {
+        return PointerWrapper<AudioTrack>();
+    }
+    TraceSpan span("cold promote", entries[idx].track->get_title());
+    Entry entry = std::move(entries[idx]);
+    entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(idx));
+
+    void* samples = entry.track->allocate_waveform(entry.format, entry.samples);
+    if (!decompress(entry.compressed.data(), entry.compressed.size(), samples, entry.samples,
+                    SampleConverter::bytes_per_sample(entry.format))) {
+        return PointerWrapper<AudioTrack>();  // corrupt entry: treat as a miss
+    }
+    return std::move(entry.track);
+}
+
+size_t ColdTrackStore::compressed_bytes() const {
+    size_t bytes = 0;
+    for (const Entry& entry : entries) {
+        bytes += entry.compressed.size();
+    }
+    return bytes;
+}
+
+size_t ColdTrackStore::raw_bytes() const {
+    size_t bytes = 0;
+    for (const Entry& entry : entries) {
+        bytes += entry.samples * SampleConverter::bytes_per_sample(entry.format);
+    }
+    return bytes;
+}
+
+void ColdTrackStore::set_capacity(size_t capacity) {
+    max_size = capacity;
+    while (entries.size() > max_size) {
+        drop_oldest();
+    }
+}
+
+void ColdTrackStore::compress(const void* samples, size_t count, size_t bytes_per_sample,
+                              std::vector<unsigned char>& out) {
+    const size_t bytes = count * bytes_per_sample;
+    std::vector<unsigned char>& planes = scratch(bytes);
+    const unsigned char* in = static_cast<const unsigned char*>(samples);
+    if (bytes_per_sample == 2) {
+        split_planes<uint16_t>(in, count, planes.data());
+    } else {
+        split_planes<uint32_t>(in, count, planes.data());
+    }
+    Lz4Block::compress(planes.data(), bytes, out);
+}
+
+bool ColdTrackStore::decompress(const unsigned char* in, size_t size, void* samples, size_t count,
+                                size_t bytes_per_sample) {
+    const size_t bytes = count * bytes_per_sample;
+    std::vector<unsigned char>& planes = scratch(bytes);
+    if (!Lz4Block::decompress(in, size, planes.data(), bytes)) {
+        return false;
+    }
+    unsigned char* out = static_cast<unsigned char*>(samples);
+    if (bytes_per_sample == 2) {
+        join_planes<uint16_t>(planes.data(), count, out);
+    } else {
+        join_planes<uint32_t>(planes.data(), count, out);
+    }
+    return true;
+}
+
+size_t ColdTrackStore::find(TrackId track_id) const {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].track_id == track_id) return i;
+    }
+    return entries.size();
+}
+
+void ColdTrackStore::drop_oldest() {
+    if (entries.empty()) {
+        return;
+    }
+    size_t oldest = 0;
+    for (size_t i = 1; i < entries.size(); ++i) {
+        if (entries[i].stored_at < entries[oldest].stored_at) oldest = i;
+    }
+    spill(entries[oldest]);
+    entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(oldest));
+}
+
+void ColdTrackStore::spill(Entry& entry) {
+    if (spill_target != nullptr) {
+        spill_target->put(*entry.track, entry.format, entry.samples, entry.compressed);
+    }
+}
@@ -0,0 +1,107 @@
+#include "CrossfadeEngine.h"
+#include <algorithm>
+#include <cmath>
+
+CrossfadeEngine::CrossfadeEngine()
+    : crossfade_seconds(5), curve(Curve::EqualPower),
+      block_out(BLOCK_SIZE), block_in(BLOCK_SIZE), gain_out(BLOCK_SIZE), gain_in(BLOCK_SIZE),
+      output(), mixed_samples(0) {}
+
+CrossfadeEngine::Plan CrossfadeEngine::plan(const AudioTrack& outgoing, const AudioTrack& incoming,
+                                            double seconds) {
+    const TrackAnalysis& out_grid = outgoing.get_analysis();
+    const TrackAnalysis& in_grid = incoming.get_analysis();
+    const double rate = AudioAnalyzer::ANALYSIS_SAMPLE_RATE;
+
+    Plan result = Plan();
+    result.seconds = std::max(0.0, seconds);
+
+    // whole beats of the incoming tempo (after sync both decks share it)
+    double period = in_grid.beat_period_seconds > 0.0 ? in_grid.beat_period_seconds
+                                                       : out_grid.beat_period_seconds;
+    if (period > 0.0 && result.seconds > 0.0) {
+        result.beats = std::max(1, static_cast<int>(std::lround(result.seconds / period)));
+        result.seconds = result.beats * period;
+    }
+
+    // last outgoing beat that leaves room for the whole fade
+    double start = std::max(0.0, outgoing.get_duration() - result.seconds);
+    if (out_grid.beat_period_seconds > 0.0 && start > out_grid.first_beat_seconds) {
+        result.outgoing_beat = static_cast<int>(
+            std::floor((start - out_grid.first_beat_seconds) / out_grid.beat_period_seconds));
+        start = out_grid.first_beat_seconds + result.outgoing_beat * out_grid.beat_period_seconds;
+    }
+
+    result.outgoing_start = static_cast<size_t>(std::lround(start * rate));
+    result.incoming_start = static_cast<size_t>(std::lround(in_grid.first_beat_seconds * rate));
+    result.length = static_cast<size_t>(std::lround(result.seconds * rate));
+    return result;
+}
+
+CrossfadeEngine::Plan CrossfadeEngine::render(const AudioTrack& outgoing, const AudioTrack& incoming) {
+    Plan fade = plan(outgoing, incoming, crossfade_seconds);
+
+    const WaveformView source_out = outgoing.get_waveform();
+    const WaveformView source_in = incoming.get_waveform();
+
+    const size_t blocks = (fade.length + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    output.assign(blocks * BLOCK_SIZE, 0.0f);
+
+    for (size_t b = 0; b < blocks; ++b) {
+        const size_t position = b * BLOCK_SIZE;
+        const size_t count = std::min(BLOCK_SIZE, fade.length - position);
+        read_looped(source_out, fade.outgoing_start + position, block_out.data(), count);
+        read_looped(source_in, fade.incoming_start + position, block_in.data(), count);
+        fill_gains(curve, position, fade.length, gain_out.data(), gain_in.data(), count);
+        mix_block(block_out.data(), gain_out.data(), block_in.data(), gain_in.data(),
+                  output.data() + position, count);
+    }
+    mixed_samples += fade.length;
+    return fade;
+}
+
+void CrossfadeEngine::mix_block(const float* __restrict a, const float* __restrict gain_a,
+                                const float* __restrict b, const float* __restrict gain_b,
+                                float* __restrict out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = a[i] * gain_a[i] + b[i] * gain_b[i];
+    }
+}
+
+void CrossfadeEngine::fill_gains(Curve curve, size_t position, size_t length,
+                                 float* __restrict gain_out, float* __restrict gain_in, size_t count) {
+    const float step = length > 0 ? 1.0f / static_cast<float>(length) : 0.0f;
+    const float origin = static_cast<float>(position);
+    for (size_t i = 0; i < count; ++i) {
+        gain_in[i] = (origin + static_cast<float>(i)) * step;
+    }
+
+    if (curve == Curve::Linear) {
+        for (size_t i = 0; i < count; ++i) {
+            gain_out[i] = 1.0f - gain_in[i];
+        }
+    } else {
+        const float quarter_turn = 1.57079632679489661923f;
+        for (size_t i = 0; i < count; ++i) {
+            float phase = gain_in[i] * quarter_turn;
+            gain_out[i] = std::cos(phase);
+            gain_in[i] = std::sin(phase);
+        }
+    }
+}
+
+void CrossfadeEngine::read_looped(WaveformView source, size_t position, float* out, size_t count) {
+    if (source.empty()) {
+        std::fill(out, out + count, 0.0f);
+        return;
+    }
+    // convert whole runs up to the loop point instead of wrapping per sample
+    size_t index = position % source.size();
+    while (count > 0) {
+        size_t run = std::min(count, source.size() - index);
+        std::copy(source.data() + index, source.data() + index + run, out);
+        out += run;
+        count -= run;
+        index = 0;
+    }
+}
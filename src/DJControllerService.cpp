@@ -1,40 +1,319 @@
 #include "DJControllerService.h"
 #include "MP3Track.h"
 #include "WAVTrack.h"
+#include "ParallelFor.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
+
+namespace {
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// MemAvailable / MemTotal from /proc/meminfo; false where it cannot be read (not Linux).
+// MemAvailable counts reclaimable page cache, unlike MemFree (_SC_AVPHYS_PAGES), which
+// a warm page cache keeps low on a perfectly healthy host.
+bool available_memory_fraction(double& fraction) {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    double total = 0.0;
+    double available = -1.0;
+    while (std::getline(meminfo, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        double kib = 0.0;
+        if (!(fields >> key >> kib)) {
+            continue;
+        }
+        if (key == "MemTotal:") {
+            total = kib;
+        } else if (key == "MemAvailable:") {
+            available = kib;
+        }
+    }
+    if (total <= 0.0 || available < 0.0) {
+        return false;
+    }
+    fraction = available / total;
+    return true;
+}
+
+// Discards everything; stateless, so worker threads can write to it concurrently
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+} // namespace
 
 DJControllerService::DJControllerService(size_t cache_size)
-    : cache(cache_size) {}
+    : spill_tier(), cold_tier(0), cache(cache_size), cold_format(SampleFormat::Int16), tier_stats(),
+      admission_enabled(false), sketch(cache_size), bypass(), adaptive(), metrics_enabled(false), metrics() {
+    cache.set_eviction_target(&cold_tier);
+}
+
+bool DJControllerService::open_spill_file(const std::string& path) {
+    if (!spill_tier.open(path)) {
+        std::cout << "[WARNING] " << spill_tier.get_error() << "; disk tier disabled" << std::endl;
+        cold_tier.set_spill_target(nullptr);
+        return false;
+    }
+    cold_tier.set_spill_target(&spill_tier);
+    return true;
+}
 /**
  * TODO: Implement loadTrackToCache method
  */
 int DJControllerService::loadTrackToCache(AudioTrack& track) {
+    TraceSpan span("cache lookup", track.get_title());
+    int result = load_through_tiers(track);
+    if (adaptive.enabled) {
+        adapt(result == 1);
+    }
+    return result;
+}
+
+int DJControllerService::load_through_tiers(AudioTrack& track) {
+    const auto start = std::chrono::steady_clock::now();
+
     // check if track is already in cache
-    if (cache.contains(track.get_title())) {
-        cache.get(track.get_title());
+    TrackId id = track.get_id();
+    if (admission_enabled) {
+        sketch.increment(id);
+    }
+    if (cache.contains(id) || (bypass && bypass->get_id() == id)) {
+        cache.get(id);
+        const double ms = elapsed_ms(start);
+        tier_stats.hot_hits++;
+        tier_stats.hot_hit_ms += ms;
+        record_lookup(HOT, ms, 1);
         return 1; // return 1 for HIT
     }
+
+    // a track evicted earlier may still be in the cold tier, already analyzed
+    PointerWrapper<AudioTrack> promoted = cold_tier.take(id);
+    if (promoted) {
+        promoted->set_sample_format(cold_format);
+        int result = admit(std::move(promoted));
+        const double ms = elapsed_ms(start);
+        tier_stats.cold_hits++;
+        tier_stats.cold_hit_ms += ms;
+        record_lookup(COLD, ms, result);
+        return result;  // still a miss for the hot tier
+    }
+
+    // then on disk: analysis is restored from the record, only the overview is rebuilt
+    promoted = spill_tier.take(id, track);
+    if (promoted) {
+        promoted->ensure_analyzed();
+        promoted->set_sample_format(cold_format);
+        int result = admit(std::move(promoted));
+        const double ms = elapsed_ms(start);
+        tier_stats.disk_hits++;
+        tier_stats.disk_hit_ms += ms;
+        record_lookup(DISK, ms, result);
+        return result;
+    }
     
     // else, clone the track
+    TraceSpan span("cache clone", track.get_title());
+    const auto clone_start = std::chrono::steady_clock::now();
     PointerWrapper<AudioTrack> cloned = track.clone();
     if (!cloned) {
         return 0; // return 0 for MISS
     }
+    if (metrics_enabled) {
+        metrics.clone_seconds->observe(elapsed_ms(clone_start) / 1000.0);
+    }
     
     // use load() and analyze_beatgrid()
     cloned->load();
+    const auto analysis_start = std::chrono::steady_clock::now();
     cloned->analyze_beatgrid();
+    if (metrics_enabled) {
+        metrics.analysis_seconds->observe(elapsed_ms(analysis_start) / 1000.0);
+    }
+
+    // analysis is done: keep the cold copy compact
+    cloned->set_sample_format(cold_format);
     
     // move the cloned track to cache
-    bool evicted = cache.put(std::move(cloned));
+    int result = admit(std::move(cloned));
+    const double ms = elapsed_ms(start);
+    tier_stats.misses++;
+    tier_stats.miss_ms += ms;
+    record_lookup(MISS, ms, result);
     
     // return -1 if eviction, 0 if simple MISS
-    return evicted ? -1 : 0;
+    return result;
+}
+
+int DJControllerService::admit(PointerWrapper<AudioTrack> track) {
+    if (admission_enabled && cache.isFull()) {
+        TrackId victim = cache.lru_id();
+        if (sketch.estimate(track->get_id()) <= sketch.estimate(victim)) {
+            if (bypass) {
+                cold_tier.put(std::move(bypass));
+            }
+            bypass = std::move(track);
+            tier_stats.rejections++;
+            if (metrics_enabled) {
+                metrics.rejections->inc();
+            }
+            return 0;
+        }
+    }
+    return cache.put(std::move(track)) ? -1 : 0;
+}
+
+WarmUpStats DJControllerService::warm_cache(const std::vector<AudioTrack*>& tracks, unsigned threads) {
+    const auto start = std::chrono::steady_clock::now();
+    NullBuffer mute;
+    std::streambuf* console = std::cout.rdbuf(&mute);
+
+    std::vector<PointerWrapper<AudioTrack>> warm;
+    for (AudioTrack* track : tracks) {
+        if (warm.size() >= cache.capacity()) {
+            break;
+        }
+        bool duplicate = cache.contains(track->get_id());
+        for (const auto& chosen : warm) {
+            duplicate = duplicate || chosen->get_id() == track->get_id();
+        }
+        if (!duplicate) {
+            warm.push_back(track->clone());
+        }
+    }
+
+    // distinct tracks share no state, so load and analysis can run side by side
+    parallel_for(warm.size(), threads, [this, &warm](size_t i) {
+        TraceSpan span("warm-up clone", warm[i]->get_title());
+        warm[i]->load();
+        warm[i]->analyze_beatgrid();
+        warm[i]->set_sample_format(cold_format);
+    });
+    std::cout.rdbuf(console);
+
+    // least likely first, so the most likely track ends up most recently used
+    WarmUpStats result;
+    for (size_t i = warm.size(); i-- > 0;) {
+        bool evicted = cache.put(std::move(warm[i]));
+        if (evicted && metrics_enabled) {
+            metrics.evictions->inc();
+        }
+        result.tracks++;
+    }
+    result.ms = elapsed_ms(start);
+    return result;
+}
+
+void DJControllerService::set_admission_filter(bool enabled) {
+    admission_enabled = enabled;
+    sketch.resize(cache.capacity());
 }
 
 void DJControllerService::set_cache_size(size_t new_size) {
-    cache.set_capacity(new_size);
+    size_t evicted = cache.set_capacity(new_size);
+    sketch.resize(new_size);
+    if (metrics_enabled) {
+        metrics.evictions->inc(evicted);
+        metrics.capacity->set(static_cast<double>(new_size));
+    }
+}
+
+void DJControllerService::set_metrics(MetricsRegistry* registry) {
+    metrics_enabled = registry != nullptr;
+    metrics = Instruments();
+    if (!registry) {
+        return;
+    }
+    static const char* const tiers[] = {"hot", "cold", "disk", "miss"};
+    for (int tier = HOT; tier <= MISS; ++tier) {
+        const std::string label = std::string("tier=\"") + tiers[tier] + "\"";
+        metrics.lookups[tier] = &registry->counter(
+            "dj_cache_lookups_total", "Controller cache lookups by the tier that served them (miss = full load)",
+            label);
+        metrics.lookup_seconds[tier] = &registry->histogram(
+            "dj_cache_lookup_seconds", "Time to serve a controller cache lookup", label);
+        if (tier != MISS) {
+            metrics.resident_bytes[tier] = &registry->gauge(
+                "dj_cache_resident_bytes", "Bytes held by each cache tier (cold: compressed, disk: live records)",
+                label);
+            metrics.resident_tracks[tier] = &registry->gauge(
+                "dj_cache_resident_tracks", "Tracks held by each cache tier", label);
+        }
+    }
+    metrics.evictions = &registry->counter("dj_cache_evictions_total", "Tracks evicted from the hot tier");
+    metrics.rejections = &registry->counter(
+        "dj_cache_admission_rejections_total", "Misses the TinyLFU admission filter kept out of the hot tier");
+    metrics.capacity = &registry->gauge("dj_cache_capacity_tracks", "Slots of the hot tier");
+    metrics.clone_seconds = &registry->histogram(
+        "dj_track_clone_seconds", "Time to clone a track, by the stage that cloned it", "stage=\"cache\"");
+    metrics.analysis_seconds = &registry->histogram(
+        "dj_track_analysis_seconds", "Time in analyze_beatgrid(), by the stage that ran it", "stage=\"cache\"");
+    metrics.capacity->set(static_cast<double>(cache.capacity()));
+}
+
+void DJControllerService::record_lookup(Tier tier, double ms, int result) {
+    if (!metrics_enabled) {
+        return;
+    }
+    metrics.lookups[tier]->inc();
+    metrics.lookup_seconds[tier]->observe(ms / 1000.0);
+    if (result == -1) {
+        metrics.evictions->inc();
+    }
+    metrics.resident_bytes[HOT]->set(static_cast<double>(cache.waveform_bytes()));
+    metrics.resident_tracks[HOT]->set(static_cast<double>(cache.size()));
+    metrics.resident_bytes[COLD]->set(static_cast<double>(cold_tier.compressed_bytes()));
+    metrics.resident_tracks[COLD]->set(static_cast<double>(cold_tier.size()));
+    metrics.resident_bytes[DISK]->set(static_cast<double>(spill_tier.live_bytes()));
+    metrics.resident_tracks[DISK]->set(static_cast<double>(spill_tier.size()));
+}
+
+void DJControllerService::set_adaptive_capacity(size_t max_tracks, size_t budget_bytes) {
+    adaptive = AdaptiveCapacity();
+    adaptive.enabled = max_tracks > 0;
+    adaptive.max_tracks = max_tracks;
+    adaptive.budget_bytes = budget_bytes;
+}
+
+void DJControllerService::adapt(bool hit) {
+    adaptive.window_lookups++;
+    adaptive.window_misses += !hit;
+    if (adaptive.window_lookups < AdaptiveCapacity::WINDOW) {
+        return;
+    }
+    const double miss_rate = static_cast<double>(adaptive.window_misses) / adaptive.window_lookups;
+    adaptive.window_lookups = 0;
+    adaptive.window_misses = 0;
+
+    const size_t capacity = cache.capacity();
+    const size_t resident = cache.size();
+    const size_t bytes = cache.waveform_bytes();
+    const size_t per_track = resident > 0 ? bytes / resident : 0;
+    double available = 1.0;
+    const bool pressure = bytes > adaptive.budget_bytes ||
+                          (available_memory_fraction(available) && available < AdaptiveCapacity::LOW_MEMORY);
+
+    // never grow past what the budget holds at the current mean track size
+    const size_t fits = per_track > 0 ? adaptive.budget_bytes / per_track : adaptive.max_tracks;
+    const size_t target = std::min({adaptive.max_tracks, fits, capacity + std::max<size_t>(1, capacity / 4)});
+
+    if (pressure && capacity > adaptive.min_tracks) {
+        set_cache_size(capacity - 1);
+        adaptive.shrinks++;
+    } else if (!pressure && miss_rate >= AdaptiveCapacity::GROW_MISS_RATE && target > capacity) {
+        set_cache_size(target);
+        adaptive.grows++;
+    }
 }
 
 //implemented
@@ -47,6 +326,10 @@ void DJControllerService::displayCacheStatus() const {
 /**
  * TODO: Implement getTrackFromCache method
  */
-AudioTrack* DJControllerService::getTrackFromCache(const std::string& track_title) {
-    return cache.get(track_title);
+LRUCache::Pin DJControllerService::getTrackFromCache(TrackId track_id) {
+    LRUCache::Pin track = cache.get(track_id);
+    if (!track && bypass && bypass->get_id() == track_id) {
+        return LRUCache::Pin(bypass.get());
+    }
+    return track;
 }
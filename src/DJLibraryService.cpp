@@ -2,13 +2,16 @@
 #include "SessionFileParser.h"
 #include "MP3Track.h"
 #include "WAVTrack.h"
+#include "Tracer.h"
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <filesystem>
 
 
 DJLibraryService::DJLibraryService(const Playlist& playlist) 
-    : playlist(playlist) {}
+    : playlist(playlist), library(), catalog(), bpm_index(), title_ids(), title_artist_ids(), artist_ids(),
+      clone_seconds(nullptr), analysis_seconds(nullptr) {}
 
 DJLibraryService::~DJLibraryService() {
     for (AudioTrack* track : library) {
@@ -21,8 +24,13 @@ DJLibraryService::~DJLibraryService() {
  * @param library_tracks Vector of track info from config
  */
  void DJLibraryService::buildLibrary(const std::vector<SessionConfig::TrackInfo>& library_tracks) {
+    TraceSpan span("build library");
+    library.reserve(library.size() + library_tracks.size());
+    catalog.reserve(catalog.size() + library_tracks.size());
+
     for (const auto& track_info : library_tracks) {
         AudioTrack* track = nullptr;
+        TrackCatalog::Format format = TrackCatalog::Format::MP3;
         
         // extra_param1 = bitrate after research it's better to implement this way
         // the type safety is enforced when creating the actual AudioTrack objects
@@ -34,6 +42,7 @@ DJLibraryService::~DJLibraryService() {
                 track_info.bpm,
                 track_info.extra_param1  // bitrate
             );
+            static_cast<MP3Track*>(track)->set_file_path(track_info.path);
         } else if (track_info.type == "WAV") {
             // extra_param1 = sample_rate, extra_param2 = bit_depth
             track = new WAVTrack(
@@ -44,13 +53,39 @@ DJLibraryService::~DJLibraryService() {
                 track_info.extra_param1,  // sample_rate
                 track_info.extra_param2   // bit_depth
             );
+            static_cast<WAVTrack*>(track)->set_file_path(track_info.path);
+            format = TrackCatalog::Format::WAV;
         }
         
         if (track) {
+            // analyze once here so every playlist/cache/deck clone inherits the results
+            track->ensure_analyzed();
+
+            // ids are dense: a track's id is its position in the library
+            TrackId id = static_cast<TrackId>(library.size());
+            track->set_id(id);
+            title_ids.emplace(track->get_title(), id);
+            bool is_wav = format == TrackCatalog::Format::WAV;
+            catalog.append(format, track_info.bpm, track_info.duration_seconds,
+                           is_wav ? 0 : track_info.extra_param1,
+                           is_wav ? track_info.extra_param1 : 0,
+                           is_wav ? track_info.extra_param2 : 0,
+                           track->get_quality_score());
+            for (const std::string& artist : track->get_artists()) {
+                title_artist_ids.emplace(titleArtistKey(track->get_title(), artist), id);
+                artist_ids[artist].push_back(id);
+            }
             library.push_back(track);
         }
     }
     
+    bpm_index.build(catalog.getBpms());
+    if (bpm_index.unindexed() > 0) {
+        std::cout << "[WARNING] " << bpm_index.unindexed() << " tracks have a BPM outside "
+                  << BpmIndex::MIN_BPM << ".." << BpmIndex::MAX_BPM
+                  << " and cannot be suggested by tempo" << std::endl;
+    }
+
     std::cout << "[INFO] Track library built: " << library.size() 
  << " tracks loaded" << std::endl;
 }
@@ -85,17 +120,54 @@ Playlist& DJLibraryService::getPlaylist() {
 }
 
 /**
- * TODO: Implement findTrack method
+ * @brief Find a library track by id
  * 
- * HINT: Leverage Playlist's find_track method
+ * Ids are library positions, so this is a direct index rather than a playlist scan.
  */
-AudioTrack* DJLibraryService::findTrack(const std::string& track_title) {
-    return playlist.find_track(track_title);
+AudioTrack* DJLibraryService::findTrack(TrackId track_id) {
+    if (track_id >= library.size()) {
+        return nullptr;
+    }
+    return library[track_id];
+}
+
+AudioTrack* DJLibraryService::findTrack(const std::string& track_title, const std::string& artist) {
+    auto it = title_artist_ids.find(titleArtistKey(track_title, artist));
+    return it == title_artist_ids.end() ? nullptr : library[it->second];
+}
+
+std::vector<TrackId> DJLibraryService::findTracksByArtist(const std::string& artist) const {
+    auto it = artist_ids.find(artist);
+    return it == artist_ids.end() ? std::vector<TrackId>() : it->second;
+}
+
+std::string DJLibraryService::titleArtistKey(const std::string& track_title, const std::string& artist) {
+    // titles and artists come from single config lines, so '\n' cannot appear in either
+    std::string key;
+    key.reserve(track_title.size() + 1 + artist.size());
+    key += track_title;
+    key += '\n';
+    key += artist;
+    return key;
+}
+
+TrackId DJLibraryService::resolveTitle(const std::string& track_title) const {
+    auto it = title_ids.find(track_title);
+    return it == title_ids.end() ? INVALID_TRACK_ID : it->second;
+}
+
+const std::string& DJLibraryService::getTrackTitle(TrackId track_id) const {
+    static const std::string unknown;
+    if (track_id >= library.size()) {
+        return unknown;
+    }
+    return library[track_id]->get_title();
 }
 
 void DJLibraryService::loadPlaylistFromIndices(const std::string& playlist_name, 
     const std::vector<int>& track_indices) {
 std::cout << "[INFO] Loading playlist: " << playlist_name << std::endl;
+TraceSpan playlist_span("load playlist", playlist_name);
 
 // Clear old playlist data before loading new one
 playlist.clear();
@@ -109,17 +181,26 @@ for (int idx : track_indices) {
     }
 
     AudioTrack* og_track = library[idx - 1];
+    TraceSpan span("playlist clone", og_track->get_title());
 
     // clone the track
+    auto start = std::chrono::steady_clock::now();
     PointerWrapper<AudioTrack> cloned_track = og_track->clone();
     if (!cloned_track) {
         std::cerr << "[ERROR] Failed to clone track: " << og_track->get_title() << std::endl;
         continue;
     }
+    if (clone_seconds) {
+        clone_seconds->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
 
     // load and analyze the track
     cloned_track->load();
+    start = std::chrono::steady_clock::now();
     cloned_track->analyze_beatgrid();
+    if (analysis_seconds) {
+        analysis_seconds->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
 
     // Add to playlist (releases ownership to playlist)
     AudioTrack* track_ptr = cloned_track.release();
@@ -136,6 +217,7 @@ std::cout << "[INFO] Playlist loaded: " << playlist_name << " (" << playlist.get
 std::vector<std::string> DJLibraryService::getTrackTitles() const {
     std::vector<std::string> titles;
     std::vector<AudioTrack*> tracks = playlist.getTracks();
+    titles.reserve(tracks.size());
     
     for (AudioTrack* track : tracks) {
         if (track) {
@@ -144,4 +226,29 @@ std::vector<std::string> DJLibraryService::getTrackTitles() const {
     }
     
     return titles;
+}
+
+std::vector<TrackId> DJLibraryService::getTrackIds() const {
+    std::vector<TrackId> ids;
+    std::vector<AudioTrack*> tracks = playlist.getTracks();
+    ids.reserve(tracks.size());
+
+    for (AudioTrack* track : tracks) {
+        if (track) {
+            ids.push_back(track->get_id());
+        }
+    }
+
+    return ids;
+}
+
+void DJLibraryService::setMetrics(MetricsRegistry* registry) {
+    clone_seconds = nullptr;
+    analysis_seconds = nullptr;
+    if (registry) {
+        clone_seconds = &registry->histogram("dj_track_clone_seconds",
+                                             "Time to clone a track, by the stage that cloned it", "stage=\"playlist\"");
+        analysis_seconds = &registry->histogram("dj_track_analysis_seconds",
+                                                "Time in analyze_beatgrid(), by the stage that ran it", "stage=\"playlist\"");
+    }
 }
\ No newline at end of file
@@ -1,15 +1,19 @@
 
 #include "DJSession.h"
+#include "PlaylistOptimizer.h"
+#include "Tracer.h"
 #include <iostream>
 #include <algorithm>
 #include <sstream>
+#include <cstdlib>
 #include <dirent.h>
 
 // ========== CONSTRUCTORS & RULE OF 5 ==========
 
 
 DJSession::DJSession(const std::string& name, bool play_all)
-    : session_name(name), play_all(play_all) {
+    : session_name(name), metrics(), metrics_exporter(metrics), play_all(play_all), optimize_order(false),
+      suggest_next(false), access_log(), requested() {
     std::cout << "DJ Session System initialized: " << session_name << std::endl;
 }
 
@@ -36,10 +40,48 @@ bool DJSession::load_playlist(const std::string& playlist_name)  {
         return false;
     }
     
-    track_titles = library_service.getTrackTitles();
+    track_ids = library_service.getTrackIds();
+    if (optimize_order) {
+        optimize_track_order();
+    }
     return true;
 }
 
+void DJSession::optimize_track_order() {
+    if (track_ids.size() < 3) {
+        return;
+    }
+
+    std::vector<float> bpms;
+    std::vector<int> camelot;
+    std::vector<bool> minor;
+    bpms.reserve(track_ids.size());
+    camelot.reserve(track_ids.size());
+    minor.reserve(track_ids.size());
+    for (TrackId id : track_ids) {
+        const TrackAnalysis& analysis = library_service.findTrack(id)->get_analysis();
+        bpms.push_back(static_cast<float>(library_service.getCatalog().getBpms()[id]));
+        camelot.push_back(analysis.analyzed ? analysis.camelot_number : 0);
+        minor.push_back(analysis.key_minor);
+    }
+
+    PlaylistOptimizer optimizer(bpms, camelot, minor);
+    PlaylistOptimizer::Result result = optimizer.solve();
+
+    std::vector<TrackId> reordered;
+    reordered.reserve(track_ids.size());
+    for (size_t position : result.order) {
+        reordered.push_back(track_ids[position]);
+    }
+    track_ids.swap(reordered);
+
+    double saved = result.initial_cost > 0.0
+        ? 100.0 * (result.initial_cost - result.final_cost) / result.initial_cost : 0.0;
+    std::cout << "[Optimizer] Reordered " << track_ids.size() << " tracks: transition cost "
+              << result.initial_cost << " -> " << result.final_cost
+              << " (" << saved << "% lower) in " << result.solve_ms << " ms" << std::endl;
+}
+
 /**
  * TODO: Implement load_track_to_controller method
  * 
@@ -58,13 +100,14 @@ bool DJSession::load_playlist(const std::string& playlist_name)  {
  *    0: Cache MISS (or error)
  *   -1: Cache MISS with eviction
  * 
- * @param track_name: Name of track to load
+ * @param track_id: Library id of track to load
  * @return: Cache operation result code
 
  */
-int DJSession::load_track_to_controller(const std::string& track_name) {
-    // Find track in library using track name
-    AudioTrack* track = library_service.findTrack(track_name);
+int DJSession::load_track_to_controller(TrackId track_id) {
+    // Find track in library using track id; the title is only needed for logging
+    AudioTrack* track = library_service.findTrack(track_id);
+    const std::string& track_name = library_service.getTrackTitle(track_id);
 
     // Handle case when track is not found
     // Update error stats if track not found
@@ -79,6 +122,15 @@ int DJSession::load_track_to_controller(const std::string& track_name) {
 
     // Controller Loading (Delegate loading to controller_service than Pass track by reference to controller)
     int result = controller_service.loadTrackToCache(*track);
+    access_log.record(track_name);
+    if (requested.size() <= track_id) {
+        requested.resize(track_id + 1, false);
+    }
+    if (!requested[track_id]) {
+        requested[track_id] = true;
+        stats.first_requests++;
+        stats.first_request_hits += result == 1;
+    }
 
     // Return Values
     if (result == 1) {
@@ -96,13 +148,14 @@ int DJSession::load_track_to_controller(const std::string& track_name) {
 /**
  * TODO: Implement load_track_to_mixer_deck method
  * 
- * @param track_title: Title of track to load to mixer
+ * @param track_id: Library id of track to load to mixer
  * @return: Whether track was successfully loaded to a deck
  */
-bool DJSession::load_track_to_mixer_deck(const std::string& track_title) {
+bool DJSession::load_track_to_mixer_deck(TrackId track_id) {
+    const std::string& track_title = library_service.getTrackTitle(track_id);
     std::cout << "[System] Delegating track transfer to MixingEngineService for: " << track_title << std::endl;
      // get track from cache )
-     AudioTrack* cached_track = controller_service.getTrackFromCache(track_title);
+     LRUCache::Pin cached_track = controller_service.getTrackFromCache(track_id);
 
      //  if track not in cache
      if (!cached_track) {
@@ -122,12 +175,7 @@ bool DJSession::load_track_to_mixer_deck(const std::string& track_title) {
       }
       
       // update deck stats and load according to deck index
-      if (deck_idx == 0) {
-          stats.deck_loads_a++;
-      }
-      if (deck_idx == 1) {
-          stats.deck_loads_b++;
-      }
+      stats.deck_loads[static_cast<size_t>(deck_idx)]++;
      
      // count transition
      stats.transitions++;
@@ -136,6 +184,16 @@ bool DJSession::load_track_to_mixer_deck(const std::string& track_title) {
  }
  
 
+TrackId DJSession::suggest_next_track() const {
+    const AudioTrack* playing = mixing_service.getActiveTrack();
+    if (!playing) {
+        return INVALID_TRACK_ID;
+    }
+
+    return library_service.getBpmIndex().nearest(playing->get_bpm(), session_config.bpm_tolerance,
+                                                 library_service.getCatalog().getQualities(), playing->get_id());
+}
+
 /**
  * @brief Main simulation loop that orchestrates the DJ performance session.
  * @note Updates session statistics (stats) throughout processing
@@ -152,6 +210,9 @@ void DJSession::simulate_dj_performance() {
     
     // 2. Build track library from config
     library_service.buildLibrary(session_config.library_tracks);
+    if (!session_config.access_log_path.empty()) {
+        warm_up_from_access_log();
+    }
     
     // 3. Get available playlists from config
     if (session_config.playlists.empty()) {
@@ -215,24 +276,62 @@ void DJSession::simulate_dj_performance() {
         }
         
         // go over all tracks in playlist
-        for (const auto& track_name : track_titles) {
-            std::cout << "\n--- Processing: " << track_name << " ---" << std::endl;
+        for (TrackId track_id : track_ids) {
+            TraceSpan span("track", library_service.getTrackTitle(track_id));
+            std::cout << "\n--- Processing: " << library_service.getTrackTitle(track_id) << " ---" << std::endl;
             stats.tracks_processed++;
             
-            load_track_to_controller(track_name);
+            load_track_to_controller(track_id);
             
             // load track to mixer deck if failed, continue to next track
-            if (!load_track_to_mixer_deck(track_name)) {
+            if (!load_track_to_mixer_deck(track_id)) {
                 continue;
             }
             
             // display cache and deck status
             controller_service.displayCacheStatus();
             mixing_service.displayDeckStatus();
+
+            TrackId suggestion = suggest_next ? suggest_next_track() : INVALID_TRACK_ID;
+            if (suggestion != INVALID_TRACK_ID) {
+                std::cout << "[Suggest] Could follow within " << session_config.bpm_tolerance << " BPM: "
+                          << library_service.getTrackTitle(suggestion) << std::endl;
+            }
         }
         
         print_session_summary();
     }
+
+    if (!session_config.access_log_path.empty()) {
+        if (access_log.save(session_config.access_log_path)) {
+            std::cout << "[System] Access log saved to " << session_config.access_log_path << std::endl;
+        } else {
+            std::cout << "[WARNING] Cannot write access log " << session_config.access_log_path << std::endl;
+        }
+    }
+    if (metrics_exporter.running()) {
+        metrics_exporter.stop();
+        std::cout << "[System] Metrics written to " << metrics_exporter.get_path() << " ("
+                  << metrics_exporter.writes() << " exports)" << std::endl;
+    }
+}
+
+void DJSession::warm_up_from_access_log() {
+    const std::string& path = session_config.access_log_path;
+    if (!access_log.load(path)) {
+        std::cout << "[WARNING] Ignoring malformed access log " << path << std::endl;
+        return;
+    }
+    std::vector<AudioTrack*> likely;
+    for (const std::string& title : access_log.ranked(static_cast<size_t>(std::max(session_config.controller_cache_size, 0)))) {
+        TrackId id = library_service.resolveTitle(title);
+        if (id != INVALID_TRACK_ID) {
+            likely.push_back(library_service.findTrack(id));
+        }
+    }
+    stats.warm_up = controller_service.warm_cache(likely);
+    std::cout << "[System] Warm-up: " << stats.warm_up.tracks << " tracks from " << path << " in "
+              << stats.warm_up.ms << " ms" << std::endl;
 }
 
 
@@ -257,8 +356,29 @@ bool DJSession::load_configuration() {
     std::cout << "Cache Size: " << session_config.controller_cache_size << " slots" << std::endl;
     mixing_service.set_auto_sync(session_config.auto_sync);
     mixing_service.set_bpm_tolerance(session_config.bpm_tolerance);
+    mixing_service.set_crossfade_time(session_config.default_crossfade_time);
+    mixing_service.set_deck_count(static_cast<size_t>(std::max(session_config.deck_count, 0)));
+    stats.deck_loads.assign(mixing_service.get_deck_count(), 0);
     //update cache size in LRUCache
     controller_service.set_cache_size(session_config.controller_cache_size);
+    controller_service.set_cache_sample_format(session_config.cache_sample_format);
+    controller_service.set_cold_cache_size(static_cast<size_t>(std::max(session_config.cold_cache_size, 0)));
+    controller_service.set_admission_filter(session_config.cache_admission_tinylfu);
+    controller_service.set_adaptive_capacity(static_cast<size_t>(std::max(session_config.adaptive_cache_max, 0)),
+                                             static_cast<size_t>(std::max(session_config.cache_memory_budget_mb, 0))
+                                                 << 20);
+    if (!session_config.spill_path.empty()) {
+        controller_service.open_spill_file(session_config.spill_path);
+    }
+    if (!session_config.metrics_path.empty()) {
+        controller_service.set_metrics(&metrics);
+        library_service.setMetrics(&metrics);
+        mixing_service.set_metrics(&metrics);
+        if (!metrics_exporter.start(session_config.metrics_path,
+                                    static_cast<unsigned>(std::max(session_config.metrics_interval_ms, 1)))) {
+            std::cout << "[WARNING] Cannot write metrics to " << session_config.metrics_path << std::endl;
+        }
+    }
     return true;
 }
 
@@ -316,8 +436,54 @@ void DJSession::print_session_summary() const {
     std::cout << "Cache hits: " << stats.cache_hits << std::endl;
     std::cout << "Cache misses: " << stats.cache_misses << std::endl;
     std::cout << "Cache evictions: " << stats.cache_evictions << std::endl;
-    std::cout << "Deck A loads: " << stats.deck_loads_a << std::endl;
-    std::cout << "Deck B loads: " << stats.deck_loads_b << std::endl;
+    if (!session_config.access_log_path.empty()) {
+        std::cout << "First-request hits: " << stats.first_request_hits << "/" << stats.first_requests << " ("
+                  << (stats.first_requests > 0 ? 100.0 * stats.first_request_hits / stats.first_requests : 0.0)
+                  << "%), warm-up " << stats.warm_up.tracks << " tracks in " << stats.warm_up.ms << " ms"
+                  << std::endl;
+    }
+    if (session_config.cache_sample_format_set) {
+        std::cout << "Cached waveforms: " << controller_service.get_cache_waveform_bytes() << " bytes ("
+                  << SampleConverter::name(controller_service.get_cache_sample_format()) << ")" << std::endl;
+    }
+    const AdaptiveCapacity& adaptive = controller_service.get_adaptive_capacity();
+    if (adaptive.enabled) {
+        std::cout << "Adaptive cache: " << controller_service.get_cache_size() << " slots (bounds "
+                  << adaptive.min_tracks << ".." << adaptive.max_tracks << "), grew " << adaptive.grows
+                  << " and shrank " << adaptive.shrinks << " times" << std::endl;
+    }
+    if (controller_service.has_admission_filter()) {
+        std::cout << "Admission rejections (tinylfu): " << controller_service.get_tier_stats().rejections
+                  << std::endl;
+    }
+    const ColdTrackStore& cold = controller_service.get_cold_tier();
+    const SpillStore& spill = controller_service.get_spill_tier();
+    if (cold.enabled() || spill.is_open()) {
+        const CacheTierStats& tiers = controller_service.get_tier_stats();
+        const size_t lookups = tiers.lookups();
+        const size_t cold_lookups = lookups - tiers.hot_hits;
+        const size_t disk_lookups = cold_lookups - tiers.cold_hits;
+        auto ratio = [](size_t hits, size_t total) { return total > 0 ? 100.0 * hits / total : 0.0; };
+        auto mean = [](double total_ms, size_t count) { return count > 0 ? total_ms / count : 0.0; };
+        std::cout << "Hot tier: " << tiers.hot_hits << "/" << lookups << " hits ("
+                  << ratio(tiers.hot_hits, lookups) << "%), " << mean(tiers.hot_hit_ms, tiers.hot_hits)
+                  << " ms per hit" << std::endl;
+        std::cout << "Cold tier: " << tiers.cold_hits << "/" << cold_lookups << " hits ("
+                  << ratio(tiers.cold_hits, cold_lookups) << "%), " << mean(tiers.cold_hit_ms, tiers.cold_hits)
+                  << " ms per promotion, " << cold.size() << " tracks in " << cold.compressed_bytes() << "/"
+                  << cold.raw_bytes() << " bytes" << std::endl;
+        if (spill.is_open()) {
+            std::cout << "Disk tier: " << tiers.disk_hits << "/" << disk_lookups << " hits ("
+                      << ratio(tiers.disk_hits, disk_lookups) << "%), " << mean(tiers.disk_hit_ms, tiers.disk_hits)
+                      << " ms per promotion, " << spill.size() << " tracks in " << spill.live_bytes() << "/"
+                      << spill.segment_bytes() << " bytes, " << spill.compactions() << " compactions" << std::endl;
+        }
+        std::cout << "Full reloads: " << tiers.misses << ", " << mean(tiers.miss_ms, tiers.misses)
+                  << " ms per reload" << std::endl;
+    }
+    for (size_t i = 0; i < stats.deck_loads.size(); ++i) {
+        std::cout << "Deck " << static_cast<char>('A' + i) << " loads: " << stats.deck_loads[i] << std::endl;
+    }
     std::cout << "Transitions: " << stats.transitions << std::endl;
     std::cout << "Errors: " << stats.errors << std::endl;
     std::cout << "=== Session Complete ===" << std::endl;
@@ -0,0 +1,94 @@
+#include "DeckMixer.h"
+#include <algorithm>
+
+DeckMixer::DeckMixer(unsigned threads)
+    : workers(), mutex(), wake(), finished(), job(), generation(0), busy(0), stopping(false), next_chunk(0) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t) {
+        workers.emplace_back(&DeckMixer::run, this);
+    }
+}
+
+DeckMixer::~DeckMixer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void DeckMixer::mix(const float* const* decks, const float* gains, size_t deck_count, float* out, size_t count) {
+    if (workers.empty() || deck_count < PARALLEL_MIN_DECKS || count < PARALLEL_MIN_SAMPLES) {
+        mix_inline(decks, gains, deck_count, out, count);
+        return;
+    }
+
+    const Job posted = { decks, gains, deck_count, out, count };
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = posted;
+        next_chunk.store(0, std::memory_order_relaxed);
+        busy = workers.size();
+        ++generation;
+    }
+    wake.notify_all();
+    work(posted);
+
+    // the buffers belong to the caller: return only once no worker can touch them
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return busy == 0; });
+}
+
+void DeckMixer::mix_inline(const float* const* decks, const float* gains, size_t deck_count,
+                           float* out, size_t count) {
+    for (size_t begin = 0; begin < count; begin += CHUNK) {
+        mix_range(decks, gains, deck_count, out, begin, std::min(count, begin + CHUNK));
+    }
+}
+
+void DeckMixer::run() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+        if (stopping) {
+            return;
+        }
+        seen = generation;
+        const Job current = job;
+        lock.unlock();
+        work(current);
+        lock.lock();
+        if (--busy == 0) {
+            finished.notify_one();
+        }
+    }
+}
+
+void DeckMixer::work(const Job& current) {
+    const size_t chunks = (current.count + CHUNK - 1) / CHUNK;
+    for (size_t c = next_chunk++; c < chunks; c = next_chunk++) {
+        mix_range(current.decks, current.gains, current.deck_count, current.out, c * CHUNK,
+                  std::min(current.count, (c + 1) * CHUNK));
+    }
+}
+
+void DeckMixer::mix_range(const float* const* decks, const float* gains, size_t deck_count,
+                          float* out, size_t begin, size_t end) {
+    float* __restrict target = out + begin;
+    const size_t length = end - begin;
+    std::fill(target, target + length, 0.0f);
+    for (size_t d = 0; d < deck_count; ++d) {
+        const float* __restrict source = decks[d] + begin;
+        const float gain = gains[d];
+        for (size_t i = 0; i < length; ++i) {
+            target[i] += gain * source[i];
+        }
+    }
+}
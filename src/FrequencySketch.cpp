@@ -0,0 +1,65 @@
+#include "FrequencySketch.h"
+#include <algorithm>
+
+namespace {
+
+// Independent multiplicative hashes, one per row
+constexpr uint64_t ROW_SEEDS[FrequencySketch::DEPTH] = {
+    0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0xD6E8FEB86659FD93ull
+};
+
+} // namespace
+
+FrequencySketch::FrequencySketch(size_t expected_items)
+    : counters(), mask(0), additions(0), ages(0) {
+    resize(expected_items);
+}
+
+void FrequencySketch::resize(size_t expected_items) {
+    size_t width = 16;
+    while (width < expected_items) {
+        width <<= 1;
+    }
+    if (!counters.empty() && width == mask + 1) {
+        return;
+    }
+    mask = width - 1;
+    counters.assign(DEPTH * width, 0);
+    additions = 0;
+}
+
+size_t FrequencySketch::slot(uint32_t key, size_t row) const {
+    uint64_t h = (static_cast<uint64_t>(key) + 1) * ROW_SEEDS[row];
+    h ^= h >> 29;
+    return row * width() + (static_cast<size_t>(h >> 32) & mask);
+}
+
+void FrequencySketch::increment(uint32_t key) {
+    bool added = false;
+    for (size_t row = 0; row < DEPTH; ++row) {
+        uint8_t& counter = counters[slot(key, row)];
+        if (counter < MAX_COUNT) {
+            ++counter;
+            added = true;
+        }
+    }
+    if (added && ++additions >= sample_size()) {
+        age();
+    }
+}
+
+uint8_t FrequencySketch::estimate(uint32_t key) const {
+    uint8_t count = MAX_COUNT;
+    for (size_t row = 0; row < DEPTH; ++row) {
+        count = std::min(count, counters[slot(key, row)]);
+    }
+    return count;
+}
+
+void FrequencySketch::age() {
+    for (uint8_t& counter : counters) {
+        counter = static_cast<uint8_t>(counter >> 1);
+    }
+    additions /= 2;
+    ages++;
+}
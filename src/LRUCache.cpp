@@ -1,17 +1,28 @@
 #include "LRUCache.h"
+#include <algorithm>
 #include <iostream>
+#include <mutex>
 
 LRUCache::LRUCache(size_t capacity)
-    : slots(capacity), max_size(capacity), access_counter(0) {}
+    : slots(capacity), max_size(capacity), access_counter(0), eviction_target(nullptr), mutex() {}
 
-bool LRUCache::contains(const std::string& track_id) const {
+bool LRUCache::contains(TrackId track_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
     return findSlot(track_id) != max_size;
 }
 
-AudioTrack* LRUCache::get(const std::string& track_id) {
+LRUCache::Pin LRUCache::get(TrackId track_id) {
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        size_t idx = findSlot(track_id);
+        if (idx == max_size) return Pin();
+        slots[idx].access(++access_counter);
+    }
+    // shared_mutex cannot downgrade: relock shared and look again, a writer may have evicted it since
+    std::shared_lock<std::shared_mutex> lock(mutex);
     size_t idx = findSlot(track_id);
-    if (idx == max_size) return nullptr;
-    return slots[idx].access(++access_counter);
+    if (idx == max_size) return Pin();
+    return Pin(std::move(lock), slots[idx].getTrack());
 }
 
 /**
@@ -22,10 +33,10 @@ AudioTrack* LRUCache::get(const std::string& track_id) {
     if (!track) {
         return false;
     }
+    std::unique_lock<std::shared_mutex> lock(mutex);
     
     // case of existing track
-    std::string title = track->get_title();
-    size_t existing_idx = findSlot(title);
+    size_t existing_idx = findSlot(track->get_id());
     if (existing_idx != max_size) {
         slots[existing_idx].access(++access_counter);
         return false; 
@@ -35,8 +46,8 @@ AudioTrack* LRUCache::get(const std::string& track_id) {
     bool eviction_occurred = false;
     
     // check if cache is full and evict LRU if necessary
-    if (isFull()) {
-        evictLRU();
+    if (size_locked() >= max_size) {
+        evict_lru_locked();
         eviction_occurred = true;
     }
     
@@ -50,26 +61,67 @@ AudioTrack* LRUCache::get(const std::string& track_id) {
 }
 
 bool LRUCache::evictLRU() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    return evict_lru_locked();
+}
+
+bool LRUCache::evict_lru_locked() {
     size_t lru = findLRUSlot();
     if (lru == max_size || !slots[lru].isOccupied()) return false;
-    slots[lru].clear();
+    if (eviction_target != nullptr) {
+        eviction_target->put(slots[lru].release());
+    } else {
+        slots[lru].clear();
+    }
     return true;
 }
 
+TrackId LRUCache::lru_id() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    size_t lru = findLRUSlot();
+    return lru == max_size ? INVALID_TRACK_ID : slots[lru].getTrackId();
+}
+
 size_t LRUCache::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return size_locked();
+}
+
+size_t LRUCache::size_locked() const {
     size_t count = 0;
     for (const auto& slot : slots) if (slot.isOccupied()) ++count;
     return count;
 }
 
+size_t LRUCache::capacity() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return max_size;
+}
+
+bool LRUCache::isFull() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return size_locked() >= max_size;
+}
+
+size_t LRUCache::waveform_bytes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    size_t bytes = 0;
+    for (const auto& slot : slots) {
+        if (slot.isOccupied()) bytes += slot.getTrack()->get_waveform_bytes();
+    }
+    return bytes;
+}
+
 void LRUCache::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
     for (auto& slot : slots) {
         slot.clear();
     }
 }
 
 void LRUCache::displayStatus() const {
-    std::cout << "[LRUCache] Status: " << size() << "/" << max_size << " slots used\n";
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::cout << "[LRUCache] Status: " << size_locked() << "/" << max_size << " slots used\n";
     for (size_t i = 0; i < max_size; ++i) {
         if(slots[i].isOccupied()){
             std::cout << "  Slot " << i << ": " << slots[i].getTrack()->get_title()
@@ -80,9 +132,9 @@ void LRUCache::displayStatus() const {
     }
 }
 
-size_t LRUCache::findSlot(const std::string& track_id) const {
+size_t LRUCache::findSlot(TrackId track_id) const {
     for (size_t i = 0; i < max_size; ++i) {
-        if (slots[i].isOccupied() && slots[i].getTrack()->get_title() == track_id) return i;
+        if (slots[i].isOccupied() && slots[i].getTrackId() == track_id) return i;
     }
     return max_size;
 
@@ -116,11 +168,23 @@ size_t LRUCache::findEmptySlot() const {
     return max_size;
 }
 
-void LRUCache::set_capacity(size_t capacity){
+size_t LRUCache::set_capacity(size_t capacity){
+    std::unique_lock<std::shared_mutex> lock(mutex);
     if (max_size == capacity)
-        return;
-    //udpate max size
-    max_size = capacity;
-    //update the slots vector
+        return 0;
+
+    // shrink: evict true LRU first, then pack the survivors into the slots that remain
+    size_t evicted = 0;
+    while (size_locked() > capacity && evict_lru_locked()) {
+        ++evicted;
+    }
+    std::stable_partition(slots.begin(), slots.end(), [](const CacheSlot& slot) { return slot.isOccupied(); });
+
+    // grow: reserve geometrically so one-slot steps do not reallocate every time
+    if (capacity > slots.capacity()) {
+        slots.reserve(std::max(capacity, 2 * slots.capacity()));
+    }
     slots.resize(capacity);
+    max_size = capacity;
+    return evicted;
 }
\ No newline at end of file
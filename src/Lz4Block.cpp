@@ -0,0 +1,147 @@
+#include "Lz4Block.h"
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;  // the format ends every block with at least 5 literals
+constexpr size_t MATCH_FIND_LIMIT = 12;  // no match may start in the last 12 bytes
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 12;
+
+uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Lengths of 15 and more continue in extra bytes of 255 plus a final remainder.
+void write_length(std::vector<unsigned char>& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<unsigned char>(length));
+}
+
+bool read_length(const unsigned char* in, size_t size, size_t& pos, size_t& length) {
+    unsigned char byte;
+    do {
+        if (pos >= size) {
+            return false;
+        }
+        byte = in[pos++];
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+void write_sequence(std::vector<unsigned char>& out, const unsigned char* literals, size_t literal_length,
+                    size_t offset, size_t match_length) {
+    const size_t token = out.size();
+    out.push_back(static_cast<unsigned char>((literal_length < 15 ? literal_length : 15) << 4));
+    if (literal_length >= 15) {
+        write_length(out, literal_length - 15);
+    }
+    out.insert(out.end(), literals, literals + literal_length);
+    if (match_length == 0) {
+        return;  // last sequence: literals only
+    }
+    out.push_back(static_cast<unsigned char>(offset & 0xFF));
+    out.push_back(static_cast<unsigned char>(offset >> 8));
+    const size_t extra = match_length - MIN_MATCH;
+    out[token] = static_cast<unsigned char>(out[token] | (extra < 15 ? extra : 15));
+    if (extra >= 15) {
+        write_length(out, extra - 15);
+    }
+}
+
+} // namespace
+
+void Lz4Block::compress(const unsigned char* in, size_t size, std::vector<unsigned char>& out) {
+    out.clear();
+    out.reserve(size + size / 255 + 16);
+
+    size_t anchor = 0;
+    if (size > MATCH_FIND_LIMIT) {
+        std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+        const size_t match_limit = size - MATCH_FIND_LIMIT;
+        const size_t end_limit = size - LAST_LITERALS;
+
+        size_t pos = 0;
+        while (pos < match_limit) {
+            const uint32_t sequence = read32(in + pos);
+            const uint32_t h = hash(sequence);
+            const size_t candidate = table[h];
+            table[h] = static_cast<uint32_t>(pos);
+
+            if (candidate < pos && pos - candidate <= MAX_OFFSET && read32(in + candidate) == sequence) {
+                size_t length = MIN_MATCH;
+                while (pos + length < end_limit && in[candidate + length] == in[pos + length]) {
+                    ++length;
+                }
+                write_sequence(out, in + anchor, pos - anchor, pos - candidate, length);
+                pos += length;
+                anchor = pos;
+                if (pos < match_limit) {
+                    // keep the table warm across the match
+                    table[hash(read32(in + pos - 2))] = static_cast<uint32_t>(pos - 2);
+                }
+            } else {
+                ++pos;
+            }
+        }
+    }
+    write_sequence(out, in + anchor, size - anchor, 0, 0);
+}
+
+bool Lz4Block::decompress(const unsigned char* in, size_t size, unsigned char* out, size_t out_size) {
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < size) {
+        const unsigned char token = in[ip++];
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !read_length(in, size, ip, literal_length)) {
+            return false;
+        }
+        if (literal_length > size - ip || literal_length > out_size - op) {
+            return false;
+        }
+        std::memcpy(out + op, in + ip, literal_length);
+        ip += literal_length;
+        op += literal_length;
+        if (ip == size) {
+            break;  // last sequence has no match
+        }
+
+        if (size - ip < 2) {
+            return false;
+        }
+        const size_t offset = in[ip] | (static_cast<size_t>(in[ip + 1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            return false;
+        }
+        size_t match_length = token & 0x0F;
+        if (match_length == 15 && !read_length(in, size, ip, match_length)) {
+            return false;
+        }
+        match_length += MIN_MATCH;
+        if (match_length > out_size - op) {
+            return false;
+        }
+        // byte by byte: a match may overlap the bytes it is producing
+        const unsigned char* match = out + op - offset;
+        for (size_t i = 0; i < match_length; ++i) {
+            out[op + i] = match[i];
+        }
+        op += match_length;
+    }
+    return op == out_size;
+}
@@ -1,11 +1,16 @@
 #include "MP3Track.h"
+#include "Mp3Reader.h"
+#include "Mp3Decoder.h"
+#include "AudioAnalyzer.h"
+#include "Tracer.h"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 
 MP3Track::MP3Track(const std::string& title, const std::vector<std::string>& artists, 
                    int duration, int bpm, int bitrate, bool has_tags)
-    : AudioTrack(title, artists, duration, bpm), bitrate(bitrate), has_id3_tags(has_tags) {
+    : AudioTrack(title, artists, duration, bpm), bitrate(bitrate), has_id3_tags(has_tags),
+      file_path() {
 
     std::cout << "MP3Track created: " << bitrate << " kbps" << std::endl;
 }
@@ -13,22 +18,138 @@ MP3Track::MP3Track(const std::string& title, const std::vector<std::string>& art
 // ========== TODO: STUDENTS IMPLEMENT THESE VIRTUAL FUNCTIONS ==========
 
 void MP3Track::load() {
+    TraceSpan span("load", title);
 
     std::cout << "[MP3Track::load] Loading MP3: \"" << title
     << "\" at " << bitrate << " kbps...\n";
-    if (has_id3_tags) {
-        std::cout << "  → Processing ID3 metadata (artist info, album art, etc.)...\n";
+    if (!file_path.empty() && decode_file()) {
+        std::cout << "  → Load complete.\n";
+        return;
+    }
+    if (!has_seek_index()) {
+        build_estimated_index();
+    }
+    std::cout << (has_id3_tags ? "  → ID3 tags listed in config (no file to read them from).\n"
+                               : "  → No ID3 tags found.\n");
+    std::cout << "  → Seek index estimated from config bitrate; no frames decoded.\n";
+    std::cout << "  → Load complete.\n";
+}
+
+bool MP3Track::decode_file() {
+    Mp3Reader reader;
+    if (!reader.open(file_path)) {
+        std::cout << "  → [WARNING] " << reader.get_error() << "; using config metadata\n";
+        return false;
+    }
+
+    const Id3Tag& tag = reader.get_tag();
+    if (tag.present) {
+        std::cout << "  → ID3v2." << tag.version << " tag: \"" << tag.title << "\" by " << tag.artist;
+        if (!tag.album.empty()) {
+            std::cout << " (" << tag.album << ")";
+        }
+        if (!tag.bpm.empty()) {
+            std::cout << ", " << tag.bpm << " BPM";
+        }
+        std::cout << "\n";
     } else {
         std::cout << "  → No ID3 tags found.\n";
     }
-            
-    std::cout << "  → Decoding MP3 frames...\n";
-    std::cout << "  → Load complete.\n";
+
+    const Mp3FrameHeader& format = reader.get_format();
+    const bool decodable = Mp3Decoder::supports(format);
+    const size_t channels = static_cast<size_t>(format.channels);
+    const size_t factor = std::max<size_t>(1, static_cast<size_t>(
+        std::lround(format.sample_rate / AudioAnalyzer::ANALYSIS_SAMPLE_RATE)));
+
+    // one index entry per frame, unless an earlier load already built the index
+    SeekIndex* index = has_seek_index() ? nullptr : &navigation->index;
+    if (index) {
+        index->reset(format.sample_rate);
+    }
+
+    // frames are decoded one at a time into 1152-sample blocks; a deck could start on the first ones
+    Mp3Decoder decoder;
+    std::vector<float> block(static_cast<size_t>(Mp3Decoder::MAX_FRAME_SAMPLES) * 2);
+    std::vector<float> mono;
+    Mp3Frame frame;
+    size_t frames = 0;
+    size_t damaged = 0;
+    uint64_t kbps_total = 0;
+    uint64_t samples = 0;
+
+    // mono sum of each sample frame, averaged over `factor` frames per analysis sample
+    double sum = 0.0;
+    size_t summed = 0;
+    while (reader.next_frame(frame)) {
+        ++frames;
+        kbps_total += static_cast<uint64_t>(frame.header.bitrate_kbps);
+        samples += static_cast<uint64_t>(frame.header.samples);
+        if (index) {
+            index->add(frame.first_sample, frame.offset);
+        }
+        if (!decodable) {
+            continue;
+        }
+        if (!decoder.decode(frame, block.data())) {
+            ++damaged;
+        }
+        for (int f = 0; f < frame.header.samples; ++f) {
+            const float* pcm = block.data() + static_cast<size_t>(f) * channels;
+            for (size_t c = 0; c < channels; ++c) {
+                sum += pcm[c];
+            }
+            if (++summed == factor) {
+                mono.push_back(static_cast<float>(sum / static_cast<double>(factor * channels)));
+                sum = 0.0;
+                summed = 0;
+            }
+        }
+    }
+    if (summed > 0) {
+        mono.push_back(static_cast<float>(sum / static_cast<double>(summed * channels)));
+    }
+    if (index) {
+        index->finish(samples);
+    }
+    if (decodable) {
+        set_waveform(mono);
+    }
+
+    std::cout << "  → " << (decodable ? "Decoded " : "Scanned ") << frames << " frames (MPEG-" << (format.version == 10 ? "1" : format.version == 20 ? "2" : "2.5")
+              << " Layer " << std::string(format.layer, 'I') << ", " << format.sample_rate << "Hz, "
+              << (format.channels == 1 ? "mono" : "stereo") << ", "
+              << (reader.is_vbr() ? "VBR " : "CBR ") << (frames > 0 ? kbps_total / frames : 0) << " kbps"
+              << (reader.has_seek_table() ? ", Xing seek table" : "") << "), "
+              << (format.sample_rate > 0 ? static_cast<double>(samples) / format.sample_rate : 0.0) << "s\n";
+    if (!decodable) {
+        std::cout << "  → [WARNING] Only MPEG-1 Layer III is decoded; keeping the placeholder waveform\n";
+    } else if (damaged > 0) {
+        std::cout << "  → [WARNING] " << damaged << " frames could not be decoded and were replaced by silence\n";
+    }
+    return true;
+}
+
+void MP3Track::build_estimated_index() {
+    const int sample_rate = 44100;
+    const uint64_t frame_samples = 1152;
+    const uint64_t frames = static_cast<uint64_t>(duration_seconds) * sample_rate / frame_samples;
+    // frame length is 144 * bitrate / sample_rate bytes; padding slots keep the average exact
+    const uint64_t bytes_per_second = static_cast<uint64_t>(bitrate) * 1000 / 8;
+
+    SeekIndex& index = navigation->index;
+    index.reset(sample_rate);
+    for (uint64_t frame = 0; frame < frames; ++frame) {
+        index.add(frame * frame_samples, frame * frame_samples * bytes_per_second / sample_rate);
+    }
+    index.finish(frames * frame_samples);
 }
 
 void MP3Track::analyze_beatgrid() {
+    TraceSpan span("analyze", title);
 
     std::cout << "[MP3Track::analyze_beatgrid] Analyzing beat grid for: \"" << title << "\"\n";
+    ensure_analyzed();
     
     double beats = (duration_seconds / 60.0) * bpm;
     
@@ -0,0 +1,45 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() : bytes(nullptr), length(0), error() {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        error = "cannot stat " + path;
+        return false;
+    }
+    void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping keeps the file alive
+    if (mapped == MAP_FAILED) {
+        error = "cannot map " + path;
+        return false;
+    }
+    bytes = static_cast<unsigned char*>(mapped);
+    length = static_cast<size_t>(info.st_size);
+    madvise(bytes, length, MADV_SEQUENTIAL);
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes != nullptr) {
+        munmap(bytes, length);
+    }
+    bytes = nullptr;
+    length = 0;
+}
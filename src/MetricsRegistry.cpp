@@ -0,0 +1,243 @@
+#include "MetricsRegistry.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// {labels} or {labels,extra}, nothing if both are empty
+std::string braces(const std::string& labels, const std::string& extra = "") {
+    if (labels.empty() && extra.empty()) {
+        return "";
+    }
+    if (labels.empty() || extra.empty()) {
+        return "{" + labels + extra + "}";
+    }
+    return "{" + labels + "," + extra + "}";
+}
+
+// shortest round-trip form; the format spells infinities +Inf/-Inf and NaN NaN
+void write_value(std::ostream& out, double value) {
+    if (value != value) {
+        out << "NaN";
+    } else if (value == std::numeric_limits<double>::infinity()) {
+        out << "+Inf";
+    } else if (value == -std::numeric_limits<double>::infinity()) {
+        out << "-Inf";
+    } else {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.17g", value);
+        // prefer the short form when it reads back as the same value
+        char shorter[32];
+        std::snprintf(shorter, sizeof(shorter), "%.15g", value);
+        out << (std::stod(shorter) == value ? shorter : text);
+    }
+}
+
+// help text escapes backslash and newline
+std::string escape_help(const std::string& help) {
+    std::string escaped;
+    for (char c : help) {
+        if (c == '\\') {
+            escaped += "\\\\";
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace
+
+void Counter::write(std::ostream& out, const std::string& name, const std::string& labels) const {
+    out << name << braces(labels) << ' ' << value() << '\n';
+}
+
+void Gauge::write(std::ostream& out, const std::string& name, const std::string& labels) const {
+    out << name << braces(labels) << ' ';
+    write_value(out, value());
+    out << '\n';
+}
+
+Histogram::Histogram(const std::vector<double>& bounds)
+    : bounds(bounds), buckets(bounds.size() + 1), total(0.0) {}
+
+void Histogram::observe(double value) {
+    size_t bucket = 0;
+    while (bucket < bounds.size() && value > bounds[bucket]) {
+        ++bucket;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    double sum = total.load(std::memory_order_relaxed);
+    while (!total.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::count() const {
+    uint64_t observed = 0;
+    for (const auto& bucket : buckets) {
+        observed += bucket.load(std::memory_order_relaxed);
+    }
+    return observed;
+}
+
+void Histogram::write(std::ostream& out, const std::string& name, const std::string& labels) const {
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        std::ostringstream le;
+        if (i < bounds.size()) {
+            write_value(le, bounds[i]);
+        } else {
+            le << "+Inf";
+        }
+        out << name << "_bucket" << braces(labels, "le=\"" + le.str() + "\"") << ' ' << cumulative << '\n';
+    }
+    out << name << "_sum" << braces(labels) << ' ';
+    write_value(out, sum());
+    out << '\n';
+    out << name << "_count" << braces(labels) << ' ' << cumulative << '\n';
+}
+
+std::vector<double> Histogram::seconds() {
+    return {0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+            0.1, 0.25, 0.5, 1.0, 2.5};
+}
+
+MetricsRegistry::MetricsRegistry() : families(), mutex() {}
+
+MetricsRegistry::Family& MetricsRegistry::family_of(const std::string& name, const std::string& help,
+                                                    const char* type) {
+    for (Family& family : families) {
+        if (family.name == name) {
+            if (family.type != type) {
+                throw std::invalid_argument("metric " + name + " is a " + family.type + ", not a " + type);
+            }
+            return family;
+        }
+    }
+    families.push_back(Family{name, help, type, {}});
+    return families.back();
+}
+
+Metric* MetricsRegistry::find(Family& family, const std::string& labels) {
+    for (Series& series : family.series) {
+        if (series.labels == labels) {
+            return series.metric.get();
+        }
+    }
+    return nullptr;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Family& family = family_of(name, help, "counter");
+    Metric* metric = find(family, labels);
+    if (metric == nullptr) {
+        family.series.push_back(Series{labels, PointerWrapper<Metric>(new Counter())});
+        metric = family.series.back().metric.get();
+    }
+    return static_cast<Counter&>(*metric);
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Family& family = family_of(name, help, "gauge");
+    Metric* metric = find(family, labels);
+    if (metric == nullptr) {
+        family.series.push_back(Series{labels, PointerWrapper<Metric>(new Gauge())});
+        metric = family.series.back().metric.get();
+    }
+    return static_cast<Gauge&>(*metric);
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::string& labels,
+                                      const std::vector<double>& bounds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Family& family = family_of(name, help, "histogram");
+    Metric* metric = find(family, labels);
+    if (metric == nullptr) {
+        family.series.push_back(Series{labels, PointerWrapper<Metric>(new Histogram(bounds))});
+        metric = family.series.back().metric.get();
+    }
+    return static_cast<Histogram&>(*metric);
+}
+
+std::string MetricsRegistry::render() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream out;
+    for (const Family& family : families) {
+        out << "# HELP " << family.name << ' ' << escape_help(family.help) << '\n';
+        out << "# TYPE " << family.name << ' ' << family.type << '\n';
+        for (const Series& series : family.series) {
+            series.metric->write(out, family.name, series.labels);
+        }
+    }
+    return out.str();
+}
+
+bool MetricsRegistry::write_file(const std::string& path) const {
+    const std::string text = render();
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        if (!file || !(file << text) || !file.flush()) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+MetricsExporter::MetricsExporter(const MetricsRegistry& registry)
+    : registry(registry), path(), interval_ms(0), worker(), mutex(), wake(), stopping(false), write_count(0) {}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::start(const std::string& file_path, unsigned interval) {
+    stop();
+    if (!registry.write_file(file_path)) {
+        return false;
+    }
+    path = file_path;
+    interval_ms = interval > 0 ? interval : 1;
+    stopping = false;
+    write_count = 1;
+    worker = std::thread(&MetricsExporter::run, this);
+    return true;
+}
+
+void MetricsExporter::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+    // the thread may have written just before the last updates
+    if (registry.write_file(path)) {
+        write_count++;
+    }
+}
+
+void MetricsExporter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!wake.wait_for(lock, std::chrono::milliseconds(interval_ms), [this] { return stopping; })) {
+        lock.unlock();
+        if (registry.write_file(path)) {
+            write_count++;
+        }
+        lock.lock();
+    }
+}
@@ -1,16 +1,19 @@
 #include "MixingEngineService.h"
+#include "Tracer.h"
 #include <iostream>
 #include <memory>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 
 
 /**
  * TODO: Implement MixingEngineService constructor
  */
 MixingEngineService::MixingEngineService()
-    : decks(), active_deck(0), auto_sync(false), bpm_tolerance(0)
+    : decks(2, nullptr), last_used(2, 0), use_clock(0), active_deck(0), auto_sync(false),
+      bpm_tolerance(0), crossfade(), renderer(), clone_seconds(nullptr), analysis_seconds(nullptr)
 {
-    decks[0] = nullptr;
-    decks[1] = nullptr;
     std::cout << "[MixingEngineService] Initialized with 2 empty decks."  << std::endl;
 }
 
@@ -20,7 +23,21 @@ MixingEngineService::MixingEngineService()
  MixingEngineService::~MixingEngineService() {
     std::cout << "[MixingEngineService] Cleaning up decks..." << std::endl;
     
-    for (size_t i = 0; i < 2; ++i) {
+    if (renderer) {
+        // stopping the engine deletes the tracks it owns
+        renderer->stop();
+        const RenderEngine::Stats& stats = renderer->get_stats();
+        std::cout << "[Render] " << stats.callbacks << " callbacks of " << RenderEngine::BLOCK_SIZE
+                  << " samples, jitter mean " << stats.mean_jitter_us << " us / max "
+                  << stats.max_jitter_us << " us, longest render " << stats.max_render_us
+                  << " us, " << stats.deadline_misses << " deadline misses, "
+                  << stats.commands << " deck commands, up to " << stats.max_mixed_decks
+                  << " decks mixed per block" << std::endl;
+        renderer.reset();
+        std::fill(decks.begin(), decks.end(), nullptr);
+    }
+    
+    for (size_t i = 0; i < decks.size(); ++i) {
         if (decks[i] != nullptr) {
             delete decks[i];
             decks[i] = nullptr;
@@ -37,54 +54,85 @@ MixingEngineService::MixingEngineService()
  int MixingEngineService::loadTrackToDeck(const AudioTrack& track) {
     std::cout << "\n=== Loading Track to Deck ===" << std::endl;
     
+    TraceSpan span("deck clone", track.get_title());
+
     // clone track polymorphically using wrapper in PointerWrapper for safety
+    auto start = std::chrono::steady_clock::now();
     PointerWrapper<AudioTrack> cloned = track.clone();
     if (!cloned) {
         std::cerr << "[ERROR] Track: \"" << track.get_title() 
                   << "\" failed to clone" << std::endl;
         return -1;
     }
+    if (clone_seconds) {
+        clone_seconds->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    // cached copies may be stored compactly; decks work on float32
+    cloned->set_sample_format(SampleFormat::Float32);
     
     // identify target deck (the inactive one
     
-    size_t target;
-    bool is_first_track = (decks[0] == nullptr && decks[1] == nullptr);
-    
-    if (is_first_track) {
-        target = 0;
-    } else {
-        target = 1 - active_deck;
-    }
+    bool is_first_track = std::all_of(decks.begin(), decks.end(),
+                                      [](const AudioTrack* deck) { return deck == nullptr; });
+    size_t target = pick_target_deck(is_first_track);
     std::cout << "[Deck Switch] Target deck: " << target << std::endl;
     
     // unload target deck if occupied
     if (decks[target] != nullptr) {
-        delete decks[target];
-        decks[target] = nullptr;
+        unload_deck(target);
     }
     
     // preper track
     cloned->load();
+    start = std::chrono::steady_clock::now();
     cloned->analyze_beatgrid();
+    if (analysis_seconds) {
+        analysis_seconds->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
     
     // if there's an active deck and sync is enabled, check if the tracks can be mixed
     if (decks[active_deck] != nullptr && auto_sync) {
         if (!can_mix_tracks(cloned)) {
-            sync_bpm(cloned);
+            sync_bpm(*cloned);
         }
     }
     
     // assign the track to the deck
     decks[target] = cloned.release();
+    last_used[target] = ++use_clock;
     std::cout << "[Load Complete] '" << decks[target]->get_title() 
               << "' is now loaded on deck " << target << std::endl;
+    if (renderer) {
+        // the render thread owns the track from here; decks[] keeps a read-only view
+        renderer->load(target, decks[target]);
+    }
     
-    // unload the previous active deck (instant transition - only if not first track)
+    // crossfade out of the previous active deck, then unload it (only if not first track)
+    double fade_seconds = 0.0;
     if (!is_first_track && decks[active_deck] != nullptr) {
-        std::cout << "[Unload] Unloading previous deck " << active_deck 
-                  << " (" << decks[active_deck]->get_title() << ")" << std::endl;
-        delete decks[active_deck];
-        decks[active_deck] = nullptr;
+        if (crossfade.get_crossfade_time() > 0) {
+            TraceSpan fade_span("crossfade", track.get_title());
+            CrossfadeEngine::Plan fade = crossfade.render(*decks[active_deck], *decks[target]);
+            fade_seconds = fade.seconds;
+            std::cout << "[Crossfade] Deck " << active_deck << " -> deck " << target << ": "
+                      << fade.beats << " beats (" << fade.seconds << "s) from beat "
+                      << fade.outgoing_beat << ", " << fade.length << " samples in "
+                      << crossfade.get_output().size() / CrossfadeEngine::BLOCK_SIZE
+                      << " blocks" << std::endl;
+        }
+        if (renderer) {
+            // both decks are mixed while the render thread ramps their gains; the outgoing
+            // one stays loaded, silent, until the rotation reuses its deck
+            std::cout << "[Fade Out] Deck " << active_deck << " (" << decks[active_deck]->get_title()
+                      << ") fades out over " << fade_seconds << "s" << std::endl;
+        } else {
+            std::cout << "[Unload] Unloading previous deck " << active_deck 
+                      << " (" << decks[active_deck]->get_title() << ")" << std::endl;
+            unload_deck(active_deck);
+        }
+    }
+    if (renderer) {
+        renderer->set_active(target, fade_seconds);
     }
     
     // switch the active deck
@@ -94,12 +142,81 @@ MixingEngineService::MixingEngineService()
     return target;
 }
 
+void MixingEngineService::enable_render_thread() {
+    if (!renderer) {
+        renderer.reset(new RenderEngine());
+        for (size_t i = 0; i < decks.size(); ++i) {
+            if (decks[i] != nullptr) {
+                renderer->load(i, decks[i]);
+            }
+        }
+        renderer->set_active(active_deck);
+    }
+}
+
+void MixingEngineService::set_metrics(MetricsRegistry* registry) {
+    clone_seconds = nullptr;
+    analysis_seconds = nullptr;
+    if (registry) {
+        clone_seconds = &registry->histogram("dj_track_clone_seconds",
+                                             "Time to clone a track, by the stage that cloned it", "stage=\"deck\"");
+        analysis_seconds = &registry->histogram("dj_track_analysis_seconds",
+                                                "Time in analyze_beatgrid(), by the stage that ran it", "stage=\"deck\"");
+    }
+}
+
+void MixingEngineService::set_deck_count(size_t requested) {
+    const size_t count = std::max<size_t>(2, std::min(requested, RenderEngine::MAX_DECKS));
+    if (count != requested) {
+        std::cout << "[WARNING] deck_count " << requested << " is out of range (2.." << RenderEngine::MAX_DECKS
+                  << "); using " << count << std::endl;
+    }
+    if (count == decks.size()) {
+        return;
+    }
+    // only reconfigured between sessions: drop whatever is loaded
+    for (size_t i = 0; i < decks.size(); ++i) {
+        if (decks[i] != nullptr) {
+            unload_deck(i);
+        }
+    }
+    decks.assign(count, nullptr);
+    last_used.assign(count, 0);
+    active_deck = 0;
+    std::cout << "[MixingEngineService] Reconfigured with " << count << " empty decks." << std::endl;
+}
+
+size_t MixingEngineService::pick_target_deck(bool is_first_track) const {
+    // least recently loaded deck other than the one playing; ties go to the lowest index.
+    // With two decks this is plain alternation, starting on deck 0.
+    size_t best = decks.size();
+    for (size_t i = 0; i < decks.size(); ++i) {
+        if (!is_first_track && i == active_deck) {
+            continue;
+        }
+        if (best == decks.size() || last_used[i] < last_used[best]) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void MixingEngineService::unload_deck(size_t deck) {
+    if (renderer) {
+        // the render thread retires it; reclaim() deletes it off the audio path
+        renderer->unload(deck);
+    } else {
+        delete decks[deck];
+    }
+    decks[deck] = nullptr;
+}
+
 /**
  * @brief Display current deck status
  */
 void MixingEngineService::displayDeckStatus() const {
     std::cout << "\n=== Deck Status ===\n";
-    for (size_t i = 0; i < 2; ++i) {
+    for (size_t i = 0; i < decks.size(); ++i) {
         if (decks[i])
             std::cout << "Deck " << i << ": " << decks[i]->get_title() << "\n";
         else
@@ -139,25 +256,39 @@ bool MixingEngineService::can_mix_tracks(const PointerWrapper<AudioTrack>& track
     return diff <= bpm_tolerance;
 }
 
+double MixingEngineService::compatibility_score(const PointerWrapper<AudioTrack>& track) const {
+    if (decks[active_deck] == nullptr || !track) {
+        return 0.0;
+    }
+    return compatibility_score(*decks[active_deck], *track, bpm_tolerance);
+}
+
+double MixingEngineService::compatibility_score(const AudioTrack& a, const AudioTrack& b, int bpm_tolerance) {
+    const double span = 2.0 * std::max(bpm_tolerance, 1);
+    const double bpm_score = std::max(0.0, 1.0 - std::abs(a.get_bpm() - b.get_bpm()) / span);
+    const double key_score = AudioAnalyzer::harmonic_score(a.get_analysis(), b.get_analysis());
+    const double energy = AudioAnalyzer::energy_score(a.get_analysis(), b.get_analysis());
+    return 0.5 * bpm_score + 0.3 * key_score + 0.2 * energy;
+}
+
 /**
  * TODO: Implement sync_bpm method
  * @param track: Track to synchronize with active deck
  */
- void MixingEngineService::sync_bpm(const PointerWrapper<AudioTrack>& track) const {
+ void MixingEngineService::sync_bpm(AudioTrack& track) const {
     // validity check
-    if (decks[active_deck] == nullptr || !track) {
+    if (decks[active_deck] == nullptr) {
         return;
     }
     
-    int original_bpm = track->get_bpm();
-    int active_bpm = decks[active_deck]->get_bpm();
+    int original_bpm = track.get_bpm();
     
-    // average
-    int average_bpm = (original_bpm + active_bpm) / 2;
+    // meet in the middle, at full precision (the active deck may itself be stretched)
+    double target_bpm = (track.get_exact_bpm() + decks[active_deck]->get_exact_bpm()) / 2.0;
     
-    // update new track's bpm
-    const_cast<AudioTrack*>(track.get())->set_bpm(average_bpm);
+    // stretch the new track's audio to the target tempo
+    track.time_stretch(target_bpm);
     
     std::cout << "[Sync BPM] Syncing BPM from " << original_bpm 
-              << " to " << average_bpm << std::endl;
+              << " to " << track.get_bpm() << std::endl;
 }
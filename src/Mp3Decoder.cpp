@@ -0,0 +1,680 @@
+#include "Mp3Decoder.h"
+#include "Mp3Tables.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+const int GRANULE_LINES = 576;
+const int SUBBANDS = 32;
+const int SUBBAND_LINES = 18;
+const int MAX_QUANTIZED = 15 + 8191;  // largest value with 13 linbits
+const float SQRT_HALF = 0.70710678f;
+
+// Huffman decoding tree: node n has children nodes[2n] (bit 0) and nodes[2n + 1] (bit 1);
+// a negative child is a leaf holding -(table entry + 1)
+struct HuffmanTree {
+    std::vector<int> nodes;
+
+    HuffmanTree() : nodes() {}
+
+    void build(const Mp3Tables::HuffmanTable& table, int entries) {
+        nodes.assign(2, 0);
+        for (int entry = 0; entry < entries; ++entry) {
+            const int length = table.lengths[entry];
+            int node = 0;
+            for (int bit = length - 1; bit > 0; --bit) {
+                const size_t slot = 2 * static_cast<size_t>(node) + ((table.codes[entry] >> bit) & 1);
+                if (nodes[slot] == 0) {
+                    nodes[slot] = static_cast<int>(nodes.size() / 2);
+                    nodes.resize(nodes.size() + 2, 0);
+                }
+                node = nodes[slot];
+            }
+            nodes[2 * static_cast<size_t>(node) + (table.codes[entry] & 1)] = -(entry + 1);
+        }
+    }
+};
+
+struct HuffmanTrees {
+    HuffmanTree big_values[32];
+    HuffmanTree count1[2];
+
+    HuffmanTrees() : big_values(), count1() {
+        for (int t = 0; t < 32; ++t) {
+            const Mp3Tables::HuffmanTable& table = Mp3Tables::big_values(t);
+            if (table.size > 0) {
+                big_values[t].build(table, table.size * table.size);
+            }
+        }
+        for (int t = 0; t < 2; ++t) {
+            count1[t].build(Mp3Tables::count1(t), 16);
+        }
+    }
+};
+
+const HuffmanTrees& huffman_trees() {
+    static const HuffmanTrees trees;
+    return trees;
+}
+
+// |v|^(4/3) for every quantized magnitude
+struct PowerTable {
+    float values[MAX_QUANTIZED + 1];
+
+    PowerTable() : values() {
+        for (int i = 0; i <= MAX_QUANTIZED; ++i) {
+            values[i] = static_cast<float>(std::pow(static_cast<double>(i), 4.0 / 3.0));
+        }
+    }
+};
+
+const float* power_table() {
+    static const PowerTable table;
+    return table.values;
+}
+
+// Cosine kernels and windows of the hybrid filterbank
+struct Transforms {
+    float long_kernel[36][18];   // cos(pi/72 (2i + 1 + 18)(2k + 1))
+    float short_kernel[12][6];   // cos(pi/24 (2i + 1 + 6)(2k + 1))
+    float windows[4][36];        // by block type; type 2 holds the 12-point short window
+    float matrix[32][32];        // cos(p (2k + 1) pi/64), p = 0..31
+    float alias_cs[8];
+    float alias_ca[8];
+    float intensity_left[7];     // tan(p pi/12) / (1 + tan), p = is_pos
+    float intensity_right[7];    // 1 / (1 + tan)
+
+    Transforms() : long_kernel(), short_kernel(), windows(), matrix(), alias_cs(), alias_ca(),
+                   intensity_left(), intensity_right() {
+        const double pi = M_PI;
+        for (int i = 0; i < 36; ++i) {
+            for (int k = 0; k < 18; ++k) {
+                long_kernel[i][k] = static_cast<float>(std::cos(pi / 72.0 * (2 * i + 1 + 18) * (2 * k + 1)));
+            }
+        }
+        for (int i = 0; i < 12; ++i) {
+            for (int k = 0; k < 6; ++k) {
+                short_kernel[i][k] = static_cast<float>(std::cos(pi / 24.0 * (2 * i + 1 + 6) * (2 * k + 1)));
+            }
+        }
+        for (int i = 0; i < 36; ++i) {
+            const float sine = static_cast<float>(std::sin(pi / 36.0 * (i + 0.5)));
+            windows[0][i] = sine;
+            windows[1][i] = i < 18 ? sine : i < 24 ? 1.0f
+                          : i < 30 ? static_cast<float>(std::sin(pi / 12.0 * (i - 18 + 0.5))) : 0.0f;
+            windows[3][i] = i < 6 ? 0.0f : i < 12 ? static_cast<float>(std::sin(pi / 12.0 * (i - 6 + 0.5)))
+                          : i < 18 ? 1.0f : sine;
+        }
+        for (int i = 0; i < 12; ++i) {
+            windows[2][i] = static_cast<float>(std::sin(pi / 12.0 * (i + 0.5)));
+        }
+        for (int p = 0; p < 32; ++p) {
+            for (int k = 0; k < 32; ++k) {
+                matrix[p][k] = static_cast<float>(std::cos(p * (2 * k + 1) * pi / 64.0));
+            }
+        }
+        for (int i = 0; i < 8; ++i) {
+            const double c = Mp3Tables::ALIAS_COEFFICIENTS[i];
+            alias_cs[i] = static_cast<float>(1.0 / std::sqrt(1.0 + c * c));
+            alias_ca[i] = static_cast<float>(c / std::sqrt(1.0 + c * c));
+        }
+        for (int p = 0; p < 6; ++p) {
+            const double ratio = std::tan(p * pi / 12.0);
+            intensity_left[p] = static_cast<float>(ratio / (1.0 + ratio));
+            intensity_right[p] = static_cast<float>(1.0 / (1.0 + ratio));
+        }
+        intensity_left[6] = 1.0f;
+        intensity_right[6] = 0.0f;
+    }
+};
+
+const Transforms& transforms() {
+    static const Transforms tables;
+    return tables;
+}
+
+bool is_short(bool window_switching, int block_type) {
+    return window_switching && block_type == 2;
+}
+
+} // namespace
+
+// MSB-first reader over main data or side info; reads past the end return zero bits
+class Mp3Decoder::BitReader {
+public:
+    BitReader(const unsigned char* data, size_t bytes) : data(data), bytes(bytes), position(0) {}
+
+    BitReader(const BitReader&) = delete;
+    BitReader& operator=(const BitReader&) = delete;
+
+    // count <= 24
+    uint32_t read(int count) {
+        if (count == 0) {
+            return 0;
+        }
+        const size_t byte = position >> 3;
+        uint32_t window = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            window = (window << 8) | (byte + i < bytes ? data[byte + i] : 0u);
+        }
+        const uint32_t value = (window << (position & 7)) >> (32 - count);
+        position += static_cast<size_t>(count);
+        return value;
+    }
+
+    int read_bit() {
+        const size_t byte = position >> 3;
+        const int bit = byte < bytes ? (data[byte] >> (7 - (position & 7))) & 1 : 0;
+        ++position;
+        return bit;
+    }
+
+    int read_symbol(const HuffmanTree& tree) {
+        int node = 0;
+        for (;;) {
+            const int child = tree.nodes[2 * static_cast<size_t>(node) + read_bit()];
+            if (child < 0) {
+                return -child - 1;
+            }
+            node = child;
+        }
+    }
+
+    size_t tell() const { return position; }
+    void seek(size_t bit) { position = bit; }
+
+private:
+    const unsigned char* data;
+    size_t bytes;
+    size_t position;
+};
+
+Mp3Decoder::Mp3Decoder()
+    : reservoir(), scalefac_long(), scalefac_short(), values(), nonzero(), spectrum(), overlap(),
+      synthesis(), synthesis_offset() {
+    reservoir.reserve(4096);
+}
+
+bool Mp3Decoder::supports(const Mp3FrameHeader& header) {
+    return header.version == 10 && header.layer == 3 && Mp3Tables::long_bands(header.sample_rate) != nullptr;
+}
+
+void Mp3Decoder::reset() {
+    reservoir.clear();
+    std::fill(&overlap[0][0], &overlap[0][0] + 2 * GRANULE_LINES, 0.0f);
+    std::fill(&synthesis[0][0], &synthesis[0][0] + 2 * 1024, 0.0f);
+    synthesis_offset[0] = synthesis_offset[1] = 0;
+}
+
+bool Mp3Decoder::decode(const Mp3Frame& frame, float* out) {
+    const Mp3FrameHeader& header = frame.header;
+    const int channels = header.channels;
+    std::fill(out, out + static_cast<size_t>(header.samples) * channels, 0.0f);
+    if (!supports(header)) {
+        return false;
+    }
+
+    const size_t header_bytes = (frame.data[1] & 1) == 0 ? 6 : 4;  // 16-bit CRC after the header
+    const size_t data_start = header_bytes + (channels == 1 ? 17 : 32);
+    if (header.frame_bytes < data_start) {
+        return false;
+    }
+    const int mode = frame.data[3] >> 6;
+    const int mode_extension = mode == 1 ? (frame.data[3] >> 4) & 3 : 0;
+
+    // this frame's main data joins the reservoir whether or not the frame itself decodes
+    const size_t previous = reservoir.size();
+    reservoir.insert(reservoir.end(), frame.data + data_start, frame.data + header.frame_bytes);
+
+    SideInfo side;
+    bool decoded = read_side_info(frame, channels, header_bytes, side) &&
+                   static_cast<size_t>(side.main_data_begin) <= previous;
+    if (decoded) {
+        const size_t start = previous - static_cast<size_t>(side.main_data_begin);
+        size_t bits_needed = 0;
+        for (int gr = 0; gr < 2; ++gr) {
+            for (int ch = 0; ch < channels; ++ch) {
+                bits_needed += static_cast<size_t>(side.granules[gr][ch].part2_3_length);
+            }
+        }
+        decoded = bits_needed <= (reservoir.size() - start) * 8;
+
+        BitReader bits(reservoir.data() + start, reservoir.size() - start);
+        for (int gr = 0; decoded && gr < 2; ++gr) {
+            for (int ch = 0; ch < channels; ++ch) {
+                const Granule& granule = side.granules[gr][ch];
+                const size_t end = bits.tell() + static_cast<size_t>(granule.part2_3_length);
+                read_scalefactors(bits, granule, gr, ch, side);
+                read_spectrum(bits, granule, end, header.sample_rate, ch);
+                requantize(granule, header.sample_rate, ch);
+            }
+            if (channels == 2 && mode_extension != 0) {
+                joint_stereo(side.granules[gr][1], header.sample_rate, mode_extension);
+            }
+            for (int ch = 0; ch < channels; ++ch) {
+                const Granule& granule = side.granules[gr][ch];
+                reorder(granule, header.sample_rate, ch);
+                reduce_aliasing(granule, ch);
+                synthesize(granule, ch, channels, out + static_cast<size_t>(gr) * GRANULE_LINES * channels);
+            }
+        }
+    }
+
+    // main_data_begin is 9 bits: later frames reach back at most 511 bytes
+    if (reservoir.size() > 511) {
+        reservoir.erase(reservoir.begin(), reservoir.end() - 511);
+    }
+    return decoded;
+}
+
+bool Mp3Decoder::read_side_info(const Mp3Frame& frame, int channels, size_t header_bytes, SideInfo& side) const {
+    BitReader bits(frame.data + header_bytes, channels == 1 ? 17 : 32);
+    side.main_data_begin = static_cast<int>(bits.read(9));
+    bits.read(channels == 1 ? 5 : 3);  // private bits
+    for (int ch = 0; ch < channels; ++ch) {
+        for (int band = 0; band < 4; ++band) {
+            side.scfsi[ch][band] = bits.read_bit() != 0;
+        }
+    }
+
+    for (int gr = 0; gr < 2; ++gr) {
+        for (int ch = 0; ch < channels; ++ch) {
+            Granule& granule = side.granules[gr][ch];
+            granule.part2_3_length = static_cast<int>(bits.read(12));
+            granule.big_values = static_cast<int>(bits.read(9));
+            granule.global_gain = static_cast<int>(bits.read(8));
+            granule.scalefac_compress = static_cast<int>(bits.read(4));
+            granule.window_switching = bits.read_bit() != 0;
+            if (granule.big_values > GRANULE_LINES / 2) {
+                return false;
+            }
+            if (granule.window_switching) {
+                granule.block_type = static_cast<int>(bits.read(2));
+                granule.mixed_block = bits.read_bit() != 0;
+                if (granule.block_type == 0) {
+                    return false;  // reserved: switching to a normal block
+                }
+                granule.table_select[0] = static_cast<int>(bits.read(5));
+                granule.table_select[1] = static_cast<int>(bits.read(5));
+                granule.table_select[2] = 0;
+                for (int w = 0; w < 3; ++w) {
+                    granule.subblock_gain[w] = static_cast<int>(bits.read(3));
+                }
+                // implicit: region 1 starts at line 36, region 2 is empty
+                granule.region0_count = 0;
+                granule.region1_count = 0;
+            } else {
+                granule.block_type = 0;
+                granule.mixed_block = false;
+                for (int r = 0; r < 3; ++r) {
+                    granule.table_select[r] = static_cast<int>(bits.read(5));
+                }
+                granule.subblock_gain[0] = granule.subblock_gain[1] = granule.subblock_gain[2] = 0;
+                granule.region0_count = static_cast<int>(bits.read(4));
+                granule.region1_count = static_cast<int>(bits.read(3));
+            }
+            granule.preflag = bits.read_bit() != 0;
+            granule.scalefac_scale = bits.read_bit() != 0;
+            granule.count1_table = bits.read_bit();
+        }
+    }
+    return true;
+}
+
+void Mp3Decoder::read_scalefactors(BitReader& bits, const Granule& granule, int gr, int ch, const SideInfo& side) {
+    const int slen1 = Mp3Tables::SLEN[0][granule.scalefac_compress];
+    const int slen2 = Mp3Tables::SLEN[1][granule.scalefac_compress];
+
+    if (is_short(granule.window_switching, granule.block_type)) {
+        int band = 0;
+        if (granule.mixed_block) {
+            for (; band < 8; ++band) {
+                scalefac_long[ch][band] = static_cast<int>(bits.read(slen1));
+            }
+            band = 3;
+        }
+        for (; band < 12; ++band) {
+            for (int w = 0; w < 3; ++w) {
+                scalefac_short[ch][band][w] = static_cast<int>(bits.read(band < 6 ? slen1 : slen2));
+            }
+        }
+        scalefac_short[ch][12][0] = scalefac_short[ch][12][1] = scalefac_short[ch][12][2] = 0;
+        return;
+    }
+
+    // four groups of bands; with scfsi set, granule 1 reuses granule 0's factors for the group
+    static const int GROUPS[5] = { 0, 6, 11, 16, 21 };
+    for (int group = 0; group < 4; ++group) {
+        if (gr == 1 && side.scfsi[ch][group]) {
+            continue;
+        }
+        for (int band = GROUPS[group]; band < GROUPS[group + 1]; ++band) {
+            scalefac_long[ch][band] = static_cast<int>(bits.read(band < 11 ? slen1 : slen2));
+        }
+    }
+    scalefac_long[ch][21] = 0;
+}
+
+void Mp3Decoder::read_spectrum(BitReader& bits, const Granule& granule, size_t end, int sample_rate, int ch) {
+    const HuffmanTrees& trees = huffman_trees();
+    const int* bands = Mp3Tables::long_bands(sample_rate);
+    int* line = values[ch];
+
+    int region1 = 36;
+    int region2 = GRANULE_LINES;
+    if (!granule.window_switching) {
+        region1 = bands[std::min(granule.region0_count + 1, 22)];
+        region2 = bands[std::min(granule.region0_count + granule.region1_count + 2, 22)];
+    }
+
+    // big values: pairs coded with one of three tables by region
+    const int big_end = granule.big_values * 2;
+    int i = 0;
+    for (; i < big_end; i += 2) {
+        const int select = granule.table_select[i < region1 ? 0 : i < region2 ? 1 : 2];
+        const Mp3Tables::HuffmanTable& table = Mp3Tables::big_values(select);
+        if (table.size == 0) {
+            line[i] = line[i + 1] = 0;
+            continue;
+        }
+        const int symbol = bits.read_symbol(trees.big_values[select]);
+        int x = symbol / table.size;
+        int y = symbol % table.size;
+        if (x == 15 && table.linbits > 0) {
+            x += static_cast<int>(bits.read(table.linbits));
+        }
+        if (x != 0 && bits.read_bit()) {
+            x = -x;
+        }
+        if (y == 15 && table.linbits > 0) {
+            y += static_cast<int>(bits.read(table.linbits));
+        }
+        if (y != 0 && bits.read_bit()) {
+            y = -y;
+        }
+        line[i] = x;
+        line[i + 1] = y;
+    }
+
+    // count1: quadruples of -1/0/1 until the granule's bits run out
+    const HuffmanTree& quads = trees.count1[granule.count1_table];
+    while (i + 4 <= GRANULE_LINES && bits.tell() < end) {
+        const int symbol = bits.read_symbol(quads);
+        int quad[4] = { (symbol >> 3) & 1, (symbol >> 2) & 1, (symbol >> 1) & 1, symbol & 1 };
+        for (int q = 0; q < 4; ++q) {
+            if (quad[q] != 0 && bits.read_bit()) {
+                quad[q] = -1;
+            }
+        }
+        if (bits.tell() > end) {
+            break;  // the last quadruple overran part2_3_length: not part of the granule
+        }
+        std::copy(quad, quad + 4, line + i);
+        i += 4;
+    }
+    std::fill(line + i, line + GRANULE_LINES, 0);
+
+    while (i > 0 && line[i - 1] == 0) {
+        --i;
+    }
+    nonzero[ch] = i;
+    bits.seek(end);  // skip stuffing bits
+}
+
+void Mp3Decoder::requantize(const Granule& granule, int sample_rate, int ch) {
+    const float* power = power_table();
+    const int* line = values[ch];
+    float* xr = spectrum[ch];
+    const int limit = nonzero[ch];
+    const int scale_shift = granule.scalefac_scale ? 4 : 2;  // quarter steps per scalefactor step
+    std::fill(xr + limit, xr + GRANULE_LINES, 0.0f);
+
+    auto scale = [&](int from, int to, int exponent) {
+        const float gain = static_cast<float>(std::exp2(exponent / 4.0));
+        for (int i = from; i < std::min(to, limit); ++i) {
+            const float magnitude = power[std::min(std::abs(line[i]), MAX_QUANTIZED)] * gain;
+            xr[i] = line[i] < 0 ? -magnitude : magnitude;
+        }
+    };
+
+    const bool short_blocks = is_short(granule.window_switching, granule.block_type);
+    const int long_end = short_blocks ? (granule.mixed_block ? 36 : 0) : GRANULE_LINES;
+    const int* bands = Mp3Tables::long_bands(sample_rate);
+    for (int band = 0; band < 22 && bands[band] < std::min(long_end, limit); ++band) {
+        const int boost = granule.preflag ? Mp3Tables::PRETAB[band] : 0;
+        scale(bands[band], bands[band + 1],
+              granule.global_gain - 210 - scale_shift * (scalefac_long[ch][band] + boost));
+    }
+    if (!short_blocks) {
+        return;
+    }
+
+    // short blocks are stored band by band, each band window by window
+    const int* short_bands = Mp3Tables::short_bands(sample_rate);
+    for (int band = granule.mixed_block ? 3 : 0; band < 13; ++band) {
+        const int width = short_bands[band + 1] - short_bands[band];
+        for (int w = 0; w < 3; ++w) {
+            const int from = 3 * short_bands[band] + w * width;
+            scale(from, from + width, granule.global_gain - 210 - 8 * granule.subblock_gain[w]
+                                      - scale_shift * scalefac_short[ch][band][w]);
+        }
+    }
+}
+
+void Mp3Decoder::joint_stereo(const Granule& granule, int sample_rate, int mode_extension) {
+    const Transforms& tables = transforms();
+    const bool mid_side = (mode_extension & 2) != 0;
+    const bool intensity = (mode_extension & 1) != 0;
+    float* left = spectrum[0];
+    float* right = spectrum[1];
+
+    // is_pos 7 (or no intensity stereo) leaves the band to mid/side
+    auto process = [&](int from, int to, int is_pos) {
+        if (intensity && is_pos < 7) {
+            for (int i = from; i < to; ++i) {
+                const float mono = left[i];
+                left[i] = mono * tables.intensity_left[is_pos];
+                right[i] = mono * tables.intensity_right[is_pos];
+            }
+        } else if (mid_side) {
+            for (int i = from; i < to; ++i) {
+                const float mid = left[i];
+                const float side = right[i];
+                left[i] = (mid + side) * SQRT_HALF;
+                right[i] = (mid - side) * SQRT_HALF;
+            }
+        }
+    };
+
+    const int right_end = nonzero[1];
+    const int stereo_end = std::max(nonzero[0], nonzero[1]);
+    if (!intensity) {
+        process(0, stereo_end, 7);
+    } else {
+        // intensity-coded bands are the ones above the last nonzero right-channel line;
+        // their right-channel scalefactors are intensity positions
+        const int* bands = Mp3Tables::long_bands(sample_rate);
+        if (!is_short(granule.window_switching, granule.block_type)) {
+            for (int band = 0; band < 22; ++band) {
+                const int is_pos = bands[band] >= right_end ? scalefac_long[1][std::min(band, 20)] : 7;
+                process(bands[band], bands[band + 1], is_pos);
+            }
+        } else {
+            const int* short_bands = Mp3Tables::short_bands(sample_rate);
+            const int first = granule.mixed_block ? 3 : 0;
+            bool right_in_short = false;
+            for (int w = 0; w < 3; ++w) {
+                int last = first - 1;  // last band of this window holding right-channel values
+                for (int band = 12; band >= first && last < first; --band) {
+                    const int width = short_bands[band + 1] - short_bands[band];
+                    const int* line = values[1] + 3 * short_bands[band] + w * width;
+                    if (std::any_of(line, line + width, [](int v) { return v != 0; })) {
+                        last = band;
+                    }
+                }
+                right_in_short = right_in_short || last >= first;
+                for (int band = first; band < 13; ++band) {
+                    const int width = short_bands[band + 1] - short_bands[band];
+                    const int from = 3 * short_bands[band] + w * width;
+                    process(from, from + width, band > last ? scalefac_short[1][std::min(band, 11)][w] : 7);
+                }
+            }
+            if (granule.mixed_block) {
+                for (int band = 0; band < 8; ++band) {
+                    const bool coded = !right_in_short && bands[band] >= right_end;
+                    process(bands[band], bands[band + 1], coded ? scalefac_long[1][band] : 7);
+                }
+            }
+        }
+    }
+    nonzero[0] = nonzero[1] = intensity ? GRANULE_LINES : stereo_end;
+}
+
+void Mp3Decoder::reorder(const Granule& granule, int sample_rate, int ch) {
+    if (!is_short(granule.window_switching, granule.block_type)) {
+        return;
+    }
+    // band by band, window by window -> line by line with the three windows interleaved,
+    // so subband sb holds window w's k-th coefficient at 18 sb + 3 k + w
+    const int* short_bands = Mp3Tables::short_bands(sample_rate);
+    const int first = granule.mixed_block ? 3 : 0;
+    float* xr = spectrum[ch];
+    float reordered[GRANULE_LINES];
+    for (int band = first; band < 13; ++band) {
+        const int width = short_bands[band + 1] - short_bands[band];
+        const int base = 3 * short_bands[band];
+        for (int w = 0; w < 3; ++w) {
+            for (int i = 0; i < width; ++i) {
+                reordered[base + 3 * i + w] = xr[base + w * width + i];
+            }
+        }
+    }
+    const int from = 3 * short_bands[first];
+    std::copy(reordered + from, reordered + GRANULE_LINES, xr + from);
+    // a band's lines only move within the band
+    for (int band = first; band < 13; ++band) {
+        if (nonzero[ch] > 3 * short_bands[band] && nonzero[ch] < 3 * short_bands[band + 1]) {
+            nonzero[ch] = 3 * short_bands[band + 1];
+        }
+    }
+}
+
+void Mp3Decoder::reduce_aliasing(const Granule& granule, int ch) {
+    const bool short_blocks = is_short(granule.window_switching, granule.block_type);
+    if (short_blocks && !granule.mixed_block) {
+        return;
+    }
+    const Transforms& tables = transforms();
+    // only the long subbands 0 and 1 of a mixed block share a boundary
+    const int boundaries = short_blocks ? 1 : std::min(SUBBANDS - 1, (nonzero[ch] + SUBBAND_LINES - 1) / SUBBAND_LINES);
+    float* xr = spectrum[ch];
+    for (int sb = 1; sb <= boundaries; ++sb) {
+        float* below = xr + sb * SUBBAND_LINES - 1;
+        float* above = xr + sb * SUBBAND_LINES;
+        for (int i = 0; i < 8; ++i) {
+            const float a = below[-i];
+            const float b = above[i];
+            below[-i] = a * tables.alias_cs[i] - b * tables.alias_ca[i];
+            above[i] = b * tables.alias_cs[i] + a * tables.alias_ca[i];
+        }
+    }
+    nonzero[ch] = std::min(GRANULE_LINES, nonzero[ch] + 8);
+}
+
+void Mp3Decoder::synthesize(const Granule& granule, int ch, int channels, float* out) {
+    const Transforms& tables = transforms();
+    float slots[SUBBAND_LINES][SUBBANDS];
+    // subbands above the last nonzero line only flush their overlap
+    const int active = std::min(SUBBANDS, (nonzero[ch] + SUBBAND_LINES - 1) / SUBBAND_LINES);
+
+    for (int sb = 0; sb < SUBBANDS; ++sb) {
+        float* previous = overlap[ch] + sb * SUBBAND_LINES;
+        if (sb >= active) {
+            for (int t = 0; t < SUBBAND_LINES; ++t) {
+                slots[t][sb] = previous[t];
+                previous[t] = 0.0f;
+            }
+        } else {
+            const float* x = spectrum[ch] + sb * SUBBAND_LINES;
+            const int type = granule.window_switching && granule.mixed_block && sb < 2 ? 0 : granule.block_type;
+            float y[36] = {};
+            if (type == 2) {
+                // three overlapping 12-point transforms at 6, 12 and 18
+                for (int w = 0; w < 3; ++w) {
+                    for (int i = 0; i < 12; ++i) {
+                        float sum = 0.0f;
+                        for (int k = 0; k < 6; ++k) {
+                            sum += x[3 * k + w] * tables.short_kernel[i][k];
+                        }
+                        y[6 + 6 * w + i] += sum * tables.windows[2][i];
+                    }
+                }
+            } else {
+                for (int i = 0; i < 36; ++i) {
+                    float sum = 0.0f;
+                    for (int k = 0; k < SUBBAND_LINES; ++k) {
+                        sum += x[k] * tables.long_kernel[i][k];
+                    }
+                    y[i] = sum * tables.windows[type][i];
+                }
+            }
+            for (int t = 0; t < SUBBAND_LINES; ++t) {
+                slots[t][sb] = y[t] + previous[t];
+                previous[t] = y[t + SUBBAND_LINES];
+            }
+        }
+        if (sb % 2 == 1) {
+            // odd subbands come out of the transform frequency-inverted
+            for (int t = 1; t < SUBBAND_LINES; t += 2) {
+                slots[t][sb] = -slots[t][sb];
+            }
+        }
+    }
+
+    for (int t = 0; t < SUBBAND_LINES; ++t) {
+        filter_slot(slots[t], ch, channels, out + static_cast<size_t>(t) * SUBBANDS * channels + ch);
+    }
+}
+
+void Mp3Decoder::filter_slot(const float* subbands, int ch, int channels, float* out) {
+    const Transforms& tables = transforms();
+    float* v = synthesis[ch];
+    int& offset = synthesis_offset[ch];
+    offset = (offset + 1024 - 64) & 1023;
+
+    // V[i] = sum_k cos((16 + i)(2k + 1) pi/64) S[k] for i = 0..63, folded onto 32 cosines:
+    // cos((64 - p) a) = -cos(p a) and cos((64 + p) a) = -cos(p a) for these angles
+    float folded[32];
+    for (int p = 0; p < 32; ++p) {
+        float sum = 0.0f;
+        for (int k = 0; k < SUBBANDS; ++k) {
+            sum += subbands[k] * tables.matrix[p][k];
+        }
+        folded[p] = sum;
+    }
+    float* block = v + offset;
+    for (int i = 0; i < 16; ++i) {
+        block[i] = folded[16 + i];
+    }
+    block[16] = 0.0f;
+    for (int i = 17; i < 48; ++i) {
+        block[i] = -folded[48 - i];
+    }
+    block[48] = -folded[0];
+    for (int i = 49; i < 64; ++i) {
+        block[i] = -folded[i - 48];
+    }
+
+    // window the 512 samples taken alternately from the first and last half of each 128-block
+    const float* window = Mp3Tables::synthesis_window();
+    for (int j = 0; j < SUBBANDS; ++j) {
+        float sum = 0.0f;
+        for (int i = 0; i < 8; ++i) {
+            sum += v[(offset + 128 * i + j) & 1023] * window[64 * i + j];
+            sum += v[(offset + 128 * i + 96 + j) & 1023] * window[64 * i + 32 + j];
+        }
+        out[static_cast<size_t>(j) * channels] = sum;
+    }
+}
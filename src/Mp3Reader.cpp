@@ -0,0 +1,400 @@
+#include "Mp3Reader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// kbps by [row][bitrate index]; rows: MPEG-1 L1, L2, L3, MPEG-2/2.5 L1, L2/L3
+const int BITRATES[5][15] = {
+    { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448 },
+    { 0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384 },
+    { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 },
+    { 0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256 },
+    { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },
+};
+
+const int SAMPLE_RATES[3] = { 44100, 48000, 32000 };  // MPEG-1; halved for 2, quartered for 2.5
+
+uint32_t read_be32(const unsigned char* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+uint32_t read_syncsafe(const unsigned char* p) {
+    return (static_cast<uint32_t>(p[0] & 0x7F) << 21) | (static_cast<uint32_t>(p[1] & 0x7F) << 14) |
+           (static_cast<uint32_t>(p[2] & 0x7F) << 7) | static_cast<uint32_t>(p[3] & 0x7F);
+}
+
+// Undo ID3 unsynchronisation: every 0xFF 0x00 pair was written for a plain 0xFF
+std::string unsynchronise(const unsigned char* p, size_t size) {
+    std::string out;
+    out.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        out.push_back(static_cast<char>(p[i]));
+        if (p[i] == 0xFF && i + 1 < size && p[i + 1] == 0x00) {
+            ++i;
+        }
+    }
+    return out;
+}
+
+void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+// Text frame body -> UTF-8, first value only (v2.4 separates values with NULs)
+std::string decode_text(const unsigned char* p, size_t size) {
+    std::string out;
+    if (size == 0) {
+        return out;
+    }
+    const unsigned char encoding = p[0];
+    ++p;
+    --size;
+
+    if (encoding == 1 || encoding == 2) {
+        // UTF-16: with BOM (1) or big-endian without (2)
+        bool big_endian = encoding == 2;
+        size_t i = 0;
+        if (encoding == 1 && size >= 2) {
+            big_endian = p[0] == 0xFE && p[1] == 0xFF;
+            i = 2;
+        }
+        for (; i + 1 < size; i += 2) {
+            uint32_t unit = big_endian ? (p[i] << 8) | p[i + 1] : (p[i + 1] << 8) | p[i];
+            if (unit == 0) {
+                break;
+            }
+            if (unit >= 0xD800 && unit < 0xDC00 && i + 3 < size) {
+                uint32_t low = big_endian ? (p[i + 2] << 8) | p[i + 3] : (p[i + 3] << 8) | p[i + 2];
+                unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                i += 2;
+            }
+            append_utf8(out, unit);
+        }
+    } else {
+        // ISO-8859-1 (0) or UTF-8 (3)
+        for (size_t i = 0; i < size && p[i] != 0; ++i) {
+            if (encoding == 3) {
+                out.push_back(static_cast<char>(p[i]));
+            } else {
+                append_utf8(out, p[i]);
+            }
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+Mp3Reader::Mp3Reader()
+    : file(), audio_start(0), audio_end(0), xing_offset(0), cursor(0), sample_position(0), resyncs(0),
+      tag(), first(), vbr(false), toc_present(false), xing_frames(0), xing_bytes(0), toc(), error() {}
+
+bool Mp3Reader::open(const std::string& path) {
+    close();
+    if (!file.open(path)) {
+        return fail(file.get_error());
+    }
+    const unsigned char* bytes = file.data();
+    const size_t size = file.size();
+
+    size_t start = 0;
+    if (parse_id3v2(bytes, size, tag)) {
+        start = tag.size;
+    }
+    audio_end = size;
+    if (size >= start + 128 && std::memcmp(bytes + size - 128, "TAG", 3) == 0) {
+        audio_end = size - 128;  // ID3v1 trailer
+    }
+
+    size_t pos = find_sync(start);
+    if (pos >= audio_end || !parse_header(bytes + pos, first)) {
+        close();
+        return fail("no MPEG audio frames found");
+    }
+    audio_start = pos;
+    if (read_xing(pos, first)) {
+        audio_start = pos + first.frame_bytes;  // the Xing frame carries no audio
+    }
+    rewind();
+    return true;
+}
+
+void Mp3Reader::close() {
+    file.close();
+    audio_start = audio_end = xing_offset = cursor = 0;
+    sample_position = 0;
+    resyncs = 0;
+    tag = Id3Tag();
+    first = Mp3FrameHeader();
+    vbr = toc_present = false;
+    xing_frames = xing_bytes = 0;
+}
+
+bool Mp3Reader::next_frame(Mp3Frame& frame) {
+    const unsigned char* bytes = file.data();
+    if (bytes == nullptr || cursor + 4 > audio_end) {
+        return false;
+    }
+    if (!parse_header(bytes + cursor, frame.header)) {
+        // damaged stream: skip to the next pair of valid headers
+        cursor = find_sync(cursor + 1);
+        ++resyncs;
+        if (cursor + 4 > audio_end || !parse_header(bytes + cursor, frame.header)) {
+            cursor = audio_end;
+            return false;
+        }
+    }
+    if (cursor + frame.header.frame_bytes > audio_end) {
+        cursor = audio_end;  // truncated last frame
+        return false;
+    }
+    frame.data = bytes + cursor;
+    frame.offset = cursor;
+    frame.first_sample = sample_position;
+    cursor += frame.header.frame_bytes;
+    sample_position += static_cast<uint64_t>(frame.header.samples);
+    return true;
+}
+
+bool Mp3Reader::seek(double seconds) {
+    if (!file.is_open()) {
+        return false;
+    }
+    const double duration = get_duration_seconds();
+    if (seconds <= 0.0 || duration <= 0.0) {
+        rewind();
+        return true;
+    }
+    seconds = std::min(seconds, duration);
+
+    size_t target;
+    if (toc_present && xing_bytes > 0) {
+        // the table maps percent of duration to 1/256ths of the file's audio bytes
+        double percent = std::min(99.999, seconds / duration * 100.0);
+        int index = static_cast<int>(percent);
+        double low = toc[index];
+        double high = index < 99 ? toc[index + 1] : 256.0;
+        double fraction = (low + (high - low) * (percent - index)) / 256.0;
+        target = xing_offset + static_cast<size_t>(fraction * xing_bytes);
+    } else {
+        target = audio_start + static_cast<size_t>(seconds * first.bitrate_kbps * 125.0);
+    }
+    cursor = find_sync(std::max(target, audio_start));
+    if (cursor >= audio_end) {
+        return false;
+    }
+    if (vbr) {
+        sample_position = static_cast<uint64_t>(std::llround(seconds * first.sample_rate));
+    } else {
+        // CBR frames differ only by the padding byte, so the frame index is exact enough
+        double frame_index = std::round(static_cast<double>(cursor - audio_start) /
+                                        (first.samples * first.bitrate_kbps * 125.0 / first.sample_rate));
+        sample_position = static_cast<uint64_t>(frame_index) * static_cast<uint64_t>(first.samples);
+    }
+    return true;
+}
+
+void Mp3Reader::rewind() {
+    cursor = audio_start;
+    sample_position = 0;
+}
+
+double Mp3Reader::get_duration_seconds() const {
+    if (first.sample_rate <= 0) {
+        return 0.0;
+    }
+    if (xing_frames > 0) {
+        return static_cast<double>(xing_frames) * first.samples / first.sample_rate;
+    }
+    return first.bitrate_kbps > 0 ? (audio_end - audio_start) / (first.bitrate_kbps * 125.0) : 0.0;
+}
+
+bool Mp3Reader::parse_header(const unsigned char* p, Mp3FrameHeader& header) {
+    if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) {
+        return false;
+    }
+    const int version_bits = (p[1] >> 3) & 0x03;
+    const int layer_bits = (p[1] >> 1) & 0x03;
+    const int bitrate_index = (p[2] >> 4) & 0x0F;
+    const int rate_index = (p[2] >> 2) & 0x03;
+    if (version_bits == 1 || layer_bits == 0 || bitrate_index == 0 || bitrate_index == 15 ||
+        rate_index == 3 || (p[3] & 0x03) == 2) {
+        return false;  // reserved values; free-format bitrate is not supported
+    }
+
+    header.version = version_bits == 3 ? 10 : (version_bits == 2 ? 20 : 25);
+    header.layer = 4 - layer_bits;
+    const bool mpeg1 = header.version == 10;
+    const int row = mpeg1 ? header.layer - 1 : (header.layer == 1 ? 3 : 4);
+    header.bitrate_kbps = BITRATES[row][bitrate_index];
+    header.sample_rate = SAMPLE_RATES[rate_index] / (mpeg1 ? 1 : (header.version == 20 ? 2 : 4));
+    header.padding = (p[2] & 0x02) != 0;
+    header.channels = ((p[3] >> 6) & 0x03) == 3 ? 1 : 2;
+
+    const int pad = header.padding ? 1 : 0;
+    if (header.layer == 1) {
+        header.samples = 384;
+        header.frame_bytes = static_cast<size_t>((12000 * header.bitrate_kbps / header.sample_rate + pad) * 4);
+    } else if (header.layer == 2 || mpeg1) {
+        header.samples = 1152;
+        header.frame_bytes = static_cast<size_t>(144000 * header.bitrate_kbps / header.sample_rate + pad);
+    } else {
+        header.samples = 576;
+        header.frame_bytes = static_cast<size_t>(72000 * header.bitrate_kbps / header.sample_rate + pad);
+    }
+    return header.frame_bytes >= 4;
+}
+
+bool Mp3Reader::parse_id3v2(const unsigned char* p, size_t size, Id3Tag& tag) {
+    if (size < 10 || std::memcmp(p, "ID3", 3) != 0 || p[3] < 2 || p[3] > 4) {
+        return false;
+    }
+    const int version = p[3];
+    const unsigned char flags = p[5];
+    const size_t body_size = read_syncsafe(p + 6);
+    const size_t total = 10 + body_size + ((flags & 0x10) ? 10 : 0);  // optional footer
+    if (total > size) {
+        return false;
+    }
+
+    tag = Id3Tag();
+    tag.present = true;
+    tag.version = version;
+    tag.size = total;
+
+    // v2.2/v2.3 unsynchronise the whole tag; v2.4 does it per frame
+    std::string body = (flags & 0x80) && version < 4
+        ? unsynchronise(p + 10, body_size)
+        : std::string(reinterpret_cast<const char*>(p + 10), body_size);
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(body.data());
+    size_t pos = 0;
+
+    if ((flags & 0x40) && version >= 3 && body.size() >= 4) {
+        // extended header: v2.3 size excludes its own 4 bytes, v2.4 size is syncsafe and inclusive
+        pos = version == 3 ? 4 + read_be32(b) : read_syncsafe(b);
+    }
+
+    const size_t id_len = version == 2 ? 3 : 4;
+    const size_t header_len = version == 2 ? 6 : 10;
+    while (pos + header_len <= body.size() && b[pos] != 0) {
+        std::string id(reinterpret_cast<const char*>(b + pos), id_len);
+        size_t frame_size;
+        unsigned char format_flags = 0;
+        if (version == 2) {
+            frame_size = (static_cast<size_t>(b[pos + 3]) << 16) | (b[pos + 4] << 8) | b[pos + 5];
+        } else if (version == 3) {
+            frame_size = read_be32(b + pos + 4);
+        } else {
+            frame_size = read_syncsafe(b + pos + 4);
+            format_flags = b[pos + 9];
+        }
+        size_t data = pos + header_len;
+        if (frame_size == 0 || data + frame_size > body.size()) {
+            break;
+        }
+
+        std::string text;
+        if (id[0] == 'T') {
+            if (format_flags & 0x02) {
+                std::string plain = unsynchronise(b + data, frame_size);
+                text = decode_text(reinterpret_cast<const unsigned char*>(plain.data()), plain.size());
+            } else {
+                text = decode_text(b + data, frame_size);
+            }
+        }
+        if (id == "TIT2" || id == "TT2") {
+            tag.title = text;
+        } else if (id == "TPE1" || id == "TP1") {
+            tag.artist = text;
+        } else if (id == "TALB" || id == "TAL") {
+            tag.album = text;
+        } else if (id == "TBPM" || id == "TBP") {
+            tag.bpm = text;
+        } else if (id == "TKEY" || id == "TKE") {
+            tag.key = text;
+        }
+        pos = data + frame_size;
+    }
+    return true;
+}
+
+size_t Mp3Reader::find_sync(size_t from) const {
+    const unsigned char* bytes = file.data();
+    Mp3FrameHeader header, next;
+    for (size_t pos = from; pos + 4 <= audio_end; ++pos) {
+        if (bytes[pos] != 0xFF || !parse_header(bytes + pos, header)) {
+            continue;
+        }
+        // a lone sync pattern in payload data is common; require the next header to agree
+        size_t after = pos + header.frame_bytes;
+        if (after > audio_end) {
+            continue;
+        }
+        if (after + 4 > audio_end) {
+            return pos;  // last frame of the stream
+        }
+        if (parse_header(bytes + after, next) && next.version == header.version &&
+            next.layer == header.layer && next.sample_rate == header.sample_rate) {
+            return pos;
+        }
+    }
+    return audio_end;
+}
+
+bool Mp3Reader::read_xing(size_t offset, const Mp3FrameHeader& header) {
+    if (header.layer != 3) {
+        return false;
+    }
+    // the Xing/Info block follows the Layer III side information
+    const size_t side_info = header.version == 10 ? (header.channels == 1 ? 17 : 32)
+                                                  : (header.channels == 1 ? 9 : 17);
+    const unsigned char* p = file.data() + offset + 4 + side_info;
+    const unsigned char* end = file.data() + offset + header.frame_bytes;
+    if (p + 8 > end) {
+        return false;
+    }
+    const bool xing = std::memcmp(p, "Xing", 4) == 0;
+    if (!xing && std::memcmp(p, "Info", 4) != 0) {
+        return false;
+    }
+    xing_offset = offset;
+    vbr = xing;  // "Info" is the same header written by encoders for CBR files
+
+    const uint32_t flags = read_be32(p + 4);
+    p += 8;
+    if ((flags & 0x1) && p + 4 <= end) {
+        xing_frames = read_be32(p);
+        p += 4;
+    }
+    if ((flags & 0x2) && p + 4 <= end) {
+        xing_bytes = read_be32(p);
+        p += 4;
+    }
+    if ((flags & 0x4) && p + 100 <= end) {
+        std::memcpy(toc, p, 100);
+        toc_present = true;
+    }
+    return true;
+}
+
+bool Mp3Reader::fail(const std::string& message) {
+    error = message;
+    return false;
+}
@@ -44,7 +44,7 @@ void Playlist::add_track(AudioTrack* track) {
               << playlist_name << "'" << std::endl;
 }
 
-void Playlist::remove_track(const std::string& title) {
+void Playlist::remove_track(std::string_view title) {
     PlaylistNode* curr = head;
     PlaylistNode* prev = nullptr;
 
@@ -80,7 +80,7 @@ void Playlist::display() const {
     int index = 1;
 
     while (current) {
-        std::vector<std::string> artists = current->track->get_artists();
+        const std::vector<std::string>& artists = current->track->get_artists();
         std::string artist_list;
 
         std::for_each(artists.begin(), artists.end(), [&](const std::string& artist) {
@@ -105,11 +105,11 @@ void Playlist::display() const {
     std::cout << "========================\n" << std::endl;
 }
 
-AudioTrack* Playlist::find_track(const std::string& title) const {
+AudioTrack* Playlist::find_track(TrackId track_id) const {
     PlaylistNode* current = head;
 
     while (current) {
-        if (current->track->get_title() == title) {
+        if (current->track->get_id() == track_id) {
             return current->track;
         }
         current = current->next;
@@ -0,0 +1,356 @@
+#include "PlaylistOptimizer.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+constexpr double EPSILON = 1e-6;
+
+// Reverse tour[first..last] (inclusive) and keep the position index in sync
+void reverse_range(std::vector<uint32_t>& tour, std::vector<uint32_t>& pos, size_t first, size_t last) {
+    std::reverse(tour.begin() + first, tour.begin() + last + 1);
+    for (size_t i = first; i <= last; ++i) {
+        pos[tour[i]] = static_cast<uint32_t>(i);
+    }
+}
+
+} // namespace
+
+PlaylistOptimizer::PlaylistOptimizer(const std::vector<float>& bpm_values, const std::vector<int>& camelot,
+                                     const std::vector<bool>& minor, const Options& opts)
+    : bpm(bpm_values), wheel(), mode(), known(), options(opts), matrix(), neighbours(), k(0) {
+    const size_t n = bpm.size();
+    wheel.resize(n);
+    mode.resize(n);
+    known.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        bool has_key = i < camelot.size() && camelot[i] > 0;
+        wheel[i] = has_key ? static_cast<float>(camelot[i]) : 0.0f;
+        mode[i] = (i < minor.size() && minor[i]) ? 1.0f : 0.0f;
+        known[i] = has_key ? 1.0f : 0.0f;
+    }
+    if (n <= MATRIX_LIMIT) {
+        build_matrix();
+    }
+    build_neighbours();
+}
+
+// ========== COSTS ==========
+
+void PlaylistOptimizer::cost_row(size_t a, float* out) const {
+    const size_t n = bpm.size();
+    const float bpm_a = bpm[a];
+    const float wheel_a = wheel[a];
+    const float mode_a = mode[a];
+    const float known_a = known[a];
+    const float weight = options.key_weight;
+    const float* b_bpm = bpm.data();
+    const float* b_wheel = wheel.data();
+    const float* b_mode = mode.data();
+    const float* b_known = known.data();
+
+    // branch-free so the loop vectorizes
+    for (size_t b = 0; b < n; ++b) {
+        float d = std::fabs(wheel_a - b_wheel[b]);
+        d = std::min(d, 12.0f - d);
+        float key = (d + 0.5f * std::fabs(mode_a - b_mode[b])) * (known_a * b_known[b]);
+        out[b] = std::fabs(bpm_a - b_bpm[b]) + weight * key;
+    }
+}
+
+float PlaylistOptimizer::cost(size_t a, size_t b) const {
+    if (!matrix.empty()) {
+        return matrix[a * bpm.size() + b];
+    }
+    float d = std::fabs(wheel[a] - wheel[b]);
+    d = std::min(d, 12.0f - d);
+    float key = (d + 0.5f * std::fabs(mode[a] - mode[b])) * (known[a] * known[b]);
+    return std::fabs(bpm[a] - bpm[b]) + options.key_weight * key;
+}
+
+void PlaylistOptimizer::build_matrix() {
+    const size_t n = bpm.size();
+    matrix.resize(n * n);
+    parallel_for(n, options.threads, [this, n](size_t row) {
+        cost_row(row, matrix.data() + row * n);
+    });
+}
+
+double PlaylistOptimizer::path_cost(const std::vector<size_t>& order) const {
+    double total = 0.0;
+    for (size_t i = 1; i < order.size(); ++i) {
+        total += cost(order[i - 1], order[i]);
+    }
+    return total;
+}
+
+double PlaylistOptimizer::tour_cost(const std::vector<uint32_t>& tour) const {
+    double total = 0.0;
+    for (size_t i = 1; i < tour.size(); ++i) {
+        total += cost(tour[i - 1], tour[i]);
+    }
+    return total;
+}
+
+// ========== CONSTRUCTION ==========
+
+std::vector<uint32_t> PlaylistOptimizer::nearest_neighbour(size_t start) const {
+    const size_t n = bpm.size();
+    const float inf = std::numeric_limits<float>::infinity();
+    std::vector<float> penalty(n, 0.0f);  // +inf once visited
+    std::vector<float> row(matrix.empty() ? n : 0);
+    std::vector<uint32_t> tour;
+    tour.reserve(n);
+
+    size_t current = start;
+    for (size_t step = 0; step < n; ++step) {
+        tour.push_back(static_cast<uint32_t>(current));
+        penalty[current] = inf;
+        if (step + 1 == n) {
+            break;
+        }
+
+        const float* costs;
+        if (matrix.empty()) {
+            cost_row(current, row.data());
+            costs = row.data();
+        } else {
+            costs = matrix.data() + current * n;
+        }
+
+        size_t best = n;
+        float best_cost = inf;
+        for (size_t b = 0; b < n; ++b) {
+            float c = costs[b] + penalty[b];
+            if (c < best_cost) {
+                best_cost = c;
+                best = b;
+            }
+        }
+        current = best;
+    }
+    return tour;
+}
+
+// ========== LOCAL SEARCH ==========
+
+void PlaylistOptimizer::build_neighbours() {
+    const size_t n = bpm.size();
+    k = std::min(options.neighbours, n > 0 ? n - 1 : 0);
+    neighbours.assign(n * k, 0);
+    if (k == 0) {
+        return;
+    }
+
+    parallel_for(n, options.threads, [this, n](size_t a) {
+        std::vector<float> row(matrix.empty() ? n : 0);
+        const float* costs = matrix.empty() ? row.data() : matrix.data() + a * n;
+        if (matrix.empty()) {
+            cost_row(a, row.data());
+        }
+
+        // bounded insertion into a sorted list of the k cheapest; most entries fail the first compare
+        std::vector<std::pair<float, uint32_t>> best;
+        best.reserve(k + 1);
+        for (size_t b = 0; b < n; ++b) {
+            if (b == a || (best.size() == k && costs[b] >= best.back().first)) {
+                continue;
+            }
+            std::pair<float, uint32_t> entry(costs[b], static_cast<uint32_t>(b));
+            best.insert(std::upper_bound(best.begin(), best.end(), entry), entry);
+            if (best.size() > k) {
+                best.pop_back();
+            }
+        }
+        for (size_t i = 0; i < k; ++i) {
+            neighbours[a * k + i] = best[i].second;
+        }
+    });
+}
+
+void PlaylistOptimizer::improve(std::vector<uint32_t>& tour) const {
+    std::vector<uint32_t> pos(tour.size());
+    for (size_t i = 0; i < tour.size(); ++i) {
+        pos[tour[i]] = static_cast<uint32_t>(i);
+    }
+
+    for (int pass = 0; pass < options.max_passes; ++pass) {
+        bool improved = two_opt_pass(tour, pos);
+        improved = or_opt_pass(tour, pos) || improved;
+        if (!improved) {
+            break;
+        }
+    }
+}
+
+bool PlaylistOptimizer::two_opt_pass(std::vector<uint32_t>& tour, std::vector<uint32_t>& pos) const {
+    // Each move makes track a = tour[i] adjacent to one of its near neighbours c by
+    // reversing the stretch between them. On an open path the endpoints have only
+    // one edge: a last track is covered by the second case (nothing after it to
+    // reconnect), and a first track may instead become c's predecessor by reversing
+    // the prefix, which breaks one edge rather than two.
+    const size_t n = tour.size();
+    bool improved = false;
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t a = tour[i];
+        const bool has_next = i + 1 < n;
+        const double a_next = has_next ? cost(a, tour[i + 1]) : 0.0;
+        const uint32_t* near = neighbours.data() + static_cast<size_t>(a) * k;
+
+        for (size_t m = 0; m < k; ++m) {
+            const uint32_t c = near[m];
+            const double gain_edge = cost(a, c);
+            const size_t j = pos[c];
+            double before = 0.0;
+            double after = 0.0;
+            size_t first = 0;
+            size_t last = 0;
+
+            if (has_next && j > i + 1) {
+                // a -> c, then the reversed stretch, then tour[i+1] -> tour[j+1]
+                before = a_next + (j + 1 < n ? cost(c, tour[j + 1]) : 0.0);
+                after = gain_edge + (j + 1 < n ? cost(tour[i + 1], tour[j + 1]) : 0.0);
+                first = i + 1;
+                last = j;
+                if (i == 0 && cost(tour[j - 1], c) - gain_edge > before - after) {
+                    // a is the head: reverse the prefix tour[0..j-1] so that a -> c
+                    before = cost(tour[j - 1], c);
+                    after = gain_edge;
+                    first = 0;
+                    last = j - 1;
+                }
+            } else if (j + 1 < i) {
+                // c -> a, then the reversed stretch, then tour[j+1] -> tour[i+1]
+                before = cost(c, tour[j + 1]) + a_next;
+                after = gain_edge + (has_next ? cost(tour[j + 1], tour[i + 1]) : 0.0);
+                first = j + 1;
+                last = i;
+            } else {
+                continue;
+            }
+
+            if (after + EPSILON < before) {
+                reverse_range(tour, pos, first, last);
+                improved = true;
+                break;  // a's neighbourhood changed; move on
+            }
+        }
+    }
+    return improved;
+}
+
+bool PlaylistOptimizer::or_opt_pass(std::vector<uint32_t>& tour, std::vector<uint32_t>& pos) const {
+    const size_t n = tour.size();
+    auto link = [this](uint32_t a, uint32_t b) -> double {
+        return (a == NONE || b == NONE) ? 0.0 : cost(a, b);
+    };
+
+    bool improved = false;
+    for (size_t len = 1; len <= 3 && len < n; ++len) {
+        for (size_t i = 0; i + len <= n; ++i) {
+            const uint32_t prev = i > 0 ? tour[i - 1] : NONE;
+            const uint32_t next = i + len < n ? tour[i + len] : NONE;
+            const uint32_t first = tour[i];
+            const uint32_t last = tour[i + len - 1];
+            const double removed = link(prev, first) + link(last, next) - link(prev, next);
+
+            // candidate insertion points: right before or after a near neighbour of either segment end
+            bool moved = false;
+            for (int end = 0; end < 2 && !moved; ++end) {
+                const uint32_t* near = neighbours.data() + static_cast<size_t>(end == 0 ? first : last) * k;
+                for (size_t m = 0; m < k && !moved; ++m) {
+                    const size_t at = pos[near[m]];
+                    for (size_t p = at; p <= at + 1 && !moved; ++p) {
+                        // insertion point p sits between tour[p-1] and tour[p], outside the segment
+                        if (p >= i && p <= i + len) {
+                            continue;
+                        }
+                        const uint32_t u = p > 0 ? tour[p - 1] : NONE;
+                        const uint32_t v = p < n ? tour[p] : NONE;
+                        const double forward = link(u, first) + link(last, v) - link(u, v);
+                        const double backward = link(u, last) + link(first, v) - link(u, v);
+                        if (std::min(forward, backward) + EPSILON >= removed) {
+                            continue;
+                        }
+
+                        size_t seg_begin;
+                        size_t lo;
+                        size_t hi;
+                        if (p < i) {
+                            std::rotate(tour.begin() + p, tour.begin() + i, tour.begin() + i + len);
+                            seg_begin = p;
+                            lo = p;
+                            hi = i + len;
+                        } else {
+                            std::rotate(tour.begin() + i, tour.begin() + i + len, tour.begin() + p);
+                            seg_begin = p - len;
+                            lo = i;
+                            hi = p;
+                        }
+                        if (backward < forward) {
+                            std::reverse(tour.begin() + seg_begin, tour.begin() + seg_begin + len);
+                        }
+                        for (size_t q = lo; q < hi; ++q) {
+                            pos[tour[q]] = static_cast<uint32_t>(q);
+                        }
+                        improved = true;
+                        moved = true;
+                    }
+                }
+            }
+        }
+    }
+    return improved;
+}
+
+// ========== DRIVER ==========
+
+PlaylistOptimizer::Result PlaylistOptimizer::solve() const {
+    auto started = std::chrono::steady_clock::now();
+    const size_t n = bpm.size();
+
+    Result result;
+    result.order.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        result.order[i] = i;
+    }
+    result.initial_cost = path_cost(result.order);
+    result.final_cost = result.initial_cost;
+
+    if (n > 2) {
+        // candidate 0 polishes the input order; the rest start nearest-neighbour from spread-out tracks
+        const size_t starts = std::min(options.starts, n);
+        std::vector<std::vector<uint32_t>> tours(starts + 1);
+        std::vector<double> costs(starts + 1);
+        parallel_for(starts + 1, options.threads, [&](size_t c) {
+            std::vector<uint32_t> tour;
+            if (c == 0) {
+                tour.resize(n);
+                for (size_t i = 0; i < n; ++i) {
+                    tour[i] = static_cast<uint32_t>(i);
+                }
+            } else {
+                tour = nearest_neighbour((c - 1) * n / starts);
+            }
+            improve(tour);
+            costs[c] = tour_cost(tour);
+            tours[c].swap(tour);
+        });
+
+        size_t best = static_cast<size_t>(std::min_element(costs.begin(), costs.end()) - costs.begin());
+        if (costs[best] < result.final_cost) {
+            result.final_cost = costs[best];
+            for (size_t i = 0; i < n; ++i) {
+                result.order[i] = tours[best][i];
+            }
+        }
+    }
+
+    result.solve_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+    return result;
+}
@@ -0,0 +1,186 @@
+#include "RenderEngine.h"
+#include "DeckMixer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+RenderEngine::RenderEngine()
+    : commands(), retired(), voices(), gains(), target_gains(), gain_step(1.0f), deck_blocks(), block(),
+      stats(), stop_requested(false), worker() {
+    voices.fill(nullptr);
+    gains.fill(0.0f);
+    target_gains.fill(0.0f);
+    gains[0] = target_gains[0] = 1.0f;
+    worker = std::thread(&RenderEngine::run, this);
+}
+
+RenderEngine::~RenderEngine() {
+    stop();
+    for (Voice*& voice : voices) {
+        destroy(voice);
+        voice = nullptr;
+    }
+}
+
+void RenderEngine::load(size_t deck, AudioTrack* track) {
+    // the voice owns the track, so the view stays valid until the voice is destroyed
+    Voice* voice = new Voice{track, track->get_waveform(), 0};
+    send(Command{Command::Load, deck, voice, 0});
+}
+
+void RenderEngine::unload(size_t deck) {
+    send(Command{Command::Unload, deck, nullptr, 0});
+}
+
+void RenderEngine::set_active(size_t deck, double fade_seconds) {
+    const double blocks = std::max(0.0, fade_seconds) * DEVICE_SAMPLE_RATE / BLOCK_SIZE;
+    send(Command{Command::Activate, deck, nullptr, static_cast<size_t>(std::lround(blocks))});
+}
+
+void RenderEngine::reclaim() {
+    Voice* voice = nullptr;
+    while (retired.pop(voice)) {
+        destroy(voice);
+    }
+}
+
+void RenderEngine::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    stop_requested.store(true, std::memory_order_release);
+    worker.join();
+
+    // the render thread is gone: finish its queue here so nothing leaks
+    Command command;
+    while (commands.pop(command)) {
+        apply(command);
+    }
+    reclaim();
+}
+
+void RenderEngine::send(const Command& command) {
+    reclaim();
+    while (!commands.push(command)) {
+        std::this_thread::yield();
+        reclaim();
+    }
+    if (!worker.joinable()) {
+        // already stopped: apply on this thread
+        Command pending;
+        while (commands.pop(pending)) {
+            apply(pending);
+        }
+        reclaim();
+    }
+}
+
+void RenderEngine::run() {
+    using clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(BLOCK_SIZE / DEVICE_SAMPLE_RATE));
+    const auto origin = clock::now();
+    double jitter_total_us = 0.0;
+
+    for (uint64_t tick = 0; !stop_requested.load(std::memory_order_acquire); ++tick) {
+        const auto due = origin + period * static_cast<clock::rep>(tick);
+        std::this_thread::sleep_until(due);
+        const auto woke = clock::now();
+
+        Command command;
+        while (commands.pop(command)) {
+            apply(command);
+        }
+        render_block();
+        const auto done = clock::now();
+
+        double jitter_us = std::chrono::duration<double, std::micro>(woke - due).count();
+        double render_us = std::chrono::duration<double, std::micro>(done - woke).count();
+        jitter_total_us += jitter_us;
+        stats.max_jitter_us = std::max(stats.max_jitter_us, jitter_us);
+        stats.max_render_us = std::max(stats.max_render_us, render_us);
+        if (done > due + period) {
+            stats.deadline_misses++;
+        }
+        stats.callbacks++;
+    }
+    stats.mean_jitter_us = stats.callbacks > 0 ? jitter_total_us / stats.callbacks : 0.0;
+}
+
+void RenderEngine::apply(const Command& command) {
+    if (command.deck >= MAX_DECKS) {
+        retired.push(command.voice);
+        return;
+    }
+    switch (command.type) {
+        case Command::Load:
+            if (voices[command.deck] != nullptr) {
+                retired.push(voices[command.deck]);
+            }
+            voices[command.deck] = command.voice;
+            break;
+        case Command::Unload:
+            if (voices[command.deck] != nullptr) {
+                retired.push(voices[command.deck]);
+                voices[command.deck] = nullptr;
+            }
+            break;
+        case Command::Activate:
+            for (size_t d = 0; d < MAX_DECKS; ++d) {
+                target_gains[d] = d == command.deck ? 1.0f : 0.0f;
+            }
+            gain_step = command.fade_blocks > 0 ? 1.0f / static_cast<float>(command.fade_blocks) : 1.0f;
+            break;
+    }
+    stats.commands++;
+}
+
+void RenderEngine::render_block() {
+    // every audible deck contributes one block; silent decks keep their position
+    std::array<const float*, MAX_DECKS> sources;
+    std::array<float, MAX_DECKS> levels;
+    size_t mixed = 0;
+    for (size_t d = 0; d < MAX_DECKS; ++d) {
+        if (gains[d] < target_gains[d]) {
+            gains[d] = std::min(target_gains[d], gains[d] + gain_step);
+        } else if (gains[d] > target_gains[d]) {
+            gains[d] = std::max(target_gains[d], gains[d] - gain_step);
+        }
+        Voice* voice = voices[d];
+        if (voice == nullptr || voice->pcm.empty() || gains[d] == 0.0f) {
+            continue;
+        }
+        read_block(*voice, deck_blocks[d].data());
+        sources[mixed] = deck_blocks[d].data();
+        levels[mixed] = gains[d];
+        ++mixed;
+    }
+    // one 64-sample block is far below DeckMixer::PARALLEL_MIN_SAMPLES: mixed on this thread
+    DeckMixer::mix_inline(sources.data(), levels.data(), mixed, block.data(), BLOCK_SIZE);
+    stats.max_mixed_decks = std::max(stats.max_mixed_decks, mixed);
+
+    float peak = stats.peak;
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        peak = std::max(peak, std::fabs(block[i]));
+    }
+    stats.peak = peak;
+}
+
+void RenderEngine::read_block(Voice& voice, float* out) {
+    // copy whole runs up to the loop point of the deck's audio
+    const WaveformView pcm = voice.pcm;
+    size_t filled = 0;
+    while (filled < BLOCK_SIZE) {
+        size_t run = std::min(BLOCK_SIZE - filled, pcm.size() - voice.position);
+        std::copy(pcm.data() + voice.position, pcm.data() + voice.position + run, out + filled);
+        filled += run;
+        voice.position = (voice.position + run) % pcm.size();
+    }
+}
+
+void RenderEngine::destroy(Voice* voice) {
+    if (voice != nullptr) {
+        delete voice->track;
+        delete voice;
+    }
+}
@@ -0,0 +1,45 @@
+#include "SampleFormat.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float INT16_SCALE = 32767.0f;
+
+} // namespace
+
+void SampleConverter::to_int16(const float* __restrict in, int16_t* __restrict out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        // round half away from zero, then clamp in the integer domain: float compares
+        // would keep the compiler from vectorizing the loop
+        const float v = in[i] * INT16_SCALE;
+        const int32_t s = static_cast<int32_t>(v + std::copysign(0.5f, v));
+        out[i] = static_cast<int16_t>(std::min(std::max(s, -32768), 32767));
+    }
+}
+
+void SampleConverter::to_float(const int16_t* __restrict in, float* __restrict out, size_t count) {
+    const float scale = 1.0f / INT16_SCALE;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = in[i] * scale;
+    }
+}
+
+size_t SampleConverter::bytes_per_sample(SampleFormat format) {
+    return format == SampleFormat::Int16 ? sizeof(int16_t) : sizeof(float);
+}
+
+const char* SampleConverter::name(SampleFormat format) {
+    return format == SampleFormat::Int16 ? "int16" : "float32";
+}
+
+bool SampleConverter::parse(const std::string& text, SampleFormat& format) {
+    if (text == "float32") {
+        format = SampleFormat::Float32;
+    } else if (text == "int16") {
+        format = SampleFormat::Int16;
+    } else {
+        return false;
+    }
+    return true;
+}
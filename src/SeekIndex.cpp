@@ -0,0 +1,51 @@
+#include "SeekIndex.h"
+#include <algorithm>
+#include <cmath>
+
+SeekIndex::SeekIndex() : samples(), offsets(), sample_rate(0), stride(0), total_samples(0) {}
+
+void SeekIndex::reset(int rate, uint64_t bytes_per_sample) {
+    samples.clear();
+    offsets.clear();
+    sample_rate = rate;
+    stride = bytes_per_sample;
+    total_samples = 0;
+}
+
+void SeekIndex::add(uint64_t sample, uint64_t offset) {
+    if (!samples.empty() && sample <= samples.back()) {
+        return;
+    }
+    samples.push_back(sample);
+    offsets.push_back(offset);
+}
+
+void SeekIndex::finish(uint64_t total) {
+    total_samples = total;
+    samples.shrink_to_fit();
+    offsets.shrink_to_fit();
+}
+
+SeekIndex::Entry SeekIndex::lookup(uint64_t sample) const {
+    if (samples.empty()) {
+        return Entry{0, 0};
+    }
+    // first entry past the position, then step back to the one covering it
+    auto it = std::upper_bound(samples.begin(), samples.end(), sample);
+    size_t i = it == samples.begin() ? 0 : static_cast<size_t>(it - samples.begin()) - 1;
+    if (stride > 0 && sample > samples[i] && (total_samples == 0 || sample <= total_samples)) {
+        return Entry{sample, offsets[i] + (sample - samples[i]) * stride};
+    }
+    return Entry{samples[i], offsets[i]};
+}
+
+uint64_t SeekIndex::to_samples(double seconds) const {
+    if (seconds <= 0.0 || sample_rate <= 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(std::llround(seconds * sample_rate));
+}
+
+double SeekIndex::to_seconds(uint64_t sample) const {
+    return sample_rate > 0 ? static_cast<double>(sample) / sample_rate : 0.0;
+}
@@ -51,6 +51,57 @@ bool SessionFileParser::parse_config_file(const std::string& config_path, Sessio
                     std::cout << "[WARNING] Invalid cache size at line " << line_number << std::endl;
                 }
                 
+            } else if (key == "adaptive_cache_max") {
+                try {
+                    config.adaptive_cache_max = std::stoi(value);
+                } catch (const std::exception& e) {
+                    std::cout << "[WARNING] Invalid adaptive cache bound at line " << line_number << std::endl;
+                }
+                
+            } else if (key == "cache_memory_budget_mb") {
+                try {
+                    config.cache_memory_budget_mb = std::stoi(value);
+                } catch (const std::exception& e) {
+                    std::cout << "[WARNING] Invalid cache memory budget at line " << line_number << std::endl;
+                }
+                
+            } else if (key == "cold_cache_size") {
+                try {
+                    config.cold_cache_size = std::stoi(value);
+                } catch (const std::exception& e) {
+                    std::cout << "[WARNING] Invalid cold cache size at line " << line_number << std::endl;
+                }
+                
+            } else if (key == "access_log_path") {
+                config.access_log_path = value;
+                
+            } else if (key == "metrics_path") {
+                config.metrics_path = value;
+                
+            } else if (key == "metrics_interval_ms") {
+                try {
+                    config.metrics_interval_ms = std::stoi(value);
+                } catch (const std::exception& e) {
+                    std::cout << "[WARNING] Invalid metrics interval at line " << line_number << std::endl;
+                }
+                
+            } else if (key == "spill_path") {
+                config.spill_path = value;
+                
+            } else if (key == "cache_admission") {
+                if (value == "tinylfu" || value == "lru") {
+                    config.cache_admission_tinylfu = value == "tinylfu";
+                } else {
+                    std::cout << "[WARNING] Invalid cache admission policy at line " << line_number << std::endl;
+                }
+                
+            } else if (key == "cache_sample_format") {
+                if (SampleConverter::parse(value, config.cache_sample_format)) {
+                    config.cache_sample_format_set = true;
+                } else {
+                    std::cout << "[WARNING] Invalid sample format at line " << line_number << std::endl;
+                }
+                
             } else if (key == "bpm_tolerance") {
                 try {
                     config.bpm_tolerance = std::stoi(value);
@@ -58,6 +109,20 @@ bool SessionFileParser::parse_config_file(const std::string& config_path, Sessio
                     std::cout << "[WARNING] Invalid BPM tolerance at line " << line_number << std::endl;
                 }
                 
+            } else if (key == "default_crossfade_time") {
+                try {
+                    config.default_crossfade_time = std::stoi(value);
+                } catch (const std::exception& e) {
+                    std::cout << "[WARNING] Invalid crossfade time at line " << line_number << std::endl;
+                }
+                
+            } else if (key == "deck_count") {
+                try {
+                    config.deck_count = std::stoi(value);
+                } catch (const std::exception& e) {
+                    std::cout << "[WARNING] Invalid deck count at line " << line_number << std::endl;
+                }
+                
             } else if (key == "auto_sync") {
                 config.auto_sync = parse_bool(value);
                 
@@ -175,6 +240,7 @@ bool SessionFileParser::parse_key_value(const std::string& line, std::string& ke
 bool SessionFileParser::parse_library_track(const std::string& line, SessionConfig::TrackInfo& track_info) {
     // Expected format: MP3,title,{artist1;artist2;},duration,bpm,bitrate,has_tags
     // or: WAV,title,{artist1;artist2;},duration,bpm,sample_rate,bit_depth
+    // either optionally followed by ,path of the audio file
     
     std::vector<std::string> parts = split_string(line, ',');
     
@@ -193,6 +259,9 @@ bool SessionFileParser::parse_library_track(const std::string& line, SessionConf
         track_info.bpm = std::stoi(parts[4]);
         track_info.extra_param1 = std::stoi(parts[5]);  // bitrate or sample_rate
         track_info.extra_param2 = std::stoi(parts[6]);  // has_tags or bit_depth
+        if (parts.size() > 7) {
+            track_info.path = trim_string(parts[7]);
+        }
         
         // Validate track type is MP3 or WAV
         if (track_info.type != "MP3" && track_info.type != "WAV") {
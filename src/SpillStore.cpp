@@ -0,0 +1,374 @@
+#include "SpillStore.h"
+#include "ColdTrackStore.h"
+#include "Tracer.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t RECORD_MAGIC = 0x52534A44;  // "DJSR"
+
+template <typename T>
+void put_value(std::vector<unsigned char>& out, T value) {
+    static_assert(std::is_trivially_copyable<T>::value, "records hold plain values only");
+    const size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+// Bounds-checked cursor over one record
+struct RecordReader {
+    const unsigned char* pos;
+    const unsigned char* end;
+
+    template <typename T>
+    bool get(T& value) {
+        if (static_cast<size_t>(end - pos) < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    bool skip(size_t bytes, const unsigned char*& start) {
+        if (static_cast<size_t>(end - pos) < bytes) {
+            return false;
+        }
+        start = pos;
+        pos += bytes;
+        return true;
+    }
+};
+
+bool write_all(int fd, const unsigned char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool read_all(int fd, unsigned char* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t got = ::pread(fd, data, size, static_cast<off_t>(offset));
+        if (got <= 0) {
+            return false;
+        }
+        data += got;
+        size -= static_cast<size_t>(got);
+        offset += static_cast<uint64_t>(got);
+    }
+    return true;
+}
+
+} // namespace
+
+SpillStore::SpillStore()
+    : path(), fd(-1), map(), index(), file_bytes(0), live(0), compaction_count(0),
+      compaction_requested(false), stop_requested(false), error(), mutex(), wake(), idle(), compactor() {}
+
+SpillStore::~SpillStore() {
+    close();
+}
+
+bool SpillStore::open(const std::string& segment_path) {
+    close();
+    fd = ::open(segment_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        error = "cannot create " + segment_path;
+        return false;
+    }
+    path = segment_path;
+    stop_requested = false;
+    compactor = std::thread(&SpillStore::run, this);
+    return true;
+}
+
+void SpillStore::close() {
+    if (compactor.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop_requested = true;
+        }
+        wake.notify_all();
+        compactor.join();
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        std::remove(path.c_str());
+    }
+    fd = -1;
+    path.clear();
+    map.close();
+    index.clear();
+    file_bytes = 0;
+    live = 0;
+    compaction_requested = false;
+}
+
+bool SpillStore::put(const AudioTrack& track, SampleFormat format, size_t samples,
+                     const std::vector<unsigned char>& compressed) {
+    if (!is_open()) {
+        return false;
+    }
+    const TrackAnalysis& analysis = track.get_analysis();
+    std::vector<unsigned char> record;
+    record.reserve(128 + analysis.energy_profile.size() * sizeof(float) + compressed.size());
+    put_value(record, RECORD_MAGIC);
+    put_value(record, uint64_t(0));  // record length, patched below
+    put_value(record, track.get_id());
+    put_value(record, static_cast<uint8_t>(format));
+    put_value(record, static_cast<uint64_t>(samples));
+    put_value(record, static_cast<int32_t>(track.get_bpm()));
+    put_value(record, track.get_exact_bpm());
+    put_value(record, static_cast<int32_t>(track.get_duration()));
+    put_value(record, static_cast<uint8_t>(analysis.analyzed));
+    put_value(record, analysis.first_beat_seconds);
+    put_value(record, analysis.beat_period_seconds);
+    put_value(record, static_cast<int32_t>(analysis.beat_count));
+    put_value(record, static_cast<int32_t>(analysis.key_root));
+    put_value(record, static_cast<uint8_t>(analysis.key_minor));
+    put_value(record, static_cast<int32_t>(analysis.camelot_number));
+    put_value(record, analysis.camelot_letter);
+    put_value(record, analysis.key_confidence);
+    put_value(record, analysis.rms);
+    put_value(record, static_cast<uint64_t>(analysis.energy_profile.size()));
+    for (float block : analysis.energy_profile) {
+        put_value(record, block);
+    }
+    put_value(record, static_cast<uint64_t>(compressed.size()));
+    record.insert(record.end(), compressed.begin(), compressed.end());
+    const uint64_t length = record.size();
+    std::memcpy(record.data() + sizeof(uint32_t), &length, sizeof(length));
+
+    bool request = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!write_all(fd, record.data(), record.size())) {
+            std::cout << "[WARNING] Spill write failed for " << path << std::endl;
+            return false;
+        }
+        auto existing = index.find(track.get_id());
+        if (existing != index.end()) {
+            retire(existing->second);
+        }
+        index[track.get_id()] = Location{file_bytes, length};
+        file_bytes += length;
+        live += length;
+        request = compaction_requested;
+    }
+    if (request) {
+        wake.notify_one();
+    }
+    return true;
+}
+
+PointerWrapper<AudioTrack> SpillStore::take(TrackId track_id, const AudioTrack& prototype) {
+    PointerWrapper<AudioTrack> track;
+    bool request = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = index.find(track_id);
+        if (found == index.end()) {
+            return track;
+        }
+        TraceSpan span("disk promote", prototype.get_title());
+        const Location location = found->second;
+        index.erase(found);
+        retire(location);
+        request = compaction_requested;
+
+        if (!map_through(location.offset + location.length)) {
+            std::cout << "[WARNING] " << map.get_error() << std::endl;
+            return track;
+        }
+        RecordReader in{map.data() + location.offset, map.data() + location.offset + location.length};
+        uint32_t magic = 0;
+        uint64_t length = 0, samples = 0, energy_blocks = 0, compressed_size = 0;
+        TrackId id = INVALID_TRACK_ID;
+        uint8_t format = 0, analyzed = 0, key_minor = 0;
+        int32_t bpm = 0, duration = 0, beat_count = 0, key_root = 0, camelot_number = 0;
+        double exact_bpm = 0.0;
+        TrackAnalysis analysis;
+        bool ok = in.get(magic) && magic == RECORD_MAGIC && in.get(length) && length == location.length &&
+                  in.get(id) && id == track_id && in.get(format) && in.get(samples) && in.get(bpm) &&
+                  in.get(exact_bpm) && in.get(duration) && in.get(analyzed) &&
+                  in.get(analysis.first_beat_seconds) && in.get(analysis.beat_period_seconds) &&
+                  in.get(beat_count) && in.get(key_root) && in.get(key_minor) && in.get(camelot_number) &&
+                  in.get(analysis.camelot_letter) && in.get(analysis.key_confidence) && in.get(analysis.rms) &&
+                  in.get(energy_blocks) && energy_blocks <= location.length / sizeof(float);
+        if (ok) {
+            analysis.energy_profile.resize(energy_blocks);
+            for (float& block : analysis.energy_profile) {
+                ok = ok && in.get(block);
+            }
+        }
+        const unsigned char* compressed = nullptr;
+        ok = ok && in.get(compressed_size) && in.skip(compressed_size, compressed) &&
+             format <= static_cast<uint8_t>(SampleFormat::Int16);
+        if (!ok) {
+            std::cout << "[WARNING] Corrupt spill record for track " << track_id << std::endl;
+            return track;
+        }
+        analysis.analyzed = analyzed != 0;
+        analysis.beat_count = beat_count;
+        analysis.key_root = key_root;
+        analysis.key_minor = key_minor != 0;
+        analysis.camelot_number = camelot_number;
+
+        track = prototype.clone();
+        const SampleFormat sample_format = static_cast<SampleFormat>(format);
+        void* pcm = track->allocate_waveform(sample_format, samples);
+        if (!ColdTrackStore::decompress(compressed, compressed_size, pcm, samples,
+                                        SampleConverter::bytes_per_sample(sample_format))) {
+            std::cout << "[WARNING] Corrupt spill record for track " << track_id << std::endl;
+            return PointerWrapper<AudioTrack>();
+        }
+        track->restore_analysis(analysis, bpm, exact_bpm, duration);
+    }
+    if (request) {
+        wake.notify_one();
+    }
+    return track;
+}
+
+bool SpillStore::contains(TrackId track_id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.count(track_id) > 0;
+}
+
+size_t SpillStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.size();
+}
+
+size_t SpillStore::live_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return live;
+}
+
+size_t SpillStore::segment_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return file_bytes;
+}
+
+size_t SpillStore::compactions() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return compaction_count;
+}
+
+void SpillStore::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return !compaction_requested || !compactor.joinable(); });
+}
+
+void SpillStore::retire(const Location& location) {
+    live -= location.length;
+    const uint64_t dead = file_bytes - live;
+    if (dead >= COMPACT_MIN_BYTES && dead > live) {
+        compaction_requested = true;
+    }
+}
+
+bool SpillStore::map_through(uint64_t end) {
+    if (map.size() >= end) {
+        return true;
+    }
+    return map.open(path);
+}
+
+void SpillStore::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return compaction_requested || stop_requested; });
+        if (stop_requested) {
+            break;
+        }
+        lock.unlock();
+        compact();
+        lock.lock();
+        compaction_requested = false;
+        idle.notify_all();
+    }
+    compaction_requested = false;
+    idle.notify_all();
+}
+
+void SpillStore::compact() {
+    // snapshot: records below snapshot_end are immutable, so they can be copied unlocked
+    std::vector<std::pair<TrackId, Location>> snapshot;
+    uint64_t snapshot_end = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot.assign(index.begin(), index.end());
+        snapshot_end = file_bytes;
+    }
+
+    const std::string compact_path = path + ".compact";
+    int out = ::open(compact_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (out < 0) {
+        std::cout << "[WARNING] Cannot create " << compact_path << std::endl;
+        return;
+    }
+    MappedFile source;
+    if (snapshot_end > 0 && !source.open(path)) {
+        std::cout << "[WARNING] " << source.get_error() << std::endl;
+        ::close(out);
+        std::remove(compact_path.c_str());
+        return;
+    }
+    std::unordered_map<uint64_t, uint64_t> moved;  // old offset -> new offset
+    uint64_t written = 0;
+    bool ok = true;
+    for (const auto& entry : snapshot) {
+        const Location& location = entry.second;
+        ok = ok && write_all(out, source.data() + location.offset, location.length);
+        moved[location.offset] = written;
+        written += location.length;
+    }
+    source.close();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unordered_map<TrackId, Location> compacted;
+    std::vector<unsigned char> buffer;
+    uint64_t kept = 0;
+    for (const auto& entry : index) {
+        Location location = entry.second;
+        auto copied = moved.find(location.offset);
+        if (location.offset < snapshot_end && copied != moved.end()) {
+            location.offset = copied->second;
+        } else {
+            // appended while the copy ran
+            buffer.resize(location.length);
+            ok = ok && read_all(fd, buffer.data(), buffer.size(), location.offset) &&
+                 write_all(out, buffer.data(), buffer.size());
+            location.offset = written;
+            written += location.length;
+        }
+        compacted[entry.first] = location;
+        kept += location.length;
+    }
+    if (!ok || ::rename(compact_path.c_str(), path.c_str()) != 0) {
+        // keep the old segment; dead records stay until the next attempt
+        std::cout << "[WARNING] Spill compaction failed for " << path << std::endl;
+        ::close(out);
+        std::remove(compact_path.c_str());
+        return;
+    }
+    ::close(fd);
+    fd = out;
+    map.close();
+    index.swap(compacted);
+    file_bytes = written;
+    live = kept;
+    compaction_count++;
+}
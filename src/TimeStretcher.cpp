@@ -0,0 +1,110 @@
+#include "TimeStretcher.h"
+#include <algorithm>
+#include <cmath>
+
+void TimeStretcher::stretch(const float* input, size_t count, double tempo_ratio,
+                            std::vector<float>& output, size_t frame) {
+    if (count == 0 || !(tempo_ratio > 0.0)) {
+        output.assign(input, input + count);
+        return;
+    }
+
+    // short inputs (e.g. the 1000-sample analysis waveform) still need several frames
+    size_t n = std::min(frame, std::max<size_t>(8, count / 4));
+    n &= ~static_cast<size_t>(1);
+    const size_t synthesis_hop = n / 2;
+    const double analysis_hop = synthesis_hop * tempo_ratio;
+    const long tolerance = static_cast<long>(synthesis_hop / 2);
+    const size_t out_len = static_cast<size_t>(std::llround(count / tempo_ratio));
+
+    std::vector<float> window(n);
+    for (size_t i = 0; i < n; ++i) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * 3.14159265358979323846 * i / n));
+    }
+
+    std::vector<float> mixed(out_len + n, 0.0f);
+    std::vector<float> weight(out_len + n, 0.0f);
+    std::vector<float> grain(n);
+
+    long previous = 0;
+    for (size_t k = 0; k * synthesis_hop < out_len; ++k) {
+        long read = 0;
+        if (k > 0) {
+            long nominal = std::lround(k * analysis_hop);
+            // the previous frame continued naturally is what this frame should look like
+            long natural = previous + static_cast<long>(synthesis_hop);
+            if (natural < static_cast<long>(count)) {
+                // only the half that overlaps the previous frame has to line up
+                size_t length = std::min(synthesis_hop, count - static_cast<size_t>(natural));
+                read = nominal + best_offset(input, count, nominal, tolerance, input + natural, length);
+            } else {
+                read = nominal;
+            }
+        }
+        read = std::max(0L, std::min(read, static_cast<long>(count) - 1));
+        previous = read;
+
+        // copy the frame (zero-padded past the end), then window and overlap-add
+        const size_t valid = std::min(n, count - static_cast<size_t>(read));
+        std::copy(input + read, input + read + valid, grain.begin());
+        std::fill(grain.begin() + valid, grain.end(), 0.0f);
+
+        float* out = mixed.data() + k * synthesis_hop;
+        float* norm = weight.data() + k * synthesis_hop;
+        const float* w = window.data();
+        const float* g = grain.data();
+        for (size_t i = 0; i < n; ++i) {
+            out[i] += w[i] * g[i];
+            norm[i] += w[i];
+        }
+    }
+
+    output.resize(out_len);
+    for (size_t i = 0; i < out_len; ++i) {
+        output[i] = weight[i] > 1e-9f ? mixed[i] / weight[i] : 0.0f;
+    }
+}
+
+namespace {
+
+float correlation(const float* a, const float* b, size_t length, size_t stride) {
+    float score = 0.0f;
+    for (size_t i = 0; i < length; i += stride) {
+        score += a[i] * b[i];
+    }
+    return score;
+}
+
+} // namespace
+
+long TimeStretcher::best_offset(const float* input, size_t count, long nominal, long tolerance,
+                                const float* target, size_t length) {
+    const long step = static_cast<long>(SEARCH_STEP);
+    long best = 0;
+    float best_score = -1e30f;
+    auto consider = [&](long delta, size_t stride) {
+        long pos = nominal + delta;
+        if (pos < 0 || static_cast<size_t>(pos) + length > count) {
+            return;
+        }
+        float score = correlation(input + pos, target, length, stride);
+        if (score > best_score) {
+            best_score = score;
+            best = delta;
+        }
+    };
+
+    // coarse: every SEARCH_STEP-th offset against every SEARCH_STEP-th sample
+    for (long delta = -tolerance; delta <= tolerance; delta += step) {
+        consider(delta, SEARCH_STEP);
+    }
+
+    // fine: full resolution around the coarse winner
+    long centre = best;
+    best_score = -1e30f;
+    for (long delta = std::max(-tolerance, centre - step + 1);
+         delta <= std::min(tolerance, centre + step - 1); ++delta) {
+        consider(delta, 1);
+    }
+    return best;
+}
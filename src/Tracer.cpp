@@ -0,0 +1,130 @@
+#include "Tracer.h"
+#include "PointerWrapper.h"
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+#include <cstdio>
+
+namespace {
+
+struct Span {
+    const char* name;
+    std::string detail;
+    Tracer::clock::time_point start;
+    Tracer::clock::time_point end;
+};
+
+// One per recording thread; its mutex is only contended while dump() reads it
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<Span> spans;
+    std::string name;
+    size_t tid;
+
+    explicit ThreadBuffer(size_t tid) : mutex(), spans(), name("thread " + std::to_string(tid)), tid(tid) {}
+};
+
+std::mutex buffers_mutex;
+std::vector<PointerWrapper<ThreadBuffer>> buffers;  // never shrinks: a thread's buffer outlives it
+Tracer::clock::time_point origin;                   // set by enable(), before spans are recorded
+
+ThreadBuffer& local_buffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr) {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.emplace_back(new ThreadBuffer(buffers.size() + 1));
+        buffer = buffers.back().get();
+    }
+    return *buffer;
+}
+
+// JSON string body: quotes, backslashes and control characters escaped, UTF-8 passed through
+void write_json_string(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out << escaped;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+double micros(Tracer::clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::active(false);
+
+void Tracer::enable() {
+    if (!enabled()) {
+        origin = clock::now();
+        active.store(true, std::memory_order_release);
+    }
+}
+
+void Tracer::set_thread_name(const std::string& name) {
+    ThreadBuffer& buffer = local_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.name = name;
+}
+
+void Tracer::record(const char* name, const std::string& detail, clock::time_point start, clock::time_point end) {
+    ThreadBuffer& buffer = local_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.spans.push_back(Span{name, detail, start, end});
+}
+
+size_t Tracer::span_count() {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    size_t count = 0;
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        count += buffer->spans.size();
+    }
+    return count;
+}
+
+bool Tracer::dump(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+            << ",\"args\":{\"name\":";
+        write_json_string(out, buffer->name);
+        out << "}}";
+        first = false;
+
+        // complete events ("X"): start and duration in microseconds
+        for (const Span& span : buffer->spans) {
+            out << ",\n{\"name\":";
+            write_json_string(out, span.name);
+            out << ",\"cat\":\"dj\",\"ph\":\"X\",\"ts\":" << micros(span.start - origin)
+                << ",\"dur\":" << micros(span.end - span.start) << ",\"pid\":1,\"tid\":" << buffer->tid;
+            if (!span.detail.empty()) {
+                out << ",\"args\":{\"detail\":";
+                write_json_string(out, span.detail);
+                out << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out.flush());
+}
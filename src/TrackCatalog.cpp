@@ -0,0 +1,108 @@
+#include "TrackCatalog.h"
+
+TrackCatalog::TrackCatalog()
+    : bpm(), duration(), format(), bitrate(), sample_rate(), bit_depth(), quality() {}
+
+void TrackCatalog::reserve(size_t rows) {
+    bpm.reserve(rows);
+    duration.reserve(rows);
+    format.reserve(rows);
+    bitrate.reserve(rows);
+    sample_rate.reserve(rows);
+    bit_depth.reserve(rows);
+    quality.reserve(rows);
+}
+
+TrackId TrackCatalog::append(Format fmt, int track_bpm, int duration_seconds,
+                             int track_bitrate, int track_sample_rate, int track_bit_depth,
+                             double track_quality) {
+    TrackId id = static_cast<TrackId>(bpm.size());
+    bpm.push_back(track_bpm);
+    duration.push_back(duration_seconds);
+    format.push_back(static_cast<uint8_t>(fmt));
+    bitrate.push_back(track_bitrate);
+    sample_rate.push_back(track_sample_rate);
+    bit_depth.push_back(track_bit_depth);
+    quality.push_back(track_quality);
+    return id;
+}
+
+void TrackCatalog::clear() {
+    bpm.clear();
+    duration.clear();
+    format.clear();
+    bitrate.clear();
+    sample_rate.clear();
+    bit_depth.clear();
+    quality.clear();
+}
+
+// Every scan is split in two passes: a branch-free predicate over one column that
+// writes a byte mask (vectorizes at -O2/-O3), then a compaction of the mask into ids.
+
+std::vector<TrackId> TrackCatalog::filterByBpm(int center_bpm, int tolerance) const {
+    const size_t n = bpm.size();
+    const int32_t lo = center_bpm - tolerance;
+    const int32_t hi = center_bpm + tolerance;
+    const int32_t* col = bpm.data();
+
+    std::vector<uint8_t> mask(n);
+    uint8_t* out = mask.data();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<uint8_t>((col[i] >= lo) & (col[i] <= hi));
+    }
+    return collect(mask);
+}
+
+std::vector<TrackId> TrackCatalog::filterByQuality(double min_quality) const {
+    const size_t n = quality.size();
+    const double* col = quality.data();
+
+    std::vector<uint8_t> mask(n);
+    uint8_t* out = mask.data();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<uint8_t>(col[i] >= min_quality);
+    }
+    return collect(mask);
+}
+
+std::vector<TrackId> TrackCatalog::filterByDuration(int min_seconds, int max_seconds) const {
+    const size_t n = duration.size();
+    const int32_t* col = duration.data();
+
+    std::vector<uint8_t> mask(n);
+    uint8_t* out = mask.data();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<uint8_t>((col[i] >= min_seconds) & (col[i] <= max_seconds));
+    }
+    return collect(mask);
+}
+
+std::vector<TrackId> TrackCatalog::filterByFormat(Format wanted) const {
+    const size_t n = format.size();
+    const uint8_t key = static_cast<uint8_t>(wanted);
+    const uint8_t* col = format.data();
+
+    std::vector<uint8_t> mask(n);
+    uint8_t* out = mask.data();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<uint8_t>(col[i] == key);
+    }
+    return collect(mask);
+}
+
+std::vector<TrackId> TrackCatalog::collect(const std::vector<uint8_t>& mask) {
+    const size_t n = mask.size();
+    size_t matches = 0;
+    for (size_t i = 0; i < n; ++i) {
+        matches += mask[i];
+    }
+
+    std::vector<TrackId> ids(matches);
+    size_t k = 0;
+    for (size_t i = 0; i < n && k < matches; ++i) {
+        ids[k] = static_cast<TrackId>(i);
+        k += mask[i];
+    }
+    return ids;
+}
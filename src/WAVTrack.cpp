@@ -1,9 +1,13 @@
 #include "WAVTrack.h"
+#include "WavReader.h"
+#include "Tracer.h"
 #include <iostream>
+#include <cmath>
 
 WAVTrack::WAVTrack(const std::string& title, const std::vector<std::string>& artists, 
                    int duration, int bpm, int sample_rate, int bit_depth)
-    : AudioTrack(title, artists, duration, bpm), sample_rate(sample_rate), bit_depth(bit_depth) {
+    : AudioTrack(title, artists, duration, bpm), sample_rate(sample_rate), bit_depth(bit_depth),
+      file_path() {
 
     std::cout << "WAVTrack created: " << sample_rate << "Hz/" << bit_depth << "bit" << std::endl;
 }
@@ -11,18 +15,102 @@ WAVTrack::WAVTrack(const std::string& title, const std::vector<std::string>& art
 // ========== TODO: STUDENTS IMPLEMENT THESE VIRTUAL FUNCTIONS ==========
 
 void WAVTrack::load() {
+    TraceSpan span("load", title);
     std::cout << "[WAVTrack::load] Loading WAV: \"" << title
               << "\" at " << sample_rate << "Hz/" << bit_depth 
               << "bit (uncompressed)...\n";
 
+    if (!file_path.empty() && decode_file()) {
+        return;
+    }
+    if (!has_seek_index()) {
+        build_estimated_index();
+    }
+
     long long size = static_cast<long long>(duration_seconds) * sample_rate * (bit_depth / 8) * 2;
 
     std::cout << "  → Estimated file size: " << size << " bytes\n";
     std::cout << "  → Fast loading due to uncompressed format.\n";
 }
 
+bool WAVTrack::decode_file() {
+    WavReader reader;
+    if (!reader.open(file_path)) {
+        std::cout << "  → [WARNING] " << reader.get_error() << "; keeping placeholder waveform\n";
+        return false;
+    }
+
+    const size_t channels = static_cast<size_t>(reader.get_channels());
+    const size_t factor = std::max<size_t>(1, static_cast<size_t>(
+        std::lround(reader.get_sample_rate() / AudioAnalyzer::ANALYSIS_SAMPLE_RATE)));
+    const size_t block_frames = 4096;
+
+    // one index entry per block, unless an earlier load already built the index
+    SeekIndex* index = has_seek_index() ? nullptr : &navigation->index;
+    if (index) {
+        index->reset(reader.get_sample_rate(), reader.get_frame_bytes());
+    }
+
+    std::vector<float> block(block_frames * channels);
+    std::vector<float> mono;
+    mono.reserve(reader.get_frame_count() / factor + 1);
+
+    // mono sum of each frame, averaged over `factor` frames per analysis sample
+    double sum = 0.0;
+    size_t summed = 0;
+    for (;;) {
+        const size_t start = reader.tell();
+        const size_t frames = reader.read(block.data(), block_frames);
+        if (frames == 0) {
+            break;
+        }
+        if (index) {
+            index->add(start, reader.get_data_offset() + start * reader.get_frame_bytes());
+        }
+        for (size_t f = 0; f < frames; ++f) {
+            const float* frame = block.data() + f * channels;
+            for (size_t c = 0; c < channels; ++c) {
+                sum += frame[c];
+            }
+            if (++summed == factor) {
+                mono.push_back(static_cast<float>(sum / static_cast<double>(factor * channels)));
+                sum = 0.0;
+                summed = 0;
+            }
+        }
+    }
+    if (summed > 0) {
+        mono.push_back(static_cast<float>(sum / static_cast<double>(summed * channels)));
+    }
+
+    if (index) {
+        index->finish(reader.get_frame_count());
+    }
+
+    set_waveform(mono);
+    std::cout << "  → Streamed " << reader.get_frame_count() << " frames (" << channels << "ch, "
+              << reader.get_sample_rate() << "Hz/" << reader.get_bits_per_sample() << "bit"
+              << (reader.is_float_format() ? " float" : "") << ") from " << file_path << "\n";
+    return true;
+}
+
+void WAVTrack::build_estimated_index() {
+    const uint64_t frame_bytes = 2 * static_cast<uint64_t>(bit_depth / 8);
+    const uint64_t frames = static_cast<uint64_t>(duration_seconds) * static_cast<uint64_t>(sample_rate);
+    const uint64_t block_frames = 4096;
+
+    SeekIndex& index = navigation->index;
+    index.reset(sample_rate, frame_bytes);
+    for (uint64_t frame = 0; frame < frames; frame += block_frames) {
+        index.add(frame, 44 + frame * frame_bytes);
+    }
+    index.finish(frames);
+}
+
 void WAVTrack::analyze_beatgrid() {
+    TraceSpan span("analyze", title);
     std::cout << "[WAVTrack::analyze_beatgrid] Analyzing beat grid for: \"" << title << "\"\n";
+    ensure_analyzed();
     
     double beats = (duration_seconds / 60.0) * bpm;
     
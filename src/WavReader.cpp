@@ -0,0 +1,162 @@
+#include "WavReader.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint16_t FORMAT_PCM = 0x0001;
+constexpr uint16_t FORMAT_FLOAT = 0x0003;
+constexpr uint16_t FORMAT_EXTENSIBLE = 0xFFFE;
+
+uint16_t read_u16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t read_u32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// Conversion kernels: fixed-width loads through memcpy (the data chunk need not be
+// aligned) and a multiply, which the compiler turns into vector code.
+void convert_pcm16(const unsigned char* in, float* out, size_t samples) {
+    const float scale = 1.0f / 32768.0f;
+    for (size_t i = 0; i < samples; ++i) {
+        int16_t v;
+        std::memcpy(&v, in + 2 * i, sizeof(v));
+        out[i] = v * scale;
+    }
+}
+
+void convert_pcm24(const unsigned char* in, float* out, size_t samples) {
+    const float scale = 1.0f / 8388608.0f;
+    for (size_t i = 0; i < samples; ++i) {
+        const unsigned char* p = in + 3 * i;
+        // place the three bytes in the top of a 32-bit word, then shift back to sign-extend
+        int32_t v = static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 8) |
+                                         (static_cast<uint32_t>(p[1]) << 16) |
+                                         (static_cast<uint32_t>(p[2]) << 24)) >> 8;
+        out[i] = v * scale;
+    }
+}
+
+void convert_pcm32(const unsigned char* in, float* out, size_t samples) {
+    const float scale = 1.0f / 2147483648.0f;
+    for (size_t i = 0; i < samples; ++i) {
+        int32_t v;
+        std::memcpy(&v, in + 4 * i, sizeof(v));
+        out[i] = static_cast<float>(v) * scale;
+    }
+}
+
+} // namespace
+
+WavReader::WavReader()
+    : file(), data(nullptr), frame_count(0), frame_bytes(0), cursor(0),
+      channels(0), sample_rate(0), bits_per_sample(0), float_format(false), error() {}
+
+WavReader::~WavReader() {
+    close();
+}
+
+bool WavReader::open(const std::string& path) {
+    close();
+    if (!file.open(path)) {
+        return fail(file.get_error());
+    }
+    if (!parse()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void WavReader::close() {
+    file.close();
+    data = nullptr;
+    frame_count = 0;
+    frame_bytes = 0;
+    cursor = 0;
+}
+
+bool WavReader::parse() {
+    const unsigned char* mapping = file.data();
+    const size_t mapped_size = file.size();
+    if (mapped_size < 12 || std::memcmp(mapping, "RIFF", 4) != 0 || std::memcmp(mapping + 8, "WAVE", 4) != 0) {
+        return fail("not a RIFF/WAVE file");
+    }
+
+    const unsigned char* fmt = nullptr;
+    size_t fmt_size = 0;
+    size_t data_offset = 0;
+    size_t data_size = 0;
+    for (size_t pos = 12; pos + 8 <= mapped_size; ) {
+        const unsigned char* chunk = mapping + pos;
+        size_t size = read_u32(chunk + 4);
+        size_t body = pos + 8;
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            fmt = mapping + body;
+            fmt_size = std::min(size, mapped_size - body);
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            data_offset = body;
+            data_size = std::min(size, mapped_size - body);  // tolerate truncated files
+            break;
+        }
+        pos = body + size + (size & 1);  // chunks are word aligned
+    }
+    if (fmt == nullptr || fmt_size < 16) {
+        return fail("missing fmt chunk");
+    }
+    if (data_offset == 0) {
+        return fail("missing data chunk");
+    }
+
+    uint16_t format = read_u16(fmt);
+    channels = read_u16(fmt + 2);
+    sample_rate = static_cast<int>(read_u32(fmt + 4));
+    bits_per_sample = read_u16(fmt + 14);
+    if (format == FORMAT_EXTENSIBLE && fmt_size >= 26) {
+        format = read_u16(fmt + 24);  // first two bytes of the sub-format GUID
+    }
+
+    bool supported = (format == FORMAT_PCM && (bits_per_sample == 16 || bits_per_sample == 24 ||
+                                               bits_per_sample == 32)) ||
+                     (format == FORMAT_FLOAT && bits_per_sample == 32);
+    if (!supported || channels <= 0 || sample_rate <= 0) {
+        return fail("unsupported sample format");
+    }
+
+    float_format = format == FORMAT_FLOAT;
+    frame_bytes = static_cast<size_t>(channels) * (bits_per_sample / 8);
+    frame_count = data_size / frame_bytes;
+    data = mapping + data_offset;
+    cursor = 0;
+    return true;
+}
+
+size_t WavReader::read(float* out, size_t max_frames) {
+    size_t frames = std::min(max_frames, frame_count - cursor);
+    if (frames == 0) {
+        return 0;
+    }
+    convert(data + cursor * frame_bytes, out, frames * channels, bits_per_sample, float_format);
+    cursor += frames;
+    return frames;
+}
+
+void WavReader::convert(const unsigned char* in, float* out, size_t samples, int bits, bool is_float) {
+    if (is_float) {
+        std::memcpy(out, in, samples * sizeof(float));
+    } else if (bits == 16) {
+        convert_pcm16(in, out, samples);
+    } else if (bits == 24) {
+        convert_pcm24(in, out, samples);
+    } else {
+        convert_pcm32(in, out, samples);
+    }
+}
+
+bool WavReader::fail(const std::string& message) {
+    error = message;
+    return false;
+}
@@ -0,0 +1,168 @@
+#include "WaveformPyramid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Pairwise reductions over contiguous arrays; the selects compile to vector min/max.
+// Buckets keep mean squares, not RMS: averaging them needs no sqrt, which under
+// -fmath-errno is a call with a branch on every element and keeps the loops scalar.
+void reduce_samples(const float* __restrict in, float* __restrict out_min, float* __restrict out_max,
+                    float* __restrict out_power, size_t pairs) {
+    for (size_t i = 0; i < pairs; ++i) {
+        const float a = in[2 * i];
+        const float b = in[2 * i + 1];
+        out_min[i] = a < b ? a : b;
+        out_max[i] = a > b ? a : b;
+        out_power[i] = 0.5f * (a * a + b * b);
+    }
+}
+
+void reduce_level(const float* __restrict in_min, const float* __restrict in_max, const float* __restrict in_power,
+                  float* __restrict out_min, float* __restrict out_max, float* __restrict out_power, size_t pairs) {
+    for (size_t i = 0; i < pairs; ++i) {
+        const float lo_a = in_min[2 * i], lo_b = in_min[2 * i + 1];
+        const float hi_a = in_max[2 * i], hi_b = in_max[2 * i + 1];
+        out_min[i] = lo_a < lo_b ? lo_a : lo_b;
+        out_max[i] = hi_a > hi_b ? hi_a : hi_b;
+        out_power[i] = 0.5f * (in_power[2 * i] + in_power[2 * i + 1]);
+    }
+}
+
+// Halve a level: pairs of buckets into one, an odd last bucket carried over as is.
+size_t halve(const float* __restrict in_min, const float* __restrict in_max, const float* __restrict in_power,
+             size_t size, float* __restrict out_min, float* __restrict out_max, float* __restrict out_power) {
+    reduce_level(in_min, in_max, in_power, out_min, out_max, out_power, size / 2);
+    if (size % 2 != 0) {
+        out_min[size / 2] = in_min[size - 1];
+        out_max[size / 2] = in_max[size - 1];
+        out_power[size / 2] = in_power[size - 1];
+    }
+    return (size + 1) / 2;
+}
+
+} // namespace
+
+WaveformPyramid::WaveformPyramid() : level_data(), sample_count(0) {}
+
+void WaveformPyramid::build(WaveformView waveform) {
+    const float* samples = waveform.data();
+    const size_t count = waveform.size();
+    level_data.clear();
+    sample_count = count;
+    if (count == 0) {
+        return;
+    }
+
+    // level 0: each chunk of samples is halved down to BASE_BUCKET in two scratch
+    // buffers that stay in cache, then appended
+    size_t size = (count + BASE_BUCKET - 1) / BASE_BUCKET;
+    Level base{std::vector<float>(size), std::vector<float>(size), std::vector<float>(size)};
+    Level scratch[2] = {
+        {std::vector<float>(BUILD_CHUNK / 2), std::vector<float>(BUILD_CHUNK / 2), std::vector<float>(BUILD_CHUNK / 2)},
+        {std::vector<float>(BUILD_CHUNK / 4), std::vector<float>(BUILD_CHUNK / 4), std::vector<float>(BUILD_CHUNK / 4)}};
+    size_t filled = 0;
+    for (size_t begin = 0; begin < count; begin += BUILD_CHUNK) {
+        const size_t length = std::min(BUILD_CHUNK, count - begin);
+        Level* current = &scratch[0];
+        reduce_samples(samples + begin, current->min.data(), current->max.data(), current->power.data(), length / 2);
+        size_t buckets = (length + 1) / 2;
+        if (length % 2 != 0) {
+            const float last = samples[begin + length - 1];
+            current->min[buckets - 1] = last;
+            current->max[buckets - 1] = last;
+            current->power[buckets - 1] = last * last;
+        }
+        for (size_t width = 2; width < BASE_BUCKET; width *= 2) {
+            Level* next = current == &scratch[0] ? &scratch[1] : &scratch[0];
+            buckets = halve(current->min.data(), current->max.data(), current->power.data(), buckets,
+                            next->min.data(), next->max.data(), next->power.data());
+            current = next;
+        }
+        std::copy(current->min.begin(), current->min.begin() + buckets, base.min.begin() + filled);
+        std::copy(current->max.begin(), current->max.begin() + buckets, base.max.begin() + filled);
+        std::copy(current->power.begin(), current->power.begin() + buckets, base.power.begin() + filled);
+        filled += buckets;
+    }
+    level_data.push_back(std::move(base));
+
+    while (level_data.back().min.size() > 1) {
+        const Level& below = level_data.back();
+        size = (below.min.size() + 1) / 2;
+        Level next{std::vector<float>(size), std::vector<float>(size), std::vector<float>(size)};
+        halve(below.min.data(), below.max.data(), below.power.data(), below.min.size(),
+              next.min.data(), next.max.data(), next.power.data());
+        level_data.push_back(std::move(next));
+    }
+}
+
+WaveformLevelView WaveformPyramid::level(size_t index) const {
+    return range(index, 0, sample_count);
+}
+
+WaveformLevelView WaveformPyramid::range(size_t index, size_t first_bucket, size_t count) const {
+    if (index >= level_data.size()) {
+        return WaveformLevelView{nullptr, nullptr, nullptr, 0, 0, 0};
+    }
+    const Level& data = level_data[index];
+    first_bucket = std::min(first_bucket, data.min.size());
+    count = std::min(count, data.min.size() - first_bucket);
+    return WaveformLevelView{data.min.data() + first_bucket, data.max.data() + first_bucket,
+                             data.power.data() + first_bucket, count, bucket_samples(index),
+                             first_bucket * bucket_samples(index)};
+}
+
+size_t WaveformPyramid::level_for(double samples_per_pixel) const {
+    size_t index = 0;
+    while (index + 1 < level_data.size() && bucket_samples(index + 1) <= samples_per_pixel) {
+        ++index;
+    }
+    return index;
+}
+
+void WaveformPyramid::render(size_t first_sample, size_t samples, size_t pixels,
+                             float* out_min, float* out_max, float* out_rms) const {
+    if (pixels == 0) {
+        return;
+    }
+    if (level_data.empty() || samples == 0 || first_sample >= sample_count) {
+        std::fill(out_min, out_min + pixels, 0.0f);
+        std::fill(out_max, out_max + pixels, 0.0f);
+        std::fill(out_rms, out_rms + pixels, 0.0f);
+        return;
+    }
+
+    const double samples_per_pixel = static_cast<double>(samples) / pixels;
+    const size_t index = level_for(samples_per_pixel);
+    const Level& data = level_data[index];
+    const size_t bucket = bucket_samples(index);
+    const size_t buckets = data.min.size();
+
+    for (size_t p = 0; p < pixels; ++p) {
+        // buckets overlapping this pixel's sample span (at least one)
+        const size_t start = first_sample + static_cast<size_t>(p * samples_per_pixel);
+        const size_t end = first_sample + static_cast<size_t>((p + 1) * samples_per_pixel);
+        const size_t b0 = std::min(start / bucket, buckets - 1);
+        const size_t b1 = std::min(std::max(b0 + 1, (end + bucket - 1) / bucket), buckets);
+
+        float lo = data.min[b0];
+        float hi = data.max[b0];
+        float power = 0.0f;
+        for (size_t b = b0; b < b1; ++b) {
+            lo = std::min(lo, data.min[b]);
+            hi = std::max(hi, data.max[b]);
+            power += data.power[b];
+        }
+        out_min[p] = lo;
+        out_max[p] = hi;
+        out_rms[p] = std::sqrt(power / static_cast<float>(b1 - b0));  // the only sqrt: one per pixel
+    }
+}
+
+size_t WaveformPyramid::memory_bytes() const {
+    size_t bytes = 0;
+    for (const Level& data : level_data) {
+        bytes += (data.min.capacity() + data.max.capacity() + data.power.capacity()) * sizeof(float);
+    }
+    return bytes;
+}
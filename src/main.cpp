@@ -13,6 +13,8 @@
 #include "DJControllerService.h"
 #include "MixingEngineService.h"
 #include "PointerWrapper.h"
+#include "Benchmarks.h"
+#include "Tracer.h"
 /**
  * DJ Track Session Manager - Test Program
  * 
@@ -157,14 +159,32 @@ void demonstrate_polymorphism() {
         std::cout << std::endl;
     }
 }
+
 int main(int argc, char* argv[]) {    
     /**
      * Command-line argument parsing
      * - If "-I" is provided as the first argument, run interactive DJ software
      * - If "-A" is provided as the second argument, enable play_all mode
+     * - "-O" anywhere after them reorders each playlist to minimize BPM/key jumps
+     * - "-R" anywhere after them plays decks through a real-time render thread
+     * - "-S" anywhere after them prints a next-track suggestion after each deck load
+     * - "-T <path>" anywhere after them records tracing spans and writes them to path as Chrome trace JSON
+     * - "-B" on its own runs the benchmarks (see Benchmarks.h), then exits
+     * - "-C" on its own runs the correctness checks and exits nonzero if one fails
      */
     bool run_software = true;
     bool play_all = false;
+    bool optimize_order = false;
+    bool render_thread = false;
+    bool suggest_next = false;
+    std::string trace_path;
+    if (argc > 1 && std::string(argv[1]) == "-B") {
+        run_benchmarks();
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "-C") {
+        return run_checks() ? 0 : 1;
+    }
     if (argc > 1 && std::string(argv[1]) == "-I") {
         run_software = true;
     }
@@ -173,10 +193,42 @@ int main(int argc, char* argv[]) {
         play_all = true;
     }
 
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "-O") {
+            optimize_order = true;
+        }
+        if (std::string(argv[i]) == "-R") {
+            render_thread = true;
+        }
+        if (std::string(argv[i]) == "-S") {
+            suggest_next = true;
+        }
+        if (std::string(argv[i]) == "-T" && i + 1 < argc) {
+            trace_path = argv[++i];
+        }
+    }
+
     if (run_software) {
         std::cout << "\n============= RUNNING INTERACTIVE SOFTWARE =============" << std::endl;
+        if (!trace_path.empty()) {
+            Tracer::enable();
+            Tracer::set_thread_name("main");
+        }
         DJSession live_session("Interactive Session", play_all);
+        live_session.set_optimize_order(optimize_order);
+        live_session.set_suggest_next(suggest_next);
+        if (render_thread) {
+            live_session.enable_render_thread();
+        }
         live_session.simulate_dj_performance();
+        if (!trace_path.empty()) {
+            if (Tracer::dump(trace_path)) {
+                std::cout << "[System] Trace written to " << trace_path << " (" << Tracer::span_count() << " spans)"
+                          << std::endl;
+            } else {
+                std::cout << "[WARNING] Cannot write trace " << trace_path << std::endl;
+            }
+        }
         std::cout << "============= INTERACTIVE SESSION ENDED =============\n" << std::endl;
     } else {
         std::cout << "==================================================" << std::endl;